@@ -125,6 +125,7 @@
 
 FI_STRUCT (FIBITMAP) { void *data; };
 FI_STRUCT (FIMULTIBITMAP) { void *data; };
+FI_STRUCT (FIMIPMAPS) { void *data; };
 
 // Types used in the library (directly copied from Windows) -----------------
 
@@ -503,7 +504,8 @@ FI_ENUM(FREE_IMAGE_FILTER) {
 	FILTER_BILINEAR   = 2,	//! Bilinear filter
 	FILTER_BSPLINE	  = 3,	//! 4th order (cubic) b-spline
 	FILTER_CATMULLROM = 4,	//! Catmull-Rom spline, Overhauser spline
-	FILTER_LANCZOS3	  = 5	//! Lanczos3 filter
+	FILTER_LANCZOS3	  = 5,	//! Lanczos3 filter
+	FILTER_KAISER	  = 6	//! Kaiser-windowed sinc filter
 };
 
 /** Color channels.
@@ -777,6 +779,16 @@ typedef void (DLL_CALLCONV *FI_InitProc)(Plugin *plugin, int format_id);
 #define FI_RESCALE_DEFAULT			0x00    //! default options; none of the following other options apply
 #define FI_RESCALE_TRUE_COLOR		0x01	//! for non-transparent greyscale images, convert to 24-bit if src bitdepth <= 8 (default is a 8-bit greyscale image). 
 #define FI_RESCALE_OMIT_METADATA	0x02	//! do not copy metadata to the rescaled image
+#define FI_RESCALE_MULTITHREADED	0x04	//! filter on one thread per hardware thread, unless FreeImage_SetRescaleThreads set another number
+#define FI_RESCALE_LINEAR			0x08	//! filter FIT_BITMAP images in linear light, their samples being sRGB values; palletized and 16-bit images are filtered as the 8-, 24- or 32-bit image returned
+#define FI_RESCALE_PREMULTIPLY		0x10	//! filter FIT_BITMAP images returned in 32 bits with colors premultiplied by alpha
+
+// GenerateMipmaps options ---------------------------------------------------
+// Constants used in FreeImage_GenerateMipmaps
+
+#define FI_MIPMAP_DEFAULT			0x00	//! default options; none of the following other options apply
+#define FI_MIPMAP_ALPHA_COVERAGE	0x01	//! scale the alpha of every level so that as many pixels pass the alpha test (alpha > alpha_ref) as in the full size image
+#define FI_MIPMAP_MULTITHREADED		0x04	//! filter on one thread per hardware thread, unless FreeImage_SetRescaleThreads set another number (same as FI_RESCALE_MULTITHREADED)
 
 // Color conversion parameters
 FI_ENUM(FREE_IMAGE_CVT_COLOR_PARAM) {
@@ -1156,6 +1168,15 @@ DLL_API FIBOOL DLL_CALLCONV FreeImage_FlipVertical(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Rescale(FIBITMAP *dib, int dst_width, int dst_height, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_CATMULLROM));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_MakeThumbnail(FIBITMAP *dib, int max_pixel_size, FIBOOL convert FI_DEFAULT(TRUE));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_RescaleRect(FIBITMAP *dib, int dst_width, int dst_height, int left, int top, int right, int bottom, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_CATMULLROM), unsigned flags FI_DEFAULT(0));
+DLL_API void DLL_CALLCONV FreeImage_SetRescaleThreads(unsigned threads);
+DLL_API unsigned DLL_CALLCONV FreeImage_GetRescaleThreads(void);
+
+// mipmap chains
+DLL_API FIMIPMAPS *DLL_CALLCONV FreeImage_GenerateMipmaps(FIBITMAP *dib, unsigned levels FI_DEFAULT(0), FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_BOX), unsigned flags FI_DEFAULT(FI_MIPMAP_DEFAULT), double alpha_ref FI_DEFAULT(0.5));
+DLL_API unsigned DLL_CALLCONV FreeImage_GetMipmapCount(FIMIPMAPS *mipmaps);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_GetMipmap(FIMIPMAPS *mipmaps, unsigned level);
+DLL_API uint8_t *DLL_CALLCONV FreeImage_GetMipmapBits(FIMIPMAPS *mipmaps, size_t *size FI_DEFAULT(NULL));
+DLL_API void DLL_CALLCONV FreeImage_UnloadMipmaps(FIMIPMAPS *mipmaps);
 
 // color manipulation routines (point operations)
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustCurve(FIBITMAP *dib, uint8_t *LUT, FREE_IMAGE_COLOR_CHANNEL channel);
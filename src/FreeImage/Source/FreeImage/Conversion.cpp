@@ -25,6 +25,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ConversionSIMD.h"
 #include "Quantizers.h"
 
 // ----------------------------------------------------------
@@ -72,13 +73,18 @@ FIBOOL SwapRedBlue32(FIBITMAP* dib) {
 		return FALSE;
 	}
 		
+	const unsigned width = FreeImage_GetWidth(dib);
 	const unsigned height = FreeImage_GetHeight(dib);
 	const unsigned pitch = FreeImage_GetPitch(dib);
 	const unsigned lineSize = FreeImage_GetLine(dib);
+
+	const LineConverters *simd = GetLineConverters();
+	unsigned (*swap)(uint8_t*, unsigned) = simd ? (bytesperpixel == 4 ? simd->swapRedBlue32 : simd->swapRedBlue24) : NULL;
 	
 	uint8_t* line = FreeImage_GetBits(dib);
 	for(unsigned y = 0; y < height; ++y, line += pitch) {
-		for(uint8_t* pixel = line; pixel < line + lineSize ; pixel += bytesperpixel) {
+		const unsigned done = swap ? swap(line, width) : 0;
+		for(uint8_t* pixel = line + done * bytesperpixel; pixel < line + lineSize ; pixel += bytesperpixel) {
 			INPLACESWAP(pixel[0], pixel[2]);
 		}
 	}
@@ -24,6 +24,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ConversionSIMD.h"
 
 // ----------------------------------------------------------
 //  internal conversions X to 24 bits
@@ -68,7 +69,14 @@ FreeImage_ConvertLine4To24(uint8_t *target, uint8_t *source, int width_in_pixels
 
 void DLL_CALLCONV
 FreeImage_ConvertLine8To24(uint8_t *target, uint8_t *source, int width_in_pixels, FIRGBA8 *palette) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line8To24 && width_in_pixels > 0) {
+		cols = (int)simd->line8To24(target, source, (unsigned)width_in_pixels, palette);
+		target += cols * 3;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_BLUE] = palette[source[cols]].blue;
 		target[FI_RGBA_GREEN] = palette[source[cols]].green;
 		target[FI_RGBA_RED] = palette[source[cols]].red;
@@ -81,7 +89,14 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To24_555(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line16To24_555 && width_in_pixels > 0) {
+		cols = (int)simd->line16To24_555(target, source, (unsigned)width_in_pixels);
+		target += cols * 3;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_555_RED_MASK) >> FI16_555_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_555_GREEN_MASK) >> FI16_555_GREEN_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_555_BLUE_MASK) >> FI16_555_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -94,7 +109,14 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To24_565(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line16To24_565 && width_in_pixels > 0) {
+		cols = (int)simd->line16To24_565(target, source, (unsigned)width_in_pixels);
+		target += cols * 3;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_565_RED_MASK) >> FI16_565_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_565_GREEN_MASK) >> FI16_565_GREEN_SHIFT) * 0xFF) / 0x3F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_565_BLUE_MASK) >> FI16_565_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -105,7 +127,15 @@ FreeImage_ConvertLine16To24_565(uint8_t *target, uint8_t *source, int width_in_p
 
 void DLL_CALLCONV
 FreeImage_ConvertLine32To24(uint8_t *target, uint8_t *source, int width_in_pixels) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line32To24 && width_in_pixels > 0) {
+		cols = (int)simd->line32To24(target, source, (unsigned)width_in_pixels);
+		target += cols * 3;
+		source += cols * 4;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_BLUE] = source[FI_RGBA_BLUE];
 		target[FI_RGBA_GREEN] = source[FI_RGBA_GREEN];
 		target[FI_RGBA_RED] = source[FI_RGBA_RED];
@@ -24,6 +24,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ConversionSIMD.h"
 
 // ----------------------------------------------------------
 //  internal conversions X to 32 bits
@@ -69,7 +70,14 @@ FreeImage_ConvertLine4To32(uint8_t *target, uint8_t *source, int width_in_pixels
 
 void DLL_CALLCONV
 FreeImage_ConvertLine8To32(uint8_t *target, uint8_t *source, int width_in_pixels, FIRGBA8 *palette) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line8To32 && width_in_pixels > 0) {
+		cols = (int)simd->line8To32(target, source, (unsigned)width_in_pixels, palette);
+		target += cols * 4;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_BLUE]	= palette[source[cols]].blue;
 		target[FI_RGBA_GREEN]	= palette[source[cols]].green;
 		target[FI_RGBA_RED]		= palette[source[cols]].red;
@@ -82,7 +90,14 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To32_555(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line16To32_555 && width_in_pixels > 0) {
+		cols = (int)simd->line16To32_555(target, source, (unsigned)width_in_pixels);
+		target += cols * 4;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_555_RED_MASK) >> FI16_555_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_555_GREEN_MASK) >> FI16_555_GREEN_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_555_BLUE_MASK) >> FI16_555_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -95,7 +110,14 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To32_565(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line16To32_565 && width_in_pixels > 0) {
+		cols = (int)simd->line16To32_565(target, source, (unsigned)width_in_pixels);
+		target += cols * 4;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_565_RED_MASK) >> FI16_565_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_565_GREEN_MASK) >> FI16_565_GREEN_SHIFT) * 0xFF) / 0x3F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_565_BLUE_MASK) >> FI16_565_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -120,7 +142,15 @@ The bug occurs in release mode only, when the image height is equal to 537
 */
 void DLL_CALLCONV
 FreeImage_ConvertLine24To32(uint8_t *target, uint8_t *source, int width_in_pixels) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	int cols = 0;
+	const LineConverters *simd = GetLineConverters();
+	if (simd && simd->line24To32 && width_in_pixels > 0) {
+		cols = (int)simd->line24To32(target, source, (unsigned)width_in_pixels);
+		target += cols * 4;
+		source += cols * 3;
+	}
+
+	for (; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = source[FI_RGBA_RED];
 		target[FI_RGBA_GREEN] = source[FI_RGBA_GREEN];
 		target[FI_RGBA_BLUE]  = source[FI_RGBA_BLUE];
@@ -0,0 +1,546 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "ConversionSIMD.h"
+
+#if !defined(FREEIMAGE_NO_SIMD) && !defined(FREEIMAGE_BIGENDIAN)
+#  if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || (defined(_M_IX86) && !defined(_M_ARM64EC))
+#    define FI_CONVERSION_X86
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#      include <intrin.h>
+#    endif
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define FI_CONVERSION_NEON
+#    include <arm_neon.h>
+#  endif
+#endif
+
+// the palette converters copy whole FIRGBA8 entries, which are in the order of the pixels
+// only with FREEIMAGE_COLORORDER_RGB
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_RGB
+#  define FI_CONVERSION_PALETTE
+#endif
+
+// ----------------------------------------------------------
+//  CPU detection
+// ----------------------------------------------------------
+
+static unsigned
+DetectCPUFeatures() {
+	unsigned features = 0;
+#if defined(FI_CONVERSION_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int max_leaf = info[0];
+	__cpuid(info, 1);
+	if (info[2] & (1 << 9)) {
+		features |= FI_CPU_SSSE3;
+	}
+	if (info[2] & (1 << 19)) {
+		features |= FI_CPU_SSE41;
+	}
+	// AVX and OSXSAVE, and the OS saving the YMM registers
+	if (max_leaf >= 7 && (info[2] & 0x18000000) == 0x18000000 && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5)) {
+			features |= FI_CPU_AVX2;
+		}
+	}
+#elif defined(FI_CONVERSION_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) {
+		features |= FI_CPU_SSSE3;
+	}
+	if (__builtin_cpu_supports("sse4.1")) {
+		features |= FI_CPU_SSE41;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		features |= FI_CPU_AVX2;
+	}
+#elif defined(FI_CONVERSION_NEON)
+	// NEON is part of every ARMv8 CPU
+	features |= FI_CPU_NEON;
+#endif
+	return features;
+}
+
+unsigned
+FreeImage_GetCPUFeatures() {
+	static const unsigned features = DetectCPUFeatures();
+	return features;
+}
+
+// ----------------------------------------------------------
+//  palette expansion with plain 32-bit copies
+// ----------------------------------------------------------
+
+#if defined(FI_CONVERSION_PALETTE) && (defined(FI_CONVERSION_X86) || defined(FI_CONVERSION_NEON))
+
+static unsigned
+Line8To24_Words(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette) {
+	// each copy writes one byte too many, which the next one overwrites
+	unsigned x = 0;
+	for (; x + 1 < width; x++) {
+		memcpy(target + x * 3, &palette[source[x]], 4);
+	}
+	return x;
+}
+
+static unsigned
+Line8To32_Words(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette) {
+	for (unsigned x = 0; x < width; x++) {
+		uint32_t pixel;
+		memcpy(&pixel, &palette[source[x]], 4);
+		pixel |= FI_RGBA_ALPHA_MASK;
+		memcpy(target + x * 4, &pixel, 4);
+	}
+	return width;
+}
+
+#endif
+
+#ifdef FI_CONVERSION_X86
+
+// ----------------------------------------------------------
+//  SSSE3
+// ----------------------------------------------------------
+
+/// floor(x * 255 / 31) of 5-bit values
+FI_TARGET("ssse3") static inline __m128i
+Expand5(__m128i x) {
+	return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, _mm_set1_epi16(255)), _mm_set1_epi16(1)), _mm_set1_epi16(2114));
+}
+
+/// floor(x * 255 / 63) of 6-bit values
+FI_TARGET("ssse3") static inline __m128i
+Expand6(__m128i x) {
+	return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, _mm_set1_epi16(255)), _mm_set1_epi16(4)), _mm_set1_epi16(1040));
+}
+
+/// Unpacks 8 16-bit pixels into two vectors of 4 32-bit pixels
+template <bool RGB565>
+FI_TARGET("ssse3") static inline void
+Unpack16_SSSE3(const uint8_t *source, __m128i &p0, __m128i &p1) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)source);
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	__m128i c[4];
+	if (RGB565) {
+		c[FI_RGBA_RED] = Expand5(_mm_and_si128(_mm_srli_epi16(v, FI16_565_RED_SHIFT), mask5));
+		c[FI_RGBA_GREEN] = Expand6(_mm_and_si128(_mm_srli_epi16(v, FI16_565_GREEN_SHIFT), _mm_set1_epi16(0x3F)));
+		c[FI_RGBA_BLUE] = Expand5(_mm_and_si128(_mm_srli_epi16(v, FI16_565_BLUE_SHIFT), mask5));
+	} else {
+		c[FI_RGBA_RED] = Expand5(_mm_and_si128(_mm_srli_epi16(v, FI16_555_RED_SHIFT), mask5));
+		c[FI_RGBA_GREEN] = Expand5(_mm_and_si128(_mm_srli_epi16(v, FI16_555_GREEN_SHIFT), mask5));
+		c[FI_RGBA_BLUE] = Expand5(_mm_and_si128(_mm_srli_epi16(v, FI16_555_BLUE_SHIFT), mask5));
+	}
+	c[FI_RGBA_ALPHA] = _mm_set1_epi16(0xFF);
+	const __m128i lo = _mm_or_si128(c[0], _mm_slli_epi16(c[1], 8));
+	const __m128i hi = _mm_or_si128(c[2], _mm_slli_epi16(c[3], 8));
+	p0 = _mm_unpacklo_epi16(lo, hi);
+	p1 = _mm_unpackhi_epi16(lo, hi);
+}
+
+/// Shuffle of 4 32-bit pixels into 12 bytes of 24-bit pixels
+FI_TARGET("ssse3") static inline __m128i
+Pack24Mask() {
+	return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+}
+
+FI_TARGET("ssse3") static unsigned
+Line24To32_SSSE3(uint8_t *target, const uint8_t *source, unsigned width) {
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+	unsigned x = 0;
+
+	// 16 pixels from 48 bytes
+	for (; x + 16 <= width; x += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(source + x * 3));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(source + x * 3 + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(source + x * 3 + 32));
+		__m128i *dst = (__m128i *)(target + x * 4);
+		_mm_storeu_si128(dst + 0, _mm_or_si128(_mm_shuffle_epi8(a, mask), alpha));
+		_mm_storeu_si128(dst + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), mask), alpha));
+		_mm_storeu_si128(dst + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), mask), alpha));
+		_mm_storeu_si128(dst + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), mask), alpha));
+	}
+	return x;
+}
+
+FI_TARGET("ssse3") static unsigned
+Line32To24_SSSE3(uint8_t *target, const uint8_t *source, unsigned width) {
+	const __m128i mask = Pack24Mask();
+	unsigned x = 0;
+
+	// 16 pixels into 48 bytes
+	for (; x + 16 <= width; x += 16) {
+		const __m128i *src = (const __m128i *)(source + x * 4);
+		const __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(src + 0), mask);
+		const __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(src + 1), mask);
+		const __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(src + 2), mask);
+		const __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(src + 3), mask);
+		__m128i *dst = (__m128i *)(target + x * 3);
+		_mm_storeu_si128(dst + 0, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+		_mm_storeu_si128(dst + 1, _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+		_mm_storeu_si128(dst + 2, _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+	}
+	return x;
+}
+
+template <bool RGB565>
+FI_TARGET("ssse3") static unsigned
+Line16To24_SSSE3(uint8_t *target, const uint8_t *source, unsigned width) {
+	const __m128i mask = Pack24Mask();
+	unsigned x = 0;
+
+	// 8 pixels into 24 bytes
+	for (; x + 8 <= width; x += 8) {
+		__m128i p0, p1;
+		Unpack16_SSSE3<RGB565>(source + x * 2, p0, p1);
+		p0 = _mm_shuffle_epi8(p0, mask);
+		p1 = _mm_shuffle_epi8(p1, mask);
+		_mm_storeu_si128((__m128i *)(target + x * 3), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+		_mm_storel_epi64((__m128i *)(target + x * 3 + 16), _mm_srli_si128(p1, 4));
+	}
+	return x;
+}
+
+template <bool RGB565>
+FI_TARGET("ssse3") static unsigned
+Line16To32_SSSE3(uint8_t *target, const uint8_t *source, unsigned width) {
+	unsigned x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		__m128i p0, p1;
+		Unpack16_SSSE3<RGB565>(source + x * 2, p0, p1);
+		_mm_storeu_si128((__m128i *)(target + x * 4), p0);
+		_mm_storeu_si128((__m128i *)(target + x * 4 + 16), p1);
+	}
+	return x;
+}
+
+FI_TARGET("ssse3") static unsigned
+SwapRedBlue24_SSSE3(uint8_t *line, unsigned width) {
+	// 5 pixels (15 bytes) at a time, the 16th byte is written back as it was read
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+	unsigned x = 0;
+
+	for (; x + 6 <= width; x += 5) {
+		__m128i *p = (__m128i *)(line + x * 3);
+		_mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+	}
+	return x;
+}
+
+FI_TARGET("ssse3") static unsigned
+SwapRedBlue32_SSSE3(uint8_t *line, unsigned width) {
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	unsigned x = 0;
+
+	for (; x + 4 <= width; x += 4) {
+		__m128i *p = (__m128i *)(line + x * 4);
+		_mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+	}
+	return x;
+}
+
+// ----------------------------------------------------------
+//  AVX2
+// ----------------------------------------------------------
+
+FI_TARGET("avx2") static unsigned
+Line24To32_AVX2(uint8_t *target, const uint8_t *source, unsigned width) {
+	// 4 pixels per 128-bit lane
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+	unsigned x = 0;
+
+	// the second lane reads 4 bytes past the 8 pixels
+	for (; x + 10 <= width; x += 8) {
+		const uint8_t *src = source + x * 3;
+		const __m256i p = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)), _mm_loadu_si128((const __m128i *)(src + 12)), 1);
+		_mm256_storeu_si256((__m256i *)(target + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(p, mask), alpha));
+	}
+	return x + Line24To32_SSSE3(target + x * 4, source + x * 3, width - x);
+}
+
+FI_TARGET("avx2") static unsigned
+Line32To24_AVX2(uint8_t *target, const uint8_t *source, unsigned width) {
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i order = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	unsigned x = 0;
+
+	// 8 pixels into 24 bytes
+	for (; x + 8 <= width; x += 8) {
+		const __m256i p = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(source + x * 4)), mask), order);
+		_mm_storeu_si128((__m128i *)(target + x * 3), _mm256_castsi256_si128(p));
+		_mm_storel_epi64((__m128i *)(target + x * 3 + 16), _mm256_extracti128_si256(p, 1));
+	}
+	return x;
+}
+
+#ifdef FI_CONVERSION_PALETTE
+
+FI_TARGET("avx2") static unsigned
+Line8To24_AVX2(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette) {
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i order = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	unsigned x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(source + x)));
+		const __m256i pixels = _mm256_i32gather_epi32((const int *)palette, index, 4);
+		const __m256i p = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, mask), order);
+		_mm_storeu_si128((__m128i *)(target + x * 3), _mm256_castsi256_si128(p));
+		_mm_storel_epi64((__m128i *)(target + x * 3 + 16), _mm256_extracti128_si256(p, 1));
+	}
+	return x;
+}
+
+FI_TARGET("avx2") static unsigned
+Line8To32_AVX2(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette) {
+	const __m256i alpha = _mm256_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+	unsigned x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(source + x)));
+		const __m256i pixels = _mm256_i32gather_epi32((const int *)palette, index, 4);
+		_mm256_storeu_si256((__m256i *)(target + x * 4), _mm256_or_si256(pixels, alpha));
+	}
+	return x;
+}
+
+#endif // FI_CONVERSION_PALETTE
+
+template <bool RGB565>
+FI_TARGET("avx2") static unsigned
+Line16To32_AVX2(uint8_t *target, const uint8_t *source, unsigned width) {
+	const __m256i mask5 = _mm256_set1_epi16(0x1F);
+	const __m256i k255 = _mm256_set1_epi16(255);
+	unsigned x = 0;
+
+	for (; x + 16 <= width; x += 16) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)(source + x * 2));
+		__m256i c[4];
+		// floor(x * 255 / 31) and floor(x * 255 / 63), as in Expand5 and Expand6
+		if (RGB565) {
+			c[FI_RGBA_RED] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_565_RED_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_565_GREEN_SHIFT), _mm256_set1_epi16(0x3F));
+			c[FI_RGBA_BLUE] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_565_BLUE_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(c[FI_RGBA_GREEN], k255), _mm256_set1_epi16(4)), _mm256_set1_epi16(1040));
+		} else {
+			c[FI_RGBA_RED] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_555_RED_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_555_GREEN_SHIFT), mask5);
+			c[FI_RGBA_BLUE] = _mm256_and_si256(_mm256_srli_epi16(v, FI16_555_BLUE_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(c[FI_RGBA_GREEN], k255), _mm256_set1_epi16(1)), _mm256_set1_epi16(2114));
+		}
+		c[FI_RGBA_RED] = _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(c[FI_RGBA_RED], k255), _mm256_set1_epi16(1)), _mm256_set1_epi16(2114));
+		c[FI_RGBA_BLUE] = _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(c[FI_RGBA_BLUE], k255), _mm256_set1_epi16(1)), _mm256_set1_epi16(2114));
+		c[FI_RGBA_ALPHA] = _mm256_set1_epi16(0xFF);
+
+		// the unpacks work within 128-bit lanes: pixels 0-3 and 8-11, 4-7 and 12-15
+		const __m256i lo = _mm256_or_si256(c[0], _mm256_slli_epi16(c[1], 8));
+		const __m256i hi = _mm256_or_si256(c[2], _mm256_slli_epi16(c[3], 8));
+		const __m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+		const __m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+		_mm256_storeu_si256((__m256i *)(target + x * 4), _mm256_permute2x128_si256(p0, p1, 0x20));
+		_mm256_storeu_si256((__m256i *)(target + x * 4 + 32), _mm256_permute2x128_si256(p0, p1, 0x31));
+	}
+	return x + Line16To32_SSSE3<RGB565>(target + x * 4, source + x * 2, width - x);
+}
+
+FI_TARGET("avx2") static unsigned
+SwapRedBlue32_AVX2(uint8_t *line, unsigned width) {
+	const __m256i mask = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	unsigned x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		__m256i *p = (__m256i *)(line + x * 4);
+		_mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+	}
+	return x + SwapRedBlue32_SSSE3(line + x * 4, width - x);
+}
+
+static const LineConverters *
+SelectLineConverters() {
+#ifdef FI_CONVERSION_PALETTE
+#  define FI_PALETTE_CONVERTERS(line8To24, line8To32) line8To24, line8To32
+#else
+#  define FI_PALETTE_CONVERTERS(line8To24, line8To32) NULL, NULL
+#endif
+	static const LineConverters avx2 = {
+		Line24To32_AVX2, Line32To24_AVX2,
+		FI_PALETTE_CONVERTERS(Line8To24_AVX2, Line8To32_AVX2),
+		Line16To24_SSSE3<false>, Line16To24_SSSE3<true>, Line16To32_AVX2<false>, Line16To32_AVX2<true>,
+		SwapRedBlue24_SSSE3, SwapRedBlue32_AVX2
+	};
+	static const LineConverters ssse3 = {
+		Line24To32_SSSE3, Line32To24_SSSE3,
+		FI_PALETTE_CONVERTERS(Line8To24_Words, Line8To32_Words),
+		Line16To24_SSSE3<false>, Line16To24_SSSE3<true>, Line16To32_SSSE3<false>, Line16To32_SSSE3<true>,
+		SwapRedBlue24_SSSE3, SwapRedBlue32_SSSE3
+	};
+#undef FI_PALETTE_CONVERTERS
+
+	const unsigned features = FreeImage_GetCPUFeatures();
+	if (features & FI_CPU_AVX2) {
+		return &avx2;
+	}
+	if (features & FI_CPU_SSSE3) {
+		return &ssse3;
+	}
+	return NULL;
+}
+
+#elif defined(FI_CONVERSION_NEON)
+
+// ----------------------------------------------------------
+//  NEON
+// ----------------------------------------------------------
+
+/// floor(x * 255 / 31) of 5-bit values, or floor(x * 255 / 63) of 6-bit values
+static inline uint8x8_t
+Expand(uint16x8_t x, uint16_t bias, uint16_t factor) {
+	const uint16x8_t v = vmlaq_n_u16(vdupq_n_u16(bias), x, 255);
+	const uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(v), factor), 16);
+	const uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(v), factor), 16);
+	return vmovn_u16(vcombine_u16(lo, hi));
+}
+
+/// Unpacks 8 16-bit pixels into their red, green and blue samples
+template <bool RGB565>
+static inline void
+Unpack16_NEON(const uint8_t *source, uint8x8_t &r, uint8x8_t &g, uint8x8_t &b) {
+	const uint16x8_t v = vld1q_u16((const uint16_t *)source);
+	const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+	if (RGB565) {
+		r = Expand(vandq_u16(vshrq_n_u16(v, FI16_565_RED_SHIFT), mask5), 1, 2114);
+		g = Expand(vandq_u16(vshrq_n_u16(v, FI16_565_GREEN_SHIFT), vdupq_n_u16(0x3F)), 4, 1040);
+		b = Expand(vandq_u16(v, mask5), 1, 2114);
+	} else {
+		r = Expand(vandq_u16(vshrq_n_u16(v, FI16_555_RED_SHIFT), mask5), 1, 2114);
+		g = Expand(vandq_u16(vshrq_n_u16(v, FI16_555_GREEN_SHIFT), mask5), 1, 2114);
+		b = Expand(vandq_u16(v, mask5), 1, 2114);
+	}
+}
+
+static unsigned
+Line24To32_NEON(uint8_t *target, const uint8_t *source, unsigned width) {
+	unsigned x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8x16x3_t p = vld3q_u8(source + x * 3);
+		uint8x16x4_t q;
+		q.val[0] = p.val[0];
+		q.val[1] = p.val[1];
+		q.val[2] = p.val[2];
+		q.val[3] = vdupq_n_u8(0xFF);
+		vst4q_u8(target + x * 4, q);
+	}
+	return x;
+}
+
+static unsigned
+Line32To24_NEON(uint8_t *target, const uint8_t *source, unsigned width) {
+	unsigned x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8x16x4_t p = vld4q_u8(source + x * 4);
+		uint8x16x3_t q;
+		q.val[0] = p.val[0];
+		q.val[1] = p.val[1];
+		q.val[2] = p.val[2];
+		vst3q_u8(target + x * 3, q);
+	}
+	return x;
+}
+
+template <bool RGB565>
+static unsigned
+Line16To24_NEON(uint8_t *target, const uint8_t *source, unsigned width) {
+	unsigned x = 0;
+	for (; x + 8 <= width; x += 8) {
+		uint8x8x3_t q;
+		Unpack16_NEON<RGB565>(source + x * 2, q.val[FI_RGBA_RED], q.val[FI_RGBA_GREEN], q.val[FI_RGBA_BLUE]);
+		vst3_u8(target + x * 3, q);
+	}
+	return x;
+}
+
+template <bool RGB565>
+static unsigned
+Line16To32_NEON(uint8_t *target, const uint8_t *source, unsigned width) {
+	unsigned x = 0;
+	for (; x + 8 <= width; x += 8) {
+		uint8x8x4_t q;
+		Unpack16_NEON<RGB565>(source + x * 2, q.val[FI_RGBA_RED], q.val[FI_RGBA_GREEN], q.val[FI_RGBA_BLUE]);
+		q.val[FI_RGBA_ALPHA] = vdup_n_u8(0xFF);
+		vst4_u8(target + x * 4, q);
+	}
+	return x;
+}
+
+static unsigned
+SwapRedBlue24_NEON(uint8_t *line, unsigned width) {
+	unsigned x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x16x3_t p = vld3q_u8(line + x * 3);
+		const uint8x16_t t = p.val[0];
+		p.val[0] = p.val[2];
+		p.val[2] = t;
+		vst3q_u8(line + x * 3, p);
+	}
+	return x;
+}
+
+static unsigned
+SwapRedBlue32_NEON(uint8_t *line, unsigned width) {
+	unsigned x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x16x4_t p = vld4q_u8(line + x * 4);
+		const uint8x16_t t = p.val[0];
+		p.val[0] = p.val[2];
+		p.val[2] = t;
+		vst4q_u8(line + x * 4, p);
+	}
+	return x;
+}
+
+static const LineConverters *
+SelectLineConverters() {
+	static const LineConverters neon = {
+		Line24To32_NEON, Line32To24_NEON,
+#ifdef FI_CONVERSION_PALETTE
+		Line8To24_Words, Line8To32_Words,
+#else
+		NULL, NULL,
+#endif
+		Line16To24_NEON<false>, Line16To24_NEON<true>, Line16To32_NEON<false>, Line16To32_NEON<true>,
+		SwapRedBlue24_NEON, SwapRedBlue32_NEON
+	};
+	return (FreeImage_GetCPUFeatures() & FI_CPU_NEON) ? &neon : NULL;
+}
+
+#else
+
+static const LineConverters *
+SelectLineConverters() {
+	return NULL;
+}
+
+#endif
+
+const LineConverters*
+GetLineConverters() {
+	static const LineConverters * const converters = SelectLineConverters();
+	return converters;
+}
@@ -0,0 +1,49 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_CONVERSION_SIMD_H_
+#define FREEIMAGE_CONVERSION_SIMD_H_
+
+#include "FreeImage.h"
+#include "Utilities.h"
+
+/**
+ Vectorized versions of the hot FreeImage_ConvertLine* functions and of SwapRedBlue32.<br>
+ Each one converts the pixels of the line from the first one for as long as it can work on
+ whole vectors, and returns how many it converted: the scalar function does the others.
+ Members are NULL if there is no vector version for the CPU.
+*/
+typedef struct tagLineConverters {
+	/// 24-bit to 32-bit pixels, with an opaque alpha
+	unsigned (*line24To32)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// 32-bit to 24-bit pixels
+	unsigned (*line32To24)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// 8-bit palette indices to 24-bit pixels
+	unsigned (*line8To24)(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette);
+	/// 8-bit palette indices to 32-bit pixels, with an opaque alpha
+	unsigned (*line8To32)(uint8_t *target, const uint8_t *source, unsigned width, const FIRGBA8 *palette);
+	/// 16-bit 555 to 24-bit pixels
+	unsigned (*line16To24_555)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// 16-bit 565 to 24-bit pixels
+	unsigned (*line16To24_565)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// 16-bit 555 to 32-bit pixels, with an opaque alpha
+	unsigned (*line16To32_555)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// 16-bit 565 to 32-bit pixels, with an opaque alpha
+	unsigned (*line16To32_565)(uint8_t *target, const uint8_t *source, unsigned width);
+	/// Swaps the red and blue samples of 24-bit pixels in place
+	unsigned (*swapRedBlue24)(uint8_t *line, unsigned width);
+	/// Swaps the red and blue samples of 32-bit pixels in place
+	unsigned (*swapRedBlue32)(uint8_t *line, unsigned width);
+} LineConverters;
+
+/**
+Returns the converters for the CPU the library runs on (AVX2, SSSE3 or NEON), selected
+on the first call. Define FREEIMAGE_NO_SIMD to build without them.
+@return Returns the converters, or NULL if there are none
+*/
+const LineConverters* GetLineConverters();
+
+#endif // FREEIMAGE_CONVERSION_SIMD_H_
@@ -230,6 +230,65 @@ private:
 	}
 };
 
+/**
+ Kaiser-windowed sinc filter<br>
+
+ Similar to CLanczos3Filter, but the Kaiser window trades sharpness against ringing with
+ its alpha parameter. Width 3 and alpha 4 are good defaults for mipmap generation.<br><br>
+
+ <b>Reference</b> : <br>
+ Kaiser J.F., Schafer R.W., On the use of the I0-sinh window for spectrum analysis. 
+ IEEE Trans. Acoustics, Speech, and Signal Processing, vol. 28, no. 1, pp. 105-107, Feb. 1980.
+*/
+class CKaiserFilter : public CGenericFilter
+{
+protected:
+	/// Window shape parameter
+	double m_dAlpha;
+	/// 1 / I0(alpha)
+	double m_dScale;
+
+public:
+    /**
+	Constructor<br>
+	Default fixed width = 3
+	@param alpha Window shape parameter (default value is 4)
+	*/
+	CKaiserFilter(double alpha = 4) : CGenericFilter(3), m_dAlpha(alpha) {
+		m_dScale = 1 / bessel0(alpha);
+	}
+    virtual ~CKaiserFilter() {}
+
+    double Filter(double dVal) { 
+		dVal = fabs(dVal); 
+		if(dVal < m_dWidth)	{
+			const double t = dVal / m_dWidth;
+			return (sinc(dVal) * bessel0(m_dAlpha * sqrt(1 - t * t)) * m_dScale);
+		}
+		return 0;
+	}
+
+private:
+	double sinc(double value) {
+		if(value != 0) {
+			value *= FILTER_PI;
+			return (sin(value) / value);
+		} 
+		return 1;
+	}
+
+	/// Zeroth order modified Bessel function of the first kind (power series)
+	static double bessel0(double x) {
+		const double xh = 0.25 * x * x;
+		double sum = 1, term = 1;
+		for(int k = 1; k < 64 && term > sum * 1e-16; k++) {
+			term *= xh / (double(k) * double(k));
+			sum += term;
+		}
+		return sum;
+	}
+};
+
 /**
  4th order (cubic) b-spline<br>
 
@@ -22,31 +22,35 @@
 
 #include "Resize.h"
 
-FIBITMAP * DLL_CALLCONV
-FreeImage_RescaleRect(FIBITMAP *src, int dst_width, int dst_height, int src_left, int src_top, int src_right, int src_bottom, FREE_IMAGE_FILTER filter, unsigned flags) {
-	FIBITMAP *dst = NULL;
+#include <atomic>
+#include <thread>
 
-	const int src_width = FreeImage_GetWidth(src);
-	const int src_height = FreeImage_GetHeight(src);
-
-	if (!FreeImage_HasPixels(src) || (dst_width <= 0) || (dst_height <= 0) || (src_width <= 0) || (src_height <= 0)) {
-		return NULL;
-	}
+/// Number of threads of FreeImage_Rescale and FreeImage_RescaleRect, 0 for one per hardware thread
+static std::atomic<unsigned> s_rescale_threads(1);
 
-	// normalize the rectangle
-	if (src_right < src_left) {
-		INPLACESWAP(src_left, src_right);
+/**
+Returns the number of threads for a call of FreeImage_RescaleRect.
+@param flags Flags of the call; FI_RESCALE_MULTITHREADED selects one thread per hardware
+thread, unless FreeImage_SetRescaleThreads set another number
+*/
+static unsigned
+GetRescaleThreads(unsigned flags) {
+	unsigned threads = s_rescale_threads;
+	if (threads == 1 && (flags & FI_RESCALE_MULTITHREADED) == FI_RESCALE_MULTITHREADED) {
+		threads = 0;
 	}
-	if (src_bottom < src_top) {
-		INPLACESWAP(src_top, src_bottom);
-	}
-
-	// check the size of the sub image
-	if((src_left < 0) || (src_right > src_width) || (src_top < 0) || (src_bottom > src_height)) {
-		return NULL;
+	if (threads == 0) {
+		threads = MAX(std::thread::hardware_concurrency(), 1U);
 	}
+	return threads;
+}
 
-	// select the filter
+/**
+Creates the CGenericFilter for one of the FREE_IMAGE_FILTER constants.
+@return Returns the filter, which must be deleted by the caller, or NULL
+*/
+static CGenericFilter *
+CreateFilter(FREE_IMAGE_FILTER filter) {
 	CGenericFilter *pFilter = NULL;
 	switch (filter) {
 		case FILTER_BOX:
@@ -67,13 +71,45 @@ FreeImage_RescaleRect(FIBITMAP *src, int dst_width, int dst_height, int src_left
 		case FILTER_LANCZOS3:
 			pFilter = new(std::nothrow) CLanczos3Filter();
 			break;
+		case FILTER_KAISER:
+			pFilter = new(std::nothrow) CKaiserFilter();
+			break;
 	}
+	return pFilter;
+}
+
+FIBITMAP * DLL_CALLCONV
+FreeImage_RescaleRect(FIBITMAP *src, int dst_width, int dst_height, int src_left, int src_top, int src_right, int src_bottom, FREE_IMAGE_FILTER filter, unsigned flags) {
+	FIBITMAP *dst = NULL;
+
+	const int src_width = FreeImage_GetWidth(src);
+	const int src_height = FreeImage_GetHeight(src);
+
+	if (!FreeImage_HasPixels(src) || (dst_width <= 0) || (dst_height <= 0) || (src_width <= 0) || (src_height <= 0)) {
+		return NULL;
+	}
+
+	// normalize the rectangle
+	if (src_right < src_left) {
+		INPLACESWAP(src_left, src_right);
+	}
+	if (src_bottom < src_top) {
+		INPLACESWAP(src_top, src_bottom);
+	}
+
+	// check the size of the sub image
+	if((src_left < 0) || (src_right > src_width) || (src_top < 0) || (src_bottom > src_height)) {
+		return NULL;
+	}
+
+	// select the filter
+	CGenericFilter *pFilter = CreateFilter(filter);
 
 	if (!pFilter) {
 		return NULL;
 	}
 
-	CResizeEngine Engine(pFilter);
+	CResizeEngine Engine(pFilter, GetRescaleThreads(flags));
 
 	dst = Engine.scale(src, dst_width, dst_height, src_left, src_top,
 			src_right - src_left, src_bottom - src_top, flags);
@@ -93,6 +129,325 @@ FreeImage_Rescale(FIBITMAP *src, int dst_width, int dst_height, FREE_IMAGE_FILTE
 	return FreeImage_RescaleRect(src, dst_width, dst_height, 0, 0, FreeImage_GetWidth(src), FreeImage_GetHeight(src), filter, FI_RESCALE_DEFAULT);
 }
 
+void DLL_CALLCONV
+FreeImage_SetRescaleThreads(unsigned threads) {
+	s_rescale_threads = threads;
+}
+
+unsigned DLL_CALLCONV
+FreeImage_GetRescaleThreads(void) {
+	return s_rescale_threads;
+}
+
+// --------------------------------------------------------------------------
+// Mipmap chains
+// --------------------------------------------------------------------------
+
+/// Largest number of levels of a mipmap chain (for a width or height of 2^31)
+#define MIPMAP_MAX_LEVELS	32
+
+/// Data of a FIMIPMAPS handle
+typedef struct tagMIPMAPCHAIN {
+	/// All levels, one after the other, each one aligned on FIBITMAP_ALIGNMENT bytes
+	uint8_t *bits;
+	/// Size of bits, in bytes
+	size_t size;
+	/// Number of levels
+	unsigned count;
+	/// Bitmaps wrapping the levels in bits
+	FIBITMAP *level[MIPMAP_MAX_LEVELS];
+} MIPMAPCHAIN;
+
+/// Weights of one filter pass of FreeImage_GenerateMipmaps, kept for passes of the same sizes
+typedef struct tagMIPMAPWEIGHTS {
+	unsigned dst_size, src_size;
+	CWeightsTable *table;
+} MIPMAPWEIGHTS;
+
+/**
+Returns the weights table from src_size to dst_size, computing it only if
+it is not in the cache yet.
+*/
+static CWeightsTable *
+GetMipmapWeights(std::vector<MIPMAPWEIGHTS> &cache, CGenericFilter *pFilter, unsigned dst_size, unsigned src_size) {
+	for (size_t i = 0; i < cache.size(); i++) {
+		if (cache[i].dst_size == dst_size && cache[i].src_size == src_size) {
+			return cache[i].table;
+		}
+	}
+	MIPMAPWEIGHTS weights = { dst_size, src_size, new(std::nothrow) CWeightsTable(pFilter, dst_size, src_size) };
+	if (weights.table) {
+		cache.push_back(weights);
+	}
+	return weights.table;
+}
+
+/**
+Returns the share of pixels of an RGBA image, whose alpha scaled by 'scale'
+is above 'alpha_ref'.
+@param dib Image of four Tchannel channels per pixel
+@param alpha Index of the alpha channel
+@param alpha_ref Reference alpha value, in units of Tchannel
+@param scale Alpha scale
+*/
+template <class Tchannel> static double
+GetAlphaCoverage(FIBITMAP *dib, unsigned alpha, double alpha_ref, double scale) {
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	uint64_t covered = 0;
+
+	for (unsigned y = 0; y < height; y++) {
+		const Tchannel *bits = (Tchannel *)FreeImage_GetScanLine(dib, y) + alpha;
+		for (unsigned x = 0; x < width; x++) {
+			if ((double)bits[0] * scale > alpha_ref) {
+				covered++;
+			}
+			bits += 4;
+		}
+	}
+	return (double)covered / ((double)width * height);
+}
+
+/**
+Scales the alpha of an RGBA image, so that its coverage at 'alpha_ref' gets
+as close to 'coverage' as possible.
+@param dib Image of four Tchannel channels per pixel
+@param alpha Index of the alpha channel
+@param alpha_ref Reference alpha value, in units of Tchannel
+@param coverage Coverage to keep
+@param max_value Largest value of a channel, for clamping
+*/
+template <class Tchannel> static void
+KeepAlphaCoverage(FIBITMAP *dib, unsigned alpha, double alpha_ref, double coverage, double max_value) {
+	// bisect the scale, coverage grows with it
+	double lo = 0, hi = 4, best = 1;
+	double best_error = fabs(GetAlphaCoverage<Tchannel>(dib, alpha, alpha_ref, 1) - coverage);
+	for (int i = 0; i < 10 && best_error > 0; i++) {
+		const double scale = (lo + hi) / 2;
+		const double current = GetAlphaCoverage<Tchannel>(dib, alpha, alpha_ref, scale);
+		if (fabs(current - coverage) < best_error) {
+			best_error = fabs(current - coverage);
+			best = scale;
+		}
+		if (current < coverage) {
+			lo = scale;
+		} else {
+			hi = scale;
+		}
+	}
+	if (best == 1) {
+		return;
+	}
+
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	const double round = (max_value > 1) ? 0.5 : 0;
+	for (unsigned y = 0; y < height; y++) {
+		Tchannel *bits = (Tchannel *)FreeImage_GetScanLine(dib, y) + alpha;
+		for (unsigned x = 0; x < width; x++) {
+			bits[0] = (Tchannel)MIN((double)bits[0] * best + round, max_value);
+			bits += 4;
+		}
+	}
+}
+
+FIMIPMAPS * DLL_CALLCONV
+FreeImage_GenerateMipmaps(FIBITMAP *dib, unsigned levels, FREE_IMAGE_FILTER filter, unsigned flags, double alpha_ref) {
+	if (!FreeImage_HasPixels(dib)) {
+		return NULL;
+	}
+
+	// only images that CResizeEngine filters without changing their type or bit depth
+	const FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(dib);
+	const unsigned bpp = FreeImage_GetBPP(dib);
+	switch (image_type) {
+		case FIT_BITMAP:
+			if (!((bpp == 8 && FreeImage_GetColorType(dib) == FIC_MINISBLACK) || bpp == 24 || bpp == 32)) {
+				return NULL;
+			}
+			break;
+		case FIT_UINT16:
+		case FIT_RGB16:
+		case FIT_RGBA16:
+		case FIT_FLOAT:
+		case FIT_RGBF:
+		case FIT_RGBAF:
+			break;
+		default:
+			return NULL;
+	}
+
+	// sizes of the levels, down to 1x1 unless fewer levels are asked for
+	unsigned width[MIPMAP_MAX_LEVELS], height[MIPMAP_MAX_LEVELS], pitch[MIPMAP_MAX_LEVELS];
+	size_t offset[MIPMAP_MAX_LEVELS];
+	unsigned count = 0;
+	size_t size = 0;
+	width[0] = FreeImage_GetWidth(dib);
+	height[0] = FreeImage_GetHeight(dib);
+	for (;;) {
+		pitch[count] = ((width[count] * bpp + 31) / 32) * 4;
+		offset[count] = size;
+		size += ((size_t)pitch[count] * height[count] + FIBITMAP_ALIGNMENT - 1) & ~(size_t)(FIBITMAP_ALIGNMENT - 1);
+		count++;
+		if ((width[count - 1] == 1 && height[count - 1] == 1) || count == levels || count == MIPMAP_MAX_LEVELS) {
+			break;
+		}
+		width[count] = MAX(width[count - 1] >> 1, 1U);
+		height[count] = MAX(height[count - 1] >> 1, 1U);
+	}
+
+	FIMIPMAPS *mipmaps = (FIMIPMAPS *)malloc(sizeof(FIMIPMAPS));
+	MIPMAPCHAIN *chain = (MIPMAPCHAIN *)calloc(1, sizeof(MIPMAPCHAIN));
+	CGenericFilter *pFilter = CreateFilter(filter);
+	uint8_t *scratch = NULL;
+	if (count > 1) {
+		// room for the widest result of a horizontal pass, the one of level 1
+		scratch = (uint8_t *)FreeImage_Aligned_Malloc((size_t)pitch[1] * height[0], FIBITMAP_ALIGNMENT);
+	}
+	if (mipmaps) {
+		mipmaps->data = chain;
+	}
+	if (chain) {
+		chain->bits = (uint8_t *)FreeImage_Aligned_Malloc(size, FIBITMAP_ALIGNMENT);
+		chain->size = size;
+	}
+	FIBOOL bSuccess = mipmaps && chain && chain->bits && pFilter && (scratch || count == 1);
+
+	// wrap the levels, all in the one block
+	for (unsigned i = 0; bSuccess && i < count; i++) {
+		chain->level[i] = FreeImage_AllocateHeaderForBits(chain->bits + offset[i], pitch[i], image_type, width[i], height[i], bpp, 0, 0, 0);
+		if (chain->level[i]) {
+			chain->count++;
+		} else {
+			bSuccess = FALSE;
+		}
+	}
+
+	if (bSuccess) {
+		// level 0 is a copy of the image
+		const unsigned line = FreeImage_GetLine(dib);
+		for (unsigned y = 0; y < height[0]; y++) {
+			memcpy(FreeImage_GetScanLine(chain->level[0], y), FreeImage_GetScanLine(dib, y), line);
+		}
+
+		// the alpha test coverage to keep
+		unsigned alpha_type = 0;	// bits per channel of an RGBA image, 0 otherwise
+		double coverage = 0;
+		if ((flags & FI_MIPMAP_ALPHA_COVERAGE) == FI_MIPMAP_ALPHA_COVERAGE) {
+			if (image_type == FIT_BITMAP && bpp == 32) {
+				alpha_type = 8;
+				alpha_ref *= 255;
+				coverage = GetAlphaCoverage<uint8_t>(dib, FI_RGBA_ALPHA, alpha_ref, 1);
+			} else if (image_type == FIT_RGBA16) {
+				alpha_type = 16;
+				alpha_ref *= 65535;
+				coverage = GetAlphaCoverage<uint16_t>(dib, 3, alpha_ref, 1);
+			} else if (image_type == FIT_RGBAF) {
+				alpha_type = 32;
+				coverage = GetAlphaCoverage<float>(dib, 3, alpha_ref, 1);
+			}
+		}
+
+		// filter every level from the one before it
+		CResizeEngine Engine(pFilter);
+		std::vector<MIPMAPWEIGHTS> weights;
+		// FI_MIPMAP_MULTITHREADED is the FI_RESCALE_MULTITHREADED bit
+		const unsigned threads = GetRescaleThreads(flags & FI_MIPMAP_MULTITHREADED);
+
+		for (unsigned i = 1; bSuccess && i < count; i++) {
+			CWeightsTable *xWeights = NULL, *yWeights = NULL;
+			FIBITMAP *tmp = NULL;
+			if (width[i] != width[i - 1]) {
+				xWeights = GetMipmapWeights(weights, pFilter, width[i], width[i - 1]);
+				bSuccess = (xWeights != NULL);
+			}
+			if (height[i] != height[i - 1]) {
+				yWeights = GetMipmapWeights(weights, pFilter, height[i], height[i - 1]);
+				bSuccess = bSuccess && (yWeights != NULL);
+			}
+			if (bSuccess && xWeights && yWeights) {
+				tmp = FreeImage_AllocateHeaderForBits(scratch, pitch[i], image_type, width[i], height[i - 1], bpp, 0, 0, 0);
+				bSuccess = (tmp != NULL);
+			}
+			if (bSuccess) {
+				Engine.scale(chain->level[i - 1], chain->level[i], tmp, xWeights, yWeights, threads);
+
+				switch (alpha_type) {
+					case 8:
+						KeepAlphaCoverage<uint8_t>(chain->level[i], FI_RGBA_ALPHA, alpha_ref, coverage, 255);
+						break;
+					case 16:
+						KeepAlphaCoverage<uint16_t>(chain->level[i], 3, alpha_ref, coverage, 65535);
+						break;
+					case 32:
+						KeepAlphaCoverage<float>(chain->level[i], 3, alpha_ref, coverage, 1);
+						break;
+				}
+			}
+			if (tmp) {
+				FreeImage_Unload(tmp);
+			}
+		}
+
+		for (size_t i = 0; i < weights.size(); i++) {
+			delete weights[i].table;
+		}
+	}
+
+	delete pFilter;
+	FreeImage_Aligned_Free(scratch);
+
+	if (!bSuccess) {
+		if (mipmaps && chain) {
+			FreeImage_UnloadMipmaps(mipmaps);
+		} else {
+			free(chain);
+			free(mipmaps);
+		}
+		return NULL;
+	}
+	return mipmaps;
+}
+
+unsigned DLL_CALLCONV
+FreeImage_GetMipmapCount(FIMIPMAPS *mipmaps) {
+	return mipmaps ? ((MIPMAPCHAIN *)mipmaps->data)->count : 0;
+}
+
+FIBITMAP * DLL_CALLCONV
+FreeImage_GetMipmap(FIMIPMAPS *mipmaps, unsigned level) {
+	if (!mipmaps || level >= ((MIPMAPCHAIN *)mipmaps->data)->count) {
+		return NULL;
+	}
+	return ((MIPMAPCHAIN *)mipmaps->data)->level[level];
+}
+
+uint8_t * DLL_CALLCONV
+FreeImage_GetMipmapBits(FIMIPMAPS *mipmaps, size_t *size) {
+	if (!mipmaps) {
+		return NULL;
+	}
+	MIPMAPCHAIN *chain = (MIPMAPCHAIN *)mipmaps->data;
+	if (size) {
+		*size = chain->size;
+	}
+	return chain->bits;
+}
+
+void DLL_CALLCONV
+FreeImage_UnloadMipmaps(FIMIPMAPS *mipmaps) {
+	if (!mipmaps) {
+		return;
+	}
+	MIPMAPCHAIN *chain = (MIPMAPCHAIN *)mipmaps->data;
+	for (unsigned i = 0; i < chain->count; i++) {
+		FreeImage_Unload(chain->level[i]);
+	}
+	FreeImage_Aligned_Free(chain->bits);
+	free(chain);
+	free(mipmaps);
+}
+
 FIBITMAP * DLL_CALLCONV
 FreeImage_MakeThumbnail(FIBITMAP *dib, int max_pixel_size, FIBOOL convert) {
 	FIBITMAP *thumbnail = NULL;
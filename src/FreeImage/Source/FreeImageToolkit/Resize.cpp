@@ -22,6 +22,10 @@
 // ==========================================================
 
 #include "Resize.h"
+#include "ResizeSIMD.h"
+
+#include <atomic>
+#include <thread>
 
 /**
 Returns the color type of a bitmap. In contrast to FreeImage_GetColorType,
@@ -216,6 +220,58 @@ CWeightsTable::CWeightsTable(CGenericFilter *pFilter, unsigned uDstSize, unsigne
 		}
 
 	} // next dst pixel
+
+	// flat copies of the weights for the vectorized kernels, each pixel padded to an even
+	// number of weights, so that they can be taken in pairs
+	const unsigned stride = (m_WindowSize + 1) & ~1U;
+	unsigned *left = (unsigned*)malloc(m_LineLength * 2 * sizeof(unsigned));
+	int16_t *fixed = (int16_t*)calloc(m_LineLength * stride, sizeof(int16_t));
+	float *real = (float*)calloc(m_LineLength * stride, sizeof(float));
+	if (left && fixed && real) {
+		// wide windows (strong downsampling) would round each weight to a few bits
+		bool fits = (m_WindowSize <= 256);
+		for(unsigned u = 0; u < m_LineLength; u++) {
+			const unsigned count = m_WeightTable[u].Right - m_WeightTable[u].Left;
+			left[u] = m_WeightTable[u].Left;
+			left[m_LineLength + u] = count;
+
+			// round to 2.14 fixed point, and put the rounding error on the largest weight
+			// so that a constant line stays constant
+			int16_t * const w = fixed + u * stride;
+			double total = 0;
+			int sum = 0;
+			unsigned largest = 0;
+			for(unsigned i = 0; i < count; i++) {
+				const double weight = m_WeightTable[u].Weights[i];
+				if (fabs(weight) >= 1.99) {
+					fits = false;
+				}
+				w[i] = (int16_t)floor(CLAMP(weight, -1.99, 1.99) * (1 << 14) + 0.5);
+				real[u * stride + i] = (float)weight;
+				total += weight;
+				sum += w[i];
+				if (fabs(weight) > fabs(m_WeightTable[u].Weights[largest])) {
+					largest = i;
+				}
+			}
+			if (count && fabs(total - 1) < 1e-6) {
+				w[largest] = (int16_t)(w[largest] + (1 << 14) - sum);
+			}
+		}
+		m_LineWeights.left = left;
+		m_LineWeights.count = left + m_LineLength;
+		m_LineWeights.fixed = fits ? fixed : NULL;
+		m_LineWeights.real = real;
+		if (!fits) {
+			free(fixed);
+		}
+		m_LineWeights.stride = stride;
+	} else {
+		free(left);
+		free(fixed);
+		free(real);
+		memset(&m_LineWeights, 0, sizeof(m_LineWeights));
+	}
 }
 
 CWeightsTable::~CWeightsTable() {
@@ -225,6 +281,97 @@ CWeightsTable::~CWeightsTable() {
 	}
 	// free list of pixels contributions
 	free(m_WeightTable);
+	// free the flat copies
+	free((void*)m_LineWeights.left);
+	free((void*)m_LineWeights.fixed);
+	free((void*)m_LineWeights.real);
+}
+
+// --------------------------------------------------------------------------
+
+/// Bytes of source and destination lines in a band of rows
+#define RESIZE_ROW_BAND_BYTES		(256 * 1024)
+/// Bytes of all source rows read for a destination row in a band of columns
+#define RESIZE_COLUMN_BAND_BYTES	(32 * 1024)
+
+/**
+Splits lines [0, lines) into bands of band_lines lines and calls band(first, last)
+for each of them, on up to 'threads' threads including the calling thread. Each thread
+takes the next band as soon as it is done with the previous one, so that the bands of
+threads which could not be started are filtered by the others.
+@param lines Number of lines (rows or columns) to filter
+@param band_lines Number of lines of a band
+@param threads Maximum number of threads, including the calling thread
+@param band Function filtering lines [first, last)
+*/
+template <class Band>
+static void
+ProcessBands(unsigned lines, unsigned band_lines, unsigned threads, const Band &band) {
+	band_lines = MAX(band_lines, 1U);
+	const unsigned bands = lines / band_lines + ((lines % band_lines) != 0);
+	std::atomic<unsigned> next(0);
+
+	const auto work = [&]() {
+		for (unsigned i = next++; i < bands; i = next++) {
+			const unsigned first = i * band_lines;
+			band(first, MIN(first + band_lines, lines));
+		}
+	};
+
+	threads = MIN(threads, bands);
+	if (threads <= 1) {
+		work();
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	try {
+		workers.reserve(threads - 1);
+		for (unsigned i = 1; i < threads; i++) {
+			workers.emplace_back(work);
+		}
+	} catch (...) {
+		// no more threads, the bands are shared by those already running
+	}
+	work();
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+/// Limits the number of threads of a filter pass, so that each one filters about 64K pixels or more
+static unsigned
+BandThreads(unsigned threads, unsigned width, unsigned height) {
+	return MIN(threads, (unsigned)(((uint64_t)width * height) >> 16) + 1);
+}
+
+/**
+Returns the number of rows of a band of the horizontal pass: as many as fit in
+RESIZE_ROW_BAND_BYTES, and small enough for four bands per thread.
+*/
+static unsigned
+RowBand(FIBITMAP *src, FIBITMAP *dst, unsigned height, unsigned threads) {
+	const unsigned line = FreeImage_GetLine(src) + FreeImage_GetLine(dst);
+	unsigned band = MAX(RESIZE_ROW_BAND_BYTES / MAX(line, 1U), 1U);
+	if (threads > 1) {
+		band = MIN(band, MAX(height / (threads * 4), 1U));
+	}
+	return band;
+}
+
+/**
+Returns the number of columns of a band of the vertical pass, a multiple of 64: as many
+as keep the source rows of a filter window within RESIZE_COLUMN_BAND_BYTES, so that they
+are still cached for the next destination rows, and small enough for four bands per thread.
+*/
+static unsigned
+ColumnBand(FIBITMAP *src, FIBITMAP *dst, unsigned width, unsigned window, unsigned threads) {
+	const unsigned bytespp = MAX(MAX(FreeImage_GetBPP(src), FreeImage_GetBPP(dst)) / 8, 1U);
+	unsigned band = (RESIZE_COLUMN_BAND_BYTES / (MAX(window, 1U) * bytespp)) & ~63U;
+	if (threads > 1) {
+		band = MIN(band, (width / (threads * 4)) & ~63U);
+	}
+	return MAX(band, 64U);
 }
 
 // --------------------------------------------------------------------------
@@ -360,6 +507,49 @@ FIBITMAP* CResizeEngine::scale(FIBITMAP *src, unsigned dst_width, unsigned dst_h
 	unsigned src_offset_x = src_left;
 	unsigned src_offset_y = FreeImage_GetHeight(src) - src_height - src_top;
 
+	// filter 8-bit images in linear light and / or with premultiplied alpha, if asked to
+	if (image_type == FIT_BITMAP) {
+		const FIBOOL linear = ((flags & FI_RESCALE_LINEAR) == FI_RESCALE_LINEAR);
+		const FIBOOL premultiply = ((flags & FI_RESCALE_PREMULTIPLY) == FI_RESCALE_PREMULTIPLY) && (dst_bpp == 32);
+		if (linear || premultiply) {
+			FIBITMAP *linear_src = src;
+			if ((src_bpp != dst_bpp) || src_pal || (dst_bpp == 8 && color_type != FIC_MINISBLACK)) {
+				// palletized, 16-bit and MINISWHITE images are filtered from a copy of the
+				// source rectangle in the bit depth of dst, 8-bit ones as MINISBLACK
+				FIBITMAP *rect = FreeImage_Copy(src, src_left, src_top, src_left + src_width, src_top + src_height);
+				linear_src = NULL;
+				if (rect) {
+					switch (dst_bpp) {
+						case 8:
+							linear_src = FreeImage_ConvertToGreyscale(rect);
+							CREATE_GREYSCALE_PALETTE(FreeImage_GetPalette(dst), 256);
+							break;
+						case 24:
+							linear_src = FreeImage_ConvertTo24Bits(rect);
+							break;
+						case 32:
+							linear_src = FreeImage_ConvertTo32Bits(rect);
+							break;
+						default:
+							break;
+					}
+					FreeImage_Unload(rect);
+				}
+				src_offset_x = 0;
+				src_offset_y = 0;
+			}
+			const FIBOOL ok = linear_src && scaleLinear(linear_src, dst, src_offset_x, src_offset_y, src_width, src_height, linear, premultiply);
+			if (linear_src != src) {
+				FreeImage_Unload(linear_src);
+			}
+			if (!ok) {
+				FreeImage_Unload(dst);
+				return NULL;
+			}
+			return dst;
+		}
+	}
+
 	/*
 	Decide which filtering order (xy or yx) is faster for this mapping. 
 	--- The theory ---
@@ -505,11 +695,400 @@ FIBITMAP* CResizeEngine::scale(FIBITMAP *src, unsigned dst_width, unsigned dst_h
 	return dst;
 } 
 
+void CResizeEngine::scale(FIBITMAP *src, FIBITMAP *dst, FIBITMAP *tmp, CWeightsTable *xWeights, CWeightsTable *yWeights, unsigned threads) {
+	const unsigned src_width = FreeImage_GetWidth(src);
+	const unsigned dst_width = FreeImage_GetWidth(dst);
+	const unsigned src_height = FreeImage_GetHeight(src);
+	const unsigned dst_height = FreeImage_GetHeight(dst);
+
+	// xy filtering, as scale() does when downsampling
+	FIBITMAP *ysrc = src;
+	if (xWeights) {
+		FIBITMAP * const xdst = yWeights ? tmp : dst;
+		const unsigned xthreads = BandThreads(threads, dst_width, src_height);
+		ProcessBands(src_height, RowBand(src, xdst, src_height, xthreads), xthreads, [&](unsigned first, unsigned last) {
+			horizontalFilter(*xWeights, src, first, last, src_width, 0, 0, NULL, xdst, dst_width);
+		});
+		ysrc = xdst;
+	}
+	if (yWeights) {
+		const unsigned ythreads = BandThreads(threads, dst_width, dst_height);
+		ProcessBands(dst_width, ColumnBand(ysrc, dst, dst_width, yWeights->getWindowSize(), ythreads), ythreads, [&](unsigned first, unsigned last) {
+			verticalFilter(*yWeights, ysrc, dst_width, first, last, 0, 0, NULL, dst, dst_height);
+		});
+	}
+}
+
+// --------------------------------------------------------------------------
+// Filters in linear light and with premultiplied alpha
+// --------------------------------------------------------------------------
+
+/**
+Conversion of 8-bit samples to and from the 16-bit samples filtered with the
+FI_RESCALE_LINEAR and FI_RESCALE_PREMULTIPLY options
+*/
+typedef struct tagLinearFormat {
+	/// 16-bit (linear) value of each 8-bit sample
+	const uint16_t *to_linear;
+	/// 8-bit sample of each 16-bit (linear) value shifted right by 2
+	const uint8_t *to_8bit;
+	/// Samples per pixel (1, 3 or 4)
+	unsigned channels;
+	/// Whether the color samples are premultiplied by alpha (the last sample)
+	FIBOOL premultiply;
+} LinearFormat;
+
+/// Conversion tables of LinearFormat, computed on the first use
+typedef struct tagLinearTables {
+	uint16_t srgb_to_linear[256];
+	uint8_t linear_to_srgb[16384];
+	uint16_t to_16bit[256];
+	uint8_t to_8bit[16384];
+
+	tagLinearTables() {
+		for (unsigned i = 0; i < 256; i++) {
+			const double value = i / 255.0;
+			const double linear = (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+			srgb_to_linear[i] = (uint16_t)floor(linear * 65535 + 0.5);
+			to_16bit[i] = (uint16_t)(i * 257);
+		}
+		for (unsigned i = 0; i < 16384; i++) {
+			// value at the middle of the range of 16-bit values with the same index
+			const double value = (i * 4 + 1.5) / 65535;
+			const double srgb = (value <= 0.0031308) ? value * 12.92 : 1.055 * pow(value, 1 / 2.4) - 0.055;
+			linear_to_srgb[i] = (uint8_t)CLAMP<int>((int)floor(srgb * 255 + 0.5), 0, 0xFF);
+			to_8bit[i] = (uint8_t)CLAMP<int>((int)floor(value * 255 + 0.5), 0, 0xFF);
+		}
+	}
+} LinearTables;
+
+/**
+Reads a pixel for the filters in linear light / premultiplied alpha.
+@param pixel Source pixel, with 8-bit samples or 16-bit samples as stored by LinearStore
+@param format Sample conversion
+@param samples Receives the 16-bit (linear, premultiplied) samples
+*/
+static inline void
+LinearLoad(const uint8_t *pixel, const LinearFormat &format, double *samples) {
+	if (format.channels == 4) {
+		const double alpha = format.premultiply ? pixel[FI_RGBA_ALPHA] / 255.0 : 1;
+		samples[FI_RGBA_RED] = format.to_linear[pixel[FI_RGBA_RED]] * alpha;
+		samples[FI_RGBA_GREEN] = format.to_linear[pixel[FI_RGBA_GREEN]] * alpha;
+		samples[FI_RGBA_BLUE] = format.to_linear[pixel[FI_RGBA_BLUE]] * alpha;
+		samples[FI_RGBA_ALPHA] = pixel[FI_RGBA_ALPHA] * 257;
+	} else {
+		for (unsigned c = 0; c < format.channels; c++) {
+			samples[c] = format.to_linear[pixel[c]];
+		}
+	}
+}
+
+static inline void
+LinearLoad(const uint16_t *pixel, const LinearFormat &format, double *samples) {
+	for (unsigned c = 0; c < format.channels; c++) {
+		samples[c] = pixel[c];
+	}
+}
+
+/**
+Stores a filtered pixel.
+@param value 16-bit (linear, premultiplied) samples
+@param format Sample conversion
+@param pixel Destination pixel: 16-bit samples are stored as they are, for the next
+filter pass, 8-bit samples are unpremultiplied and converted back
+*/
+static inline void
+LinearStore(const double *value, const LinearFormat &format, uint16_t *pixel) {
+	for (unsigned c = 0; c < format.channels; c++) {
+		pixel[c] = (uint16_t)CLAMP<int>((int)(value[c] + 0.5), 0, 0xFFFF);
+	}
+}
+
+static inline void
+LinearStore(const double *value, const LinearFormat &format, uint8_t *pixel) {
+	if (format.channels == 4) {
+		const double alpha = CLAMP(value[FI_RGBA_ALPHA], 0.0, 65535.0);
+		const double scale = !format.premultiply ? 1 : (alpha >= 0.5) ? 65535 / alpha : 0;
+		pixel[FI_RGBA_RED] = format.to_8bit[CLAMP<int>((int)(value[FI_RGBA_RED] * scale + 0.5), 0, 0xFFFF) >> 2];
+		pixel[FI_RGBA_GREEN] = format.to_8bit[CLAMP<int>((int)(value[FI_RGBA_GREEN] * scale + 0.5), 0, 0xFFFF) >> 2];
+		pixel[FI_RGBA_BLUE] = format.to_8bit[CLAMP<int>((int)(value[FI_RGBA_BLUE] * scale + 0.5), 0, 0xFFFF) >> 2];
+		pixel[FI_RGBA_ALPHA] = (uint8_t)(((int)(alpha + 0.5) * 255 + 32767) / 65535);
+	} else {
+		for (unsigned c = 0; c < format.channels; c++) {
+			pixel[c] = format.to_8bit[CLAMP<int>((int)(value[c] + 0.5), 0, 0xFFFF) >> 2];
+		}
+	}
+}
+
+/**
+Filters rows [first_row, last_row) horizontally, in linear light / premultiplied alpha.
+S and D are uint8_t for 8-bit images and uint16_t for the temporary image between the
+two filter passes.
+*/
+template <class S, class D>
+static void
+HorizontalLinear(CWeightsTable &weightsTable, FIBITMAP *const src, unsigned first_row, unsigned last_row, unsigned src_offset_x, unsigned src_offset_y, const LinearFormat &format, FIBITMAP *const dst, unsigned dst_width) {
+	const unsigned channels = format.channels;
+
+	for (unsigned y = first_row; y < last_row; y++) {
+		// scale each row
+		const S * const src_bits = (S *)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * channels;
+		D *dst_bits = (D *)FreeImage_GetScanLine(dst, y);
+
+		for (unsigned x = 0; x < dst_width; x++) {
+			// loop through row
+			const unsigned iLeft = weightsTable.getLeftBoundary(x);				// retrieve left boundary
+			const unsigned iLimit = weightsTable.getRightBoundary(x) - iLeft;	// retrieve right boundary
+			const S *pixel = src_bits + iLeft * channels;
+			double value[4] = {0, 0, 0, 0};
+			double samples[4];
+
+			for (unsigned i = 0; i < iLimit; i++) {
+				// accumulate weighted effect of each neighboring pixel
+				const double weight = weightsTable.getWeight(x, i);
+				LinearLoad(pixel, format, samples);
+				for (unsigned c = 0; c < channels; c++) {
+					value[c] += weight * samples[c];
+				}
+				pixel += channels;
+			}
+
+			// place result in destination pixel
+			LinearStore(value, format, dst_bits);
+			dst_bits += channels;
+		}
+	}
+}
+
+/**
+Filters columns [first_col, last_col) vertically, row by row, in linear light /
+premultiplied alpha. S and D are as for HorizontalLinear.
+*/
+template <class S, class D>
+static void
+VerticalLinear(CWeightsTable &weightsTable, FIBITMAP *const src, unsigned first_col, unsigned last_col, unsigned src_offset_x, unsigned src_offset_y, const LinearFormat &format, FIBITMAP *const dst, unsigned dst_height) {
+	const unsigned channels = format.channels;
+	const unsigned src_pitch = FreeImage_GetPitch(src);
+	const unsigned dst_pitch = FreeImage_GetPitch(dst);
+	const uint8_t * const src_base = FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * channels * sizeof(S);
+	uint8_t * const dst_base = FreeImage_GetBits(dst);
+
+	for (unsigned y = 0; y < dst_height; y++) {
+		// work on row y in dst
+		const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
+		const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
+		const uint8_t * const src_row = src_base + iLeft * src_pitch;
+		D *dst_bits = (D *)(dst_base + y * dst_pitch) + first_col * channels;
+
+		for (unsigned x = first_col; x < last_col; x++) {
+			const uint8_t *src_bits = src_row + x * channels * sizeof(S);
+			double value[4] = {0, 0, 0, 0};
+			double samples[4];
+
+			for (unsigned i = 0; i < iLimit; i++) {
+				// accumulate weighted effect of each neighboring pixel
+				const double weight = weightsTable.getWeight(y, i);
+				LinearLoad((const S *)src_bits, format, samples);
+				for (unsigned c = 0; c < channels; c++) {
+					value[c] += weight * samples[c];
+				}
+				src_bits += src_pitch;
+			}
+
+			// place result in destination pixel
+			LinearStore(value, format, dst_bits);
+			dst_bits += channels;
+		}
+	}
+}
+
+FIBOOL CResizeEngine::scaleLinear(FIBITMAP *src, FIBITMAP *dst, unsigned src_offset_x, unsigned src_offset_y, unsigned src_width, unsigned src_height, FIBOOL linear, FIBOOL premultiply) {
+	static const LinearTables tables;
+
+	const unsigned dst_width = FreeImage_GetWidth(dst);
+	const unsigned dst_height = FreeImage_GetHeight(dst);
+
+	LinearFormat format;
+	format.to_linear = linear ? tables.srgb_to_linear : tables.to_16bit;
+	format.to_8bit = linear ? tables.linear_to_srgb : tables.to_8bit;
+	format.channels = FreeImage_GetBPP(src) / 8;
+	format.premultiply = premultiply;
+
+	// the result of the first pass keeps 16 bits per sample
+	FIBITMAP *tmp = NULL;
+	if (src_width != dst_width && src_height != dst_height) {
+		const FREE_IMAGE_TYPE tmp_type = (format.channels == 4) ? FIT_RGBA16 : (format.channels == 3) ? FIT_RGB16 : FIT_UINT16;
+		tmp = FreeImage_AllocateT(tmp_type, dst_width, src_height);
+		if (!tmp) {
+			return FALSE;
+		}
+	}
+
+	if (src_width != dst_width) {
+		CWeightsTable weightsTable(m_pFilter, dst_width, src_width);
+		FIBITMAP * const xdst = tmp ? tmp : dst;
+		const unsigned threads = BandThreads(m_Threads, dst_width, src_height);
+		ProcessBands(src_height, RowBand(src, xdst, src_height, threads), threads, [&](unsigned first, unsigned last) {
+			if (tmp) {
+				HorizontalLinear<uint8_t, uint16_t>(weightsTable, src, first, last, src_offset_x, src_offset_y, format, tmp, dst_width);
+			} else {
+				HorizontalLinear<uint8_t, uint8_t>(weightsTable, src, first, last, src_offset_x, src_offset_y, format, dst, dst_width);
+			}
+		});
+	}
+
+	if (src_height != dst_height) {
+		CWeightsTable weightsTable(m_pFilter, dst_height, src_height);
+		FIBITMAP * const ysrc = tmp ? tmp : src;
+		const unsigned threads = BandThreads(m_Threads, dst_width, dst_height);
+		ProcessBands(dst_width, ColumnBand(ysrc, dst, dst_width, weightsTable.getWindowSize(), threads), threads, [&](unsigned first, unsigned last) {
+			if (tmp) {
+				VerticalLinear<uint16_t, uint8_t>(weightsTable, tmp, first, last, 0, 0, format, dst, dst_height);
+			} else {
+				VerticalLinear<uint8_t, uint8_t>(weightsTable, src, first, last, src_offset_x, src_offset_y, format, dst, dst_height);
+			}
+		});
+	}
+
+	if (tmp) {
+		FreeImage_Unload(tmp);
+	}
+	return TRUE;
+}
+
+// --------------------------------------------------------------------------
+
+/**
+Filters rows [first_row, last_row) with the vectorized kernels, if there are kernels for
+the CPU and the image type: 24- and 32-bit images into the same bit depth, RGBF and RGBAF.
+@return Returns TRUE if the rows were filtered, FALSE if the caller has to filter them
+*/
+static FIBOOL
+FilterRowsVector(const LineWeights &weights, FIBITMAP *const src, unsigned first_row, unsigned last_row, unsigned src_offset_x, unsigned src_offset_y, FIBITMAP *const dst, unsigned dst_width) {
+	const ResizeKernels * const kernels = GetResizeKernels();
+	if (!kernels || !weights.left) {
+		return FALSE;
+	}
+
+	const unsigned bpp = FreeImage_GetBPP(src);
+	switch(FreeImage_GetImageType(src)) {
+		case FIT_BITMAP:
+			if ((bpp == 24 || bpp == 32) && FreeImage_GetBPP(dst) == bpp && weights.fixed) {
+				const unsigned bytespp = bpp / 8;
+				const unsigned src_bytes = FreeImage_GetLine(src) - src_offset_x * bytespp;
+				for (unsigned y = first_row; y < last_row; y++) {
+					const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * bytespp;
+					kernels->horizontal8(src_bits, src_bytes, FreeImage_GetScanLine(dst, y), dst_width, bytespp, weights);
+				}
+				return TRUE;
+			}
+			break;
+
+		case FIT_RGBF:
+		case FIT_RGBAF:
+		{
+			const unsigned floatspp = FreeImage_GetBPP(src) / 32;
+			const unsigned src_floats = FreeImage_GetLine(src) / sizeof(float) - src_offset_x * floatspp;
+			for (unsigned y = first_row; y < last_row; y++) {
+				const float * const src_bits = (float*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * floatspp;
+				kernels->horizontalF(src_bits, src_floats, (float*)FreeImage_GetScanLine(dst, y), dst_width, floatspp, weights);
+			}
+			return TRUE;
+		}
+
+		default:
+			break;
+	}
+	return FALSE;
+}
+
+/**
+Filters columns [first_col, last_col) with the vectorized kernels, if there are kernels for
+the CPU and the image type: 8-bit images without palette, 24- and 32-bit images into the
+same bit depth, FLOAT, RGBF and RGBAF. Unlike the scalar filter, it walks the band row by row.
+@return Returns TRUE if the columns were filtered, FALSE if the caller has to filter them
+*/
+static FIBOOL
+FilterColumnsVector(const LineWeights &weights, FIBITMAP *const src, unsigned width, unsigned first_col, unsigned last_col, unsigned src_offset_x, unsigned src_offset_y, const FIRGBA8 *const src_pal, FIBITMAP *const dst, unsigned dst_height) {
+	const ResizeKernels * const kernels = GetResizeKernels();
+	if (!kernels || !weights.left || first_col >= last_col) {
+		return FALSE;
+	}
+
+	const unsigned bpp = FreeImage_GetBPP(src);
+	const unsigned src_pitch = FreeImage_GetPitch(src);
+	const unsigned dst_pitch = FreeImage_GetPitch(dst);
+	switch(FreeImage_GetImageType(src)) {
+		case FIT_BITMAP:
+		{
+			if (!(bpp == 24 || bpp == 32 || (bpp == 8 && !src_pal)) || FreeImage_GetBPP(dst) != bpp || !weights.fixed) {
+				return FALSE;
+			}
+			const uint8_t ** const rows = (const uint8_t **)malloc(weights.stride * sizeof(uint8_t *));
+			if (!rows) {
+				return FALSE;
+			}
+			const unsigned bytespp = bpp / 8;
+			const uint8_t * const src_base = FreeImage_GetBits(src) + src_offset_y * src_pitch + (src_offset_x + first_col) * bytespp;
+			uint8_t * const dst_base = FreeImage_GetBits(dst) + first_col * bytespp;
+			for (unsigned y = 0; y < dst_height; y++) {
+				const unsigned count = weights.count[y];
+				for (unsigned i = 0; i < count; i++) {
+					rows[i] = src_base + (weights.left[y] + i) * src_pitch;
+				}
+				kernels->vertical8(rows, weights.fixed + y * weights.stride, count, dst_base + y * dst_pitch, (last_col - first_col) * bytespp);
+			}
+			free(rows);
+			return TRUE;
+		}
+
+		case FIT_FLOAT:
+		case FIT_RGBF:
+		case FIT_RGBAF:
+		{
+			const float ** const rows = (const float **)malloc(weights.stride * sizeof(float *));
+			if (!rows) {
+				return FALSE;
+			}
+			const unsigned floatspp = FreeImage_GetBPP(src) / 32;
+			const uint8_t * const src_base = FreeImage_GetBits(src) + src_offset_y * src_pitch + (src_offset_x + first_col) * floatspp * sizeof(float);
+			uint8_t * const dst_base = FreeImage_GetBits(dst) + first_col * floatspp * sizeof(float);
+			for (unsigned y = 0; y < dst_height; y++) {
+				const unsigned count = weights.count[y];
+				for (unsigned i = 0; i < count; i++) {
+					rows[i] = (const float *)(src_base + (weights.left[y] + i) * src_pitch);
+				}
+				kernels->verticalF(rows, weights.real + y * weights.stride, count, (float *)(dst_base + y * dst_pitch), (last_col - first_col) * floatspp);
+			}
+			free(rows);
+			return TRUE;
+		}
+
+		default:
+			break;
+	}
+	return FALSE;
+}
+
+// --------------------------------------------------------------------------
+
 void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsigned src_width, unsigned src_offset_x, unsigned src_offset_y, const FIRGBA8 *const src_pal, FIBITMAP *const dst, unsigned dst_width) {
 
 	// allocate and calculate the contributions
 	CWeightsTable weightsTable(m_pFilter, dst_width, src_width);
 
+	const unsigned threads = BandThreads(m_Threads, dst_width, height);
+	ProcessBands(height, RowBand(src, dst, height, threads), threads, [&](unsigned first, unsigned last) {
+		horizontalFilter(weightsTable, src, first, last, src_width, src_offset_x, src_offset_y, src_pal, dst, dst_width);
+	});
+}
+
+void CResizeEngine::horizontalFilter(CWeightsTable &weightsTable, FIBITMAP *const src, unsigned first_row, unsigned last_row, unsigned src_width, unsigned src_offset_x, unsigned src_offset_y, const FIRGBA8 *const src_pal, FIBITMAP *const dst, unsigned dst_width) {
+
+	if (m_Vectorized && FilterRowsVector(weightsTable.getLineWeights(), src, first_row, last_row, src_offset_x, src_offset_y, dst, dst_width)) {
+		return;
+	}
+
 	// step through rows
 	switch(FreeImage_GetImageType(src)) {
 		case FIT_BITMAP:
@@ -524,7 +1103,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							src_offset_x >>= 3;
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t * const dst_bits = FreeImage_GetScanLine(dst, y);
@@ -548,7 +1127,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t * const dst_bits = FreeImage_GetScanLine(dst, y);
@@ -581,7 +1160,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							src_offset_x >>= 3;
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -612,7 +1191,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -649,7 +1228,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// we always have got a palette here
 							src_offset_x >>= 3;
 
-							for (unsigned y = 0; y < height; y++) {
+							for (unsigned y = first_row; y < last_row; y++) {
 								// scale each row
 								const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 								uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -695,7 +1274,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// we always have got a palette for 4-bit images
 							src_offset_x >>= 1;
 
-							for (unsigned y = 0; y < height; y++) {
+							for (unsigned y = first_row; y < last_row; y++) {
 								// scale each row
 								const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 								uint8_t * const dst_bits = FreeImage_GetScanLine(dst, y);
@@ -726,7 +1305,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// we always have got a palette for 4-bit images
 							src_offset_x >>= 1;
 
-							for (unsigned y = 0; y < height; y++) {
+							for (unsigned y = first_row; y < last_row; y++) {
 								// scale each row
 								const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 								uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -764,7 +1343,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// we always have got a palette for 4-bit images
 							src_offset_x >>= 1;
 
-							for (unsigned y = 0; y < height; y++) {
+							for (unsigned y = first_row; y < last_row; y++) {
 								// scale each row
 								const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 								uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -810,7 +1389,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// into an 8 bpp destination image
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t * const dst_bits = FreeImage_GetScanLine(dst, y);
@@ -835,7 +1414,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t * const dst_bits = FreeImage_GetScanLine(dst, y);
@@ -867,7 +1446,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 							// transparently convert the non-transparent 8-bit image to 24 bpp
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -899,7 +1478,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned y = 0; y < height; y++) {
+								for (unsigned y = first_row; y < last_row; y++) {
 									// scale each row
 									const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 									uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -935,7 +1514,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 						{
 							// transparently convert the transparent 8-bit image to 32 bpp; 
 							// we always have got a palette here
-							for (unsigned y = 0; y < height; y++) {
+							for (unsigned y = first_row; y < last_row; y++) {
 								// scale each row
 								const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 								uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -978,9 +1557,9 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 					// transparently convert the 16-bit non-transparent image to 24 bpp
 					if (IS_FORMAT_RGB565(src)) {
 						// image has 565 format
-						for (unsigned y = 0; y < height; y++) {
+						for (unsigned y = first_row; y < last_row; y++) {
 							// scale each row
-							const uint16_t * const src_bits = (uint16_t *)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x / sizeof(uint16_t);
+							const uint16_t * const src_bits = (uint16_t *)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 							uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
 
 							for (unsigned x = 0; x < dst_width; x++) {
@@ -1010,7 +1589,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 						}
 					} else {
 						// image has 555 format
-						for (unsigned y = 0; y < height; y++) {
+						for (unsigned y = first_row; y < last_row; y++) {
 							// scale each row
 							const uint16_t * const src_bits = (uint16_t *)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x;
 							uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -1047,7 +1626,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 				case 24:
 				{
 					// scale the 24-bit non-transparent image into a 24 bpp destination image
-					for (unsigned y = 0; y < height; y++) {
+					for (unsigned y = first_row; y < last_row; y++) {
 						// scale each row
 						const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * 3;
 						uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -1083,7 +1662,7 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 				case 32:
 				{
 					// scale the 32-bit transparent image into a 32 bpp destination image
-					for (unsigned y = 0; y < height; y++) {
+					for (unsigned y = first_row; y < last_row; y++) {
 						// scale each row
 						const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * 4;
 						uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
@@ -1124,11 +1703,11 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 		case FIT_UINT16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / src_width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
-			for (unsigned y = 0; y < height; y++) {
+			for (unsigned y = first_row; y < last_row; y++) {
 				// scale each row
-				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x / sizeof(uint16_t);
+				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * wordspp;
 				uint16_t *dst_bits = (uint16_t*)FreeImage_GetScanLine(dst, y);
 
 				for (unsigned x = 0; x < dst_width; x++) {
@@ -1158,11 +1737,11 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 		case FIT_RGB16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / src_width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
-			for (unsigned y = 0; y < height; y++) {
+			for (unsigned y = first_row; y < last_row; y++) {
 				// scale each row
-				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x / sizeof(uint16_t);
+				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * wordspp;
 				uint16_t *dst_bits = (uint16_t*)FreeImage_GetScanLine(dst, y);
 
 				for (unsigned x = 0; x < dst_width; x++) {
@@ -1196,11 +1775,11 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 		case FIT_RGBA16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / src_width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
-			for (unsigned y = 0; y < height; y++) {
+			for (unsigned y = first_row; y < last_row; y++) {
 				// scale each row
-				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x / sizeof(uint16_t);
+				const uint16_t *src_bits = (uint16_t*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * wordspp;
 				uint16_t *dst_bits = (uint16_t*)FreeImage_GetScanLine(dst, y);
 
 				for (unsigned x = 0; x < dst_width; x++) {
@@ -1238,11 +1817,11 @@ void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsig
 		case FIT_RGBAF:
 		{
 			// Calculate the number of floats per pixel (1 for 32-bit, 3 for 96-bit or 4 for 128-bit)
-			const unsigned floatspp = (FreeImage_GetLine(src) / src_width) / sizeof(float);
+			const unsigned floatspp = FreeImage_GetBPP(src) / 32;
 
-			for(unsigned y = 0; y < height; y++) {
+			for(unsigned y = first_row; y < last_row; y++) {
 				// scale each row
-				const float *src_bits = (float*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x / sizeof(float);
+				const float *src_bits = (float*)FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * floatspp;
 				float *dst_bits = (float*)FreeImage_GetScanLine(dst, y);
 
 				for(unsigned x = 0; x < dst_width; x++) {
@@ -1281,7 +1860,20 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 	// allocate and calculate the contributions
 	CWeightsTable weightsTable(m_pFilter, dst_height, src_height);
 
-	// step through columns
+	const unsigned threads = BandThreads(m_Threads, width, dst_height);
+	ProcessBands(width, ColumnBand(src, dst, width, weightsTable.getWindowSize(), threads), threads, [&](unsigned first, unsigned last) {
+		verticalFilter(weightsTable, src, width, first, last, src_offset_x, src_offset_y, src_pal, dst, dst_height);
+	});
+}
+
+/// Performs vertical image filtering of a band of columns
+void CResizeEngine::verticalFilter(CWeightsTable &weightsTable, FIBITMAP *const src, unsigned width, unsigned first_col, unsigned last_col, unsigned src_offset_x, unsigned src_offset_y, const FIRGBA8 *const src_pal, FIBITMAP *const dst, unsigned dst_height) {
+
+	if (m_Vectorized && FilterColumnsVector(weightsTable.getLineWeights(), src, width, first_col, last_col, src_offset_x, src_offset_y, src_pal, dst, dst_height)) {
+		return;
+	}
+
+	// step through rows, on the columns of the band
 	switch(FreeImage_GetImageType(src)) {
 		case FIT_BITMAP:
 		{
@@ -1300,15 +1892,12 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							// transparently convert the 1-bit non-transparent greyscale image to 8 bpp
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x;
-									const unsigned index = x >> 3;
-									const unsigned mask = 0x80 >> (x & 0x07);
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x;
+										const unsigned index = x >> 3;
+										const unsigned mask = 0x80 >> (x & 0x07);
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1325,20 +1914,16 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 										// clamp and place result in destination pixel
 										*dst_bits = (uint8_t)CLAMP<int>((int)(value + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x;
-									const unsigned index = x >> 3;
-									const unsigned mask = 0x80 >> (x & 0x07);
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x;
+										const unsigned index = x >> 3;
+										const unsigned mask = 0x80 >> (x & 0x07);
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1354,7 +1939,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 										// clamp and place result in destination pixel
 										*dst_bits = (uint8_t)CLAMP<int>((int)(value + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							}
@@ -1366,15 +1950,12 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							// transparently convert the non-transparent 1-bit image to 24 bpp
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x * 3;
-									const unsigned index = x >> 3;
-									const unsigned mask = 0x80 >> (x & 0x07);
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
+										const unsigned index = x >> 3;
+										const unsigned mask = 0x80 >> (x & 0x07);
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1396,20 +1977,16 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 										dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int)(r + 0.5), 0, 0xFF);
 										dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 										dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x * 3;
-									const unsigned index = x >> 3;
-									const unsigned mask = 0x80 >> (x & 0x07);
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
+										const unsigned index = x >> 3;
+										const unsigned mask = 0x80 >> (x & 0x07);
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1428,7 +2005,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 										dst_bits[FI_RGBA_RED]	= bval;
 										dst_bits[FI_RGBA_GREEN]	= bval;
 										dst_bits[FI_RGBA_BLUE]	= bval;
-										dst_bits += dst_pitch;
 									}
 								}
 							}
@@ -1439,15 +2015,12 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 						{
 							// transparently convert the transparent 1-bit image to 32 bpp; 
 							// we always have got a palette here
-							for (unsigned x = 0; x < width; x++) {
-								// work on column x in dst
-								uint8_t *dst_bits = dst_base + x * 4;
-								const unsigned index = x >> 3;
-								const unsigned mask = 0x80 >> (x & 0x07);
-
-								// scale each column
-								for (unsigned y = 0; y < dst_height; y++) {
-									// loop through column
+							for (unsigned y = 0; y < dst_height; y++) {
+								// work on row y in dst
+								for (unsigned x = first_col; x < last_col; x++) {
+									uint8_t *dst_bits = dst_base + y * dst_pitch + x * 4;
+									const unsigned index = x >> 3;
+									const unsigned mask = 0x80 >> (x & 0x07);
 									const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 									const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 									const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1471,7 +2044,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 									dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_ALPHA]	= (uint8_t)CLAMP<int>((int)(a + 0.5), 0, 0xFF);
-									dst_bits += dst_pitch;
 								}
 							}
 						}
@@ -1490,14 +2062,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 						{
 							// transparently convert the non-transparent 4-bit greyscale image to 8 bpp; 
 							// we always have got a palette for 4-bit images
-							for (unsigned x = 0; x < width; x++) {
-								// work on column x in dst
-								uint8_t *dst_bits = dst_base + x;
-								const unsigned index = x >> 1;
-
-								// scale each column
-								for (unsigned y = 0; y < dst_height; y++) {
-									// loop through column
+							for (unsigned y = 0; y < dst_height; y++) {
+								// work on row y in dst
+								for (unsigned x = first_col; x < last_col; x++) {
+									uint8_t *dst_bits = dst_base + y * dst_pitch + x;
+									const unsigned index = x >> 1;
 									const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 									const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 									const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1513,7 +2082,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 									// clamp and place result in destination pixel
 									*dst_bits = (uint8_t)CLAMP<int>((int)(value + 0.5), 0, 0xFF);
-									dst_bits += dst_pitch;
 								}
 							}
 						}
@@ -1523,14 +2091,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 						{
 							// transparently convert the non-transparent 4-bit image to 24 bpp; 
 							// we always have got a palette for 4-bit images
-							for (unsigned x = 0; x < width; x++) {
-								// work on column x in dst
-								uint8_t *dst_bits = dst_base + x * 3;
-								const unsigned index = x >> 1;
-
-								// scale each column
-								for (unsigned y = 0; y < dst_height; y++) {
-									// loop through column
+							for (unsigned y = 0; y < dst_height; y++) {
+								// work on row y in dst
+								for (unsigned x = first_col; x < last_col; x++) {
+									uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
+									const unsigned index = x >> 1;
 									const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 									const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 									const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1552,7 +2117,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 									dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int)(r + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
-									dst_bits += dst_pitch;
 								}
 							}
 						}
@@ -1562,14 +2126,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 						{
 							// transparently convert the transparent 4-bit image to 32 bpp; 
 							// we always have got a palette for 4-bit images
-							for (unsigned x = 0; x < width; x++) {
-								// work on column x in dst
-								uint8_t *dst_bits = dst_base + x * 4;
-								const unsigned index = x >> 1;
-
-								// scale each column
-								for (unsigned y = 0; y < dst_height; y++) {
-									// loop through column
+							for (unsigned y = 0; y < dst_height; y++) {
+								// work on row y in dst
+								for (unsigned x = first_col; x < last_col; x++) {
+									uint8_t *dst_bits = dst_base + y * dst_pitch + x * 4;
+									const unsigned index = x >> 1;
 									const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 									const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 									const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1593,7 +2154,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 									dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_ALPHA]	= (uint8_t)CLAMP<int>((int)(a + 0.5), 0, 0xFF);
-									dst_bits += dst_pitch;
 								}
 							}
 						}
@@ -1613,13 +2173,10 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							// scale the 8-bit non-transparent greyscale image into an 8 bpp destination image
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x;
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x;
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1634,18 +2191,14 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 										// clamp and place result in destination pixel
 										*dst_bits = (uint8_t)CLAMP<int>((int)(value + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x;
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x;
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1660,7 +2213,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 										// clamp and place result in destination pixel
 										*dst_bits = (uint8_t)CLAMP<int>((int)(value + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							}
@@ -1672,13 +2224,10 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							// transparently convert the non-transparent 8-bit image to 24 bpp
 							if (src_pal) {
 								// we have got a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x * 3;
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1699,18 +2248,14 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 										dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int)(r + 0.5), 0, 0xFF);
 										dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 										dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
-										dst_bits += dst_pitch;
 									}
 								}
 							} else {
 								// we do not have a palette
-								for (unsigned x = 0; x < width; x++) {
-									// work on column x in dst
-									uint8_t *dst_bits = dst_base + x * 3;
-
-									// scale each column
-									for (unsigned y = 0; y < dst_height; y++) {
-										// loop through column
+								for (unsigned y = 0; y < dst_height; y++) {
+									// work on row y in dst
+									for (unsigned x = first_col; x < last_col; x++) {
+										uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
 										const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 										const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 										const uint8_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1728,7 +2273,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 										dst_bits[FI_RGBA_RED]	= bval;
 										dst_bits[FI_RGBA_GREEN]	= bval;
 										dst_bits[FI_RGBA_BLUE]	= bval;
-										dst_bits += dst_pitch;
 									}
 								}
 							}
@@ -1739,13 +2283,10 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 						{
 							// transparently convert the transparent 8-bit image to 32 bpp; 
 							// we always have got a palette here
-							for (unsigned x = 0; x < width; x++) {
-								// work on column x in dst
-								uint8_t *dst_bits = dst_base + x * 4;
-
-								// scale each column
-								for (unsigned y = 0; y < dst_height; y++) {
-									// loop through column
+							for (unsigned y = 0; y < dst_height; y++) {
+								// work on row y in dst
+								for (unsigned x = first_col; x < last_col; x++) {
+									uint8_t *dst_bits = dst_base + y * dst_pitch + x * 4;
 									const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 									const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 									const uint8_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1768,7 +2309,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 									dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(g + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(b + 0.5), 0, 0xFF);
 									dst_bits[FI_RGBA_ALPHA]	= (uint8_t)CLAMP<int>((int)(a + 0.5), 0, 0xFF);
-									dst_bits += dst_pitch;
 								}
 							}
 						}
@@ -1785,13 +2325,10 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 
 					if (IS_FORMAT_RGB565(src)) {
 						// image has 565 format
-						for (unsigned x = 0; x < width; x++) {
-							// work on column x in dst
-							uint8_t *dst_bits = dst_base + x * 3;
-
-							// scale each column
-							for (unsigned y = 0; y < dst_height; y++) {
-								// loop through column
+						for (unsigned y = 0; y < dst_height; y++) {
+							// work on row y in dst
+							for (unsigned x = first_col; x < last_col; x++) {
+								uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
 								const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 								const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 								const uint16_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1811,18 +2348,14 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 								dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int)(((r * 0xFF) / 0x1F) + 0.5), 0, 0xFF);
 								dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(((g * 0xFF) / 0x3F) + 0.5), 0, 0xFF);
 								dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(((b * 0xFF) / 0x1F) + 0.5), 0, 0xFF);
-								dst_bits += dst_pitch;
 							}
 						}
 					} else {
 						// image has 555 format
-						for (unsigned x = 0; x < width; x++) {
-							// work on column x in dst
-							uint8_t *dst_bits = dst_base + x * 3;
-
-							// scale each column
-							for (unsigned y = 0; y < dst_height; y++) {
-								// loop through column
+						for (unsigned y = 0; y < dst_height; y++) {
+							// work on row y in dst
+							for (unsigned x = first_col; x < last_col; x++) {
+								uint8_t *dst_bits = dst_base + y * dst_pitch + x * 3;
 								const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 								const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 								const uint16_t *src_bits = src_base + iLeft * src_pitch + x;
@@ -1842,7 +2375,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 								dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int)(((r * 0xFF) / 0x1F) + 0.5), 0, 0xFF);
 								dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int)(((g * 0xFF) / 0x1F) + 0.5), 0, 0xFF);
 								dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int)(((b * 0xFF) / 0x1F) + 0.5), 0, 0xFF);
-								dst_bits += dst_pitch;
 							}
 						}
 					}
@@ -1855,14 +2387,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					const unsigned src_pitch = FreeImage_GetPitch(src);
 					const uint8_t *const src_base = FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * 3;
 
-					for (unsigned x = 0; x < width; x++) {
-						// work on column x in dst
-						const unsigned index = x * 3;
-						uint8_t *dst_bits = dst_base + index;
-
-						// scale each column
-						for (unsigned y = 0; y < dst_height; y++) {
-							// loop through column
+					for (unsigned y = 0; y < dst_height; y++) {
+						// work on row y in dst
+						for (unsigned x = first_col; x < last_col; x++) {
+							const unsigned index = x * 3;
+							uint8_t *dst_bits = dst_base + y * dst_pitch + index;
 							const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 							const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 							const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1882,7 +2411,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							dst_bits[FI_RGBA_RED]	= (uint8_t)CLAMP<int>((int) (r + 0.5), 0, 0xFF);
 							dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int) (g + 0.5), 0, 0xFF);
 							dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int) (b + 0.5), 0, 0xFF);
-							dst_bits += dst_pitch;
 						}
 					}
 				}
@@ -1894,14 +2422,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					const unsigned src_pitch = FreeImage_GetPitch(src);
 					const uint8_t *const src_base = FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * 4;
 
-					for (unsigned x = 0; x < width; x++) {
-						// work on column x in dst
-						const unsigned index = x * 4;
-						uint8_t *dst_bits = dst_base + index;
-
-						// scale each column
-						for (unsigned y = 0; y < dst_height; y++) {
-							// loop through column
+					for (unsigned y = 0; y < dst_height; y++) {
+						// work on row y in dst
+						for (unsigned x = first_col; x < last_col; x++) {
+							const unsigned index = x * 4;
+							uint8_t *dst_bits = dst_base + y * dst_pitch + index;
 							const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 							const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 							const uint8_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1923,7 +2448,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 							dst_bits[FI_RGBA_GREEN]	= (uint8_t)CLAMP<int>((int) (g + 0.5), 0, 0xFF);
 							dst_bits[FI_RGBA_BLUE]	= (uint8_t)CLAMP<int>((int) (b + 0.5), 0, 0xFF);
 							dst_bits[FI_RGBA_ALPHA]	= (uint8_t)CLAMP<int>((int) (a + 0.5), 0, 0xFF);
-							dst_bits += dst_pitch;
 						}
 					}
 				}
@@ -1935,7 +2459,7 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 		case FIT_UINT16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
 			const unsigned dst_pitch = FreeImage_GetPitch(dst) / sizeof(uint16_t);
 			uint16_t *const dst_base = (uint16_t *)FreeImage_GetBits(dst);
@@ -1943,14 +2467,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 			const unsigned src_pitch = FreeImage_GetPitch(src) / sizeof(uint16_t);
 			const uint16_t *const src_base = (uint16_t *)FreeImage_GetBits(src)	+ src_offset_y * src_pitch + src_offset_x * wordspp;
 
-			for (unsigned x = 0; x < width; x++) {
-				// work on column x in dst
-				const unsigned index = x * wordspp;	// pixel index
-				uint16_t *dst_bits = dst_base + index;
-
-				// scale each column
-				for (unsigned y = 0; y < dst_height; y++) {
-					// loop through column
+			for (unsigned y = 0; y < dst_height; y++) {
+				// work on row y in dst
+				for (unsigned x = first_col; x < last_col; x++) {
+					const unsigned index = x * wordspp;	// pixel index
+					uint16_t *dst_bits = dst_base + y * dst_pitch + index;
 					const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 					const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 					const uint16_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -1967,7 +2488,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					// clamp and place result in destination pixel
 					dst_bits[0] = (uint16_t)CLAMP<int>((int)(value + 0.5), 0, 0xFFFF);
 
-					dst_bits += dst_pitch;
 				}
 			}
 		}
@@ -1976,7 +2496,7 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 		case FIT_RGB16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
 			const unsigned dst_pitch = FreeImage_GetPitch(dst) / sizeof(uint16_t);
 			uint16_t *const dst_base = (uint16_t *)FreeImage_GetBits(dst);
@@ -1984,14 +2504,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 			const unsigned src_pitch = FreeImage_GetPitch(src) / sizeof(uint16_t);
 			const uint16_t *const src_base = (uint16_t *)FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * wordspp;
 
-			for (unsigned x = 0; x < width; x++) {
-				// work on column x in dst
-				const unsigned index = x * wordspp;	// pixel index
-				uint16_t *dst_bits = dst_base + index;
-
-				// scale each column
-				for (unsigned y = 0; y < dst_height; y++) {
-					// loop through column
+			for (unsigned y = 0; y < dst_height; y++) {
+				// work on row y in dst
+				for (unsigned x = first_col; x < last_col; x++) {
+					const unsigned index = x * wordspp;	// pixel index
+					uint16_t *dst_bits = dst_base + y * dst_pitch + index;
 					const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 					const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 					const uint16_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -2013,7 +2530,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					dst_bits[1] = (uint16_t)CLAMP<int>((int)(g + 0.5), 0, 0xFFFF);
 					dst_bits[2] = (uint16_t)CLAMP<int>((int)(b + 0.5), 0, 0xFFFF);
 
-					dst_bits += dst_pitch;
 				}
 			}
 		}
@@ -2022,7 +2538,7 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 		case FIT_RGBA16:
 		{
 			// Calculate the number of words per pixel (1 for 16-bit, 3 for 48-bit or 4 for 64-bit)
-			const unsigned wordspp = (FreeImage_GetLine(src) / width) / sizeof(uint16_t);
+			const unsigned wordspp = FreeImage_GetBPP(src) / 16;
 
 			const unsigned dst_pitch = FreeImage_GetPitch(dst) / sizeof(uint16_t);
 			uint16_t *const dst_base = (uint16_t *)FreeImage_GetBits(dst);
@@ -2030,14 +2546,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 			const unsigned src_pitch = FreeImage_GetPitch(src) / sizeof(uint16_t);
 			const uint16_t *const src_base = (uint16_t *)FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * wordspp;
 
-			for (unsigned x = 0; x < width; x++) {
-				// work on column x in dst
-				const unsigned index = x * wordspp;	// pixel index
-				uint16_t *dst_bits = dst_base + index;
-
-				// scale each column
-				for (unsigned y = 0; y < dst_height; y++) {
-					// loop through column
+			for (unsigned y = 0; y < dst_height; y++) {
+				// work on row y in dst
+				for (unsigned x = first_col; x < last_col; x++) {
+					const unsigned index = x * wordspp;	// pixel index
+					uint16_t *dst_bits = dst_base + y * dst_pitch + index;
 					const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
 					const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
 					const uint16_t *src_bits = src_base + iLeft * src_pitch + index;
@@ -2061,7 +2574,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					dst_bits[2] = (uint16_t)CLAMP<int>((int)(b + 0.5), 0, 0xFFFF);
 					dst_bits[3] = (uint16_t)CLAMP<int>((int)(a + 0.5), 0, 0xFFFF);
 
-					dst_bits += dst_pitch;
 				}
 			}
 		}
@@ -2072,7 +2584,7 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 		case FIT_RGBAF:
 		{
 			// Calculate the number of floats per pixel (1 for 32-bit, 3 for 96-bit or 4 for 128-bit)
-			const unsigned floatspp = (FreeImage_GetLine(src) / width) / sizeof(float);
+			const unsigned floatspp = FreeImage_GetBPP(src) / 32;
 
 			const unsigned dst_pitch = FreeImage_GetPitch(dst) / sizeof(float);
 			float *const dst_base = (float *)FreeImage_GetBits(dst);
@@ -2080,14 +2592,11 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 			const unsigned src_pitch = FreeImage_GetPitch(src) / sizeof(float);
 			const float *const src_base = (float *)FreeImage_GetBits(src) + src_offset_y * src_pitch + src_offset_x * floatspp;
 
-			for (unsigned x = 0; x < width; x++) {
-				// work on column x in dst
-				const unsigned index = x * floatspp;	// pixel index
-				float *dst_bits = (float *)dst_base + index;
-
-				// scale each column
-				for (unsigned y = 0; y < dst_height; y++) {
-					// loop through column
+			for (unsigned y = 0; y < dst_height; y++) {
+				// work on row y in dst
+				for (unsigned x = first_col; x < last_col; x++) {
+					const unsigned index = x * floatspp;	// pixel index
+					float *dst_bits = (float *)dst_base + y * dst_pitch + index;
 					const unsigned iLeft = weightsTable.getLeftBoundary(y);    // retrieve left boundary
 					const unsigned iRight = weightsTable.getRightBoundary(y);  // retrieve right boundary
 					const float *src_bits = src_base + iLeft * src_pitch + index;
@@ -2107,7 +2616,6 @@ void CResizeEngine::verticalFilter(FIBITMAP *const src, unsigned width, unsigned
 					for (unsigned j = 0; j < floatspp; j++) {
 						dst_bits[j] = (float)value[j];
 					}
-					dst_bits += dst_pitch;
 				}
 			}
 		}
@@ -28,6 +28,22 @@
 #include "Utilities.h"
 #include "Filters.h" 
 
+/**
+  Weights of a whole line, in the flat layout used by the vectorized kernels of
+  CResizeEngine (see ResizeSIMD.h). Destination pixel u is computed from source pixels
+  left[u] to left[u] + count[u] - 1, with the weights at fixed + u * stride (2.14 fixed
+  point numbers, summing up to exactly 1 << 14 for normalized weights) or real + u * stride.
+  Weights past count[u] are zero. fixed is NULL if the weights don't fit in 2.14 fixed
+  point, or would lose too much precision there.
+*/
+typedef struct tagLineWeights {
+	const unsigned *left;
+	const unsigned *count;
+	const int16_t *fixed;
+	const float *real;
+	unsigned stride;
+} LineWeights;
+
 /**
   Filter weights table.<br>
   This class stores contribution information for an entire line (row or column).
@@ -52,6 +68,8 @@ private:
 	unsigned m_WindowSize;
 	/// Length of line (no. of rows / cols) 
 	unsigned m_LineLength;
+	/// The same weights, for the vectorized kernels
+	LineWeights m_LineWeights;
 
 public:
 	/** 
@@ -93,6 +111,20 @@ public:
 	unsigned getRightBoundary(unsigned dst_pos) {
 		return m_WeightTable[dst_pos].Right;
 	}
+
+	/** Retrieve the filter window size
+	@return Returns the largest number of source pixels of a destination pixel
+	*/
+	unsigned getWindowSize() const {
+		return m_WindowSize;
+	}
+
+	/** Retrieve the weights of the whole line, in fixed point and float
+	@return Returns the weights in the layout of the vectorized kernels
+	*/
+	const LineWeights& getLineWeights() const {
+		return m_LineWeights;
+	}
 };
 
 // ---------------------------------------------
@@ -116,18 +148,33 @@ class CResizeEngine
 private:
 	/// Pointer to the FIR / IIR filter
 	CGenericFilter* m_pFilter;
+	/// Maximum number of threads of each filter pass
+	unsigned m_Threads;
+	/// Whether the filter passes may use the vectorized kernels of ResizeSIMD
+	FIBOOL m_Vectorized;
 
 public:
 
 	/**
 	Constructor
 	@param filter FIR /IIR filter to be used
+	@param threads Maximum number of threads filtering the bands of each pass of
+	scale(), including the calling thread
 	*/
-	CResizeEngine(CGenericFilter* filter):m_pFilter(filter) {}
+	CResizeEngine(CGenericFilter* filter, unsigned threads = 1):m_pFilter(filter), m_Threads(MAX(threads, 1U)), m_Vectorized(TRUE) {}
 
 	/// Destructor
 	virtual ~CResizeEngine() {}
 
+	/**
+	Enables or disables the vectorized kernels. Without them, the engine filters like a
+	library built with FREEIMAGE_NO_SIMD, which is the reference the kernels are tested against.
+	@param vectorized TRUE (the default) to use the kernels where the CPU has them
+	*/
+	void setVectorized(FIBOOL vectorized) {
+		m_Vectorized = vectorized;
+	}
+
 	/** Scale an image to the desired dimensions.
 
 	Method CResizeEngine::scale, as well as the two filtering methods
@@ -159,10 +206,48 @@ public:
 	*/
 	FIBITMAP* scale(FIBITMAP *src, unsigned dst_width, unsigned dst_height, unsigned src_left, unsigned src_top, unsigned src_width, unsigned src_height, unsigned flags);
 
+	/** Scale a whole image into a destination image of the same type and bit depth.
+
+	This is the building block of FreeImage_GenerateMipmaps. Unlike the method above,
+	it neither allocates images nor computes weights: the caller provides them, so
+	that they can be reused from one call to the next. The lines of each filter pass
+	are split into bands, which are filtered on up to 'threads' threads.
+
+	The source image must not be palletized, except for 8-bit greyscale images with
+	a linear palette, and dst must not be wider than src.
+
+	@param src Source image
+	@param dst Destination image
+	@param tmp Image of dst width and src height for the result of the horizontal pass,
+	only used if both the width and the height change
+	@param xWeights Weights from src width to dst width, NULL if the widths are equal
+	@param yWeights Weights from src height to dst height, NULL if the heights are equal
+	@param threads Maximum number of threads, including the calling thread
+	*/
+	void scale(FIBITMAP *src, FIBITMAP *dst, FIBITMAP *tmp, CWeightsTable *xWeights, CWeightsTable *yWeights, unsigned threads);
+
 private:
 
 	/**
-	Performs horizontal image filtering
+	Scales a 24- or 32-bit image, or an 8-bit greyscale image without palette, into a
+	destination image of the same bit depth, filtering its samples in linear light and / or
+	with colors premultiplied by alpha. The two passes keep 16 bits per sample in between.
+
+	@param src Source image
+	@param dst Destination image
+	@param src_offset_x
+	@param src_offset_y
+	@param src_width Width of the source rectangle to be scaled
+	@param src_height Height of the source rectangle to be scaled
+	@param linear Whether the samples are sRGB values to filter in linear light (FI_RESCALE_LINEAR)
+	@param premultiply Whether to premultiply the colors of a 32-bit image by alpha (FI_RESCALE_PREMULTIPLY)
+	@return Returns FALSE if the temporary image could not be allocated, TRUE otherwise
+	*/
+	FIBOOL scaleLinear(FIBITMAP *src, FIBITMAP *dst, unsigned src_offset_x, unsigned src_offset_y,
+			unsigned src_width, unsigned src_height, FIBOOL linear, FIBOOL premultiply);
+
+	/**
+	Performs horizontal image filtering, in bands of rows on up to m_Threads threads
 
 	@param src Source image
 	@param height Source / Destination image height
@@ -178,7 +263,25 @@ private:
 			FIBITMAP * const dst, const unsigned dst_width);
 
 	/**
-	Performs vertical image filtering
+	Performs horizontal image filtering of a band of rows with precomputed weights
+
+	@param weightsTable Weights from src_width to dst_width
+	@param src Source image
+	@param first_row First row of the band
+	@param last_row Row after the last row of the band
+	@param src_width Source image width
+	@param src_offset_x
+	@param src_offset_y
+	@param src_pal
+	@param dst Destination image
+	@param dst_width Destination image width
+	*/
+	void horizontalFilter(CWeightsTable &weightsTable, FIBITMAP * const src, const unsigned first_row, const unsigned last_row,
+			const unsigned src_width, const unsigned src_offset_x, const unsigned src_offset_y, const FIRGBA8 * const src_pal,
+			FIBITMAP * const dst, const unsigned dst_width);
+
+	/**
+	Performs vertical image filtering, in bands of columns on up to m_Threads threads
 	@param src Source image
 	@param width Source / Destination image width
 	@param src_height Source image height
@@ -191,6 +294,24 @@ private:
 	void verticalFilter(FIBITMAP * const src, const unsigned width, const unsigned src_height,
 			const unsigned src_offset_x, const unsigned src_offset_y, const FIRGBA8 * const src_pal,
 			FIBITMAP * const dst, const unsigned dst_height);
+
+	/**
+	Performs vertical image filtering of a band of columns with precomputed weights
+
+	@param weightsTable Weights from the source height to dst_height
+	@param src Source image
+	@param width Source / Destination image width
+	@param first_col First column of the band
+	@param last_col Column after the last column of the band
+	@param src_offset_x
+	@param src_offset_y
+	@param src_pal
+	@param dst Destination image
+	@param dst_height Destination image height
+	*/
+	void verticalFilter(CWeightsTable &weightsTable, FIBITMAP * const src, const unsigned width, const unsigned first_col, const unsigned last_col,
+			const unsigned src_offset_x, const unsigned src_offset_y, const FIRGBA8 * const src_pal,
+			FIBITMAP * const dst, const unsigned dst_height);
 };
 
 #endif //   _RESIZE_H_
@@ -0,0 +1,419 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "ResizeSIMD.h"
+
+#if !defined(FREEIMAGE_NO_SIMD)
+#  if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || (defined(_M_IX86) && !defined(_M_ARM64EC))
+#    define FI_RESIZE_X86
+#    include <immintrin.h>
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define FI_RESIZE_NEON
+#    include <arm_neon.h>
+#  endif
+#endif
+
+/// 2.14 fixed point rounding
+#define FI_FIXED_ROUND (1 << 13)
+
+// ----------------------------------------------------------
+//  scalar fixed point versions, for the ends of the lines
+// ----------------------------------------------------------
+
+#if defined(FI_RESIZE_X86) || defined(FI_RESIZE_NEON)
+
+static inline uint8_t
+FixedToByte(int value) {
+	return (uint8_t)CLAMP<int>((value + FI_FIXED_ROUND) >> 14, 0, 0xFF);
+}
+
+static void
+Vertical8Tail(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned first, unsigned count) {
+	for (unsigned j = first; j < count; j++) {
+		int value = 0;
+		for (unsigned k = 0; k < taps; k++) {
+			value += weights[k] * rows[k][j];
+		}
+		dst[j] = FixedToByte(value);
+	}
+}
+
+static void
+VerticalFTail(const float *const *rows, const float *weights, unsigned taps, float *dst, unsigned first, unsigned count) {
+	for (unsigned j = first; j < count; j++) {
+		float value = 0;
+		for (unsigned k = 0; k < taps; k++) {
+			value += weights[k] * rows[k][j];
+		}
+		dst[j] = value;
+	}
+}
+
+#endif
+
+#ifdef FI_RESIZE_X86
+
+// ----------------------------------------------------------
+//  SSE4.1
+// ----------------------------------------------------------
+
+/// A pair of 16-bit weights, for _mm_madd_epi16
+static inline int
+WeightPair(int16_t w0, int16_t w1) {
+	return (int)((uint32_t)(uint16_t)w0 | ((uint32_t)(uint16_t)w1 << 16));
+}
+
+FI_TARGET("sse4.1") static void
+Horizontal8_SSE41(const uint8_t *src, unsigned src_bytes, uint8_t *dst, unsigned dst_width, unsigned bytespp, const LineWeights &weights) {
+	// two pixels to channel pairs (c0 of both, c1 of both, ...) of 16-bit values
+	const __m128i pairs = (bytespp == 4) ?
+		_mm_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1) :
+		_mm_setr_epi8(0, -1, 3, -1, 1, -1, 4, -1, 2, -1, 5, -1, -1, -1, -1, -1);
+	const __m128i round = _mm_set1_epi32(FI_FIXED_ROUND);
+
+	for (unsigned x = 0; x < dst_width; x++) {
+		const uint8_t *pixel = src + weights.left[x] * bytespp;
+		const int16_t *w = weights.fixed + x * weights.stride;
+		const unsigned count = weights.count[x];
+		__m128i sum = round;
+		unsigned i = 0;
+
+		for (; i + 2 <= count; i += 2) {
+			__m128i p;
+			if (bytespp == 4) {
+				p = _mm_loadl_epi64((const __m128i *)pixel);
+			} else if ((unsigned)(pixel - src) + 8 <= src_bytes) {
+				p = _mm_loadl_epi64((const __m128i *)pixel);
+			} else {
+				uint64_t bits = 0;
+				memcpy(&bits, pixel, 6);
+				p = _mm_loadl_epi64((const __m128i *)&bits);
+			}
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_shuffle_epi8(p, pairs), _mm_set1_epi32(WeightPair(w[i], w[i + 1]))));
+			pixel += 2 * bytespp;
+		}
+		if (i < count) {
+			int bits = 0;
+			memcpy(&bits, pixel, bytespp);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_shuffle_epi8(_mm_cvtsi32_si128(bits), pairs), _mm_set1_epi32(WeightPair(w[i], 0))));
+		}
+
+		sum = _mm_srai_epi32(sum, 14);
+		sum = _mm_packs_epi32(sum, sum);
+		const int result = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+		memcpy(dst, &result, bytespp);
+		dst += bytespp;
+	}
+}
+
+FI_TARGET("sse4.1") static void
+HorizontalF_SSE41(const float *src, unsigned src_floats, float *dst, unsigned dst_width, unsigned floatspp, const LineWeights &weights) {
+	for (unsigned x = 0; x < dst_width; x++) {
+		const float *pixel = src + weights.left[x] * floatspp;
+		const float *w = weights.real + x * weights.stride;
+		const unsigned count = weights.count[x];
+		__m128 sum = _mm_setzero_ps();
+
+		for (unsigned i = 0; i < count; i++) {
+			__m128 p;
+			if (floatspp == 4 || (unsigned)(pixel - src) + 4 <= src_floats) {
+				p = _mm_loadu_ps(pixel);
+			} else {
+				float rgb[4] = { pixel[0], pixel[1], pixel[2], 0 };
+				p = _mm_loadu_ps(rgb);
+			}
+			sum = _mm_add_ps(sum, _mm_mul_ps(p, _mm_set1_ps(w[i])));
+			pixel += floatspp;
+		}
+
+		if (floatspp == 4) {
+			_mm_storeu_ps(dst, sum);
+		} else {
+			float rgb[4];
+			_mm_storeu_ps(rgb, sum);
+			memcpy(dst, rgb, 3 * sizeof(float));
+		}
+		dst += floatspp;
+	}
+}
+
+FI_TARGET("sse4.1") static void
+Vertical8Range_SSE41(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned first, unsigned count) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(FI_FIXED_ROUND);
+	unsigned j = first;
+
+	for (; j + 16 <= count; j += 16) {
+		__m128i s0 = round, s1 = round, s2 = round, s3 = round;
+		for (unsigned k = 0; k < taps; k += 2) {
+			// rows k and k + 1 interleaved, so that _mm_madd_epi16 applies both weights at once
+			const bool odd = (k + 1 == taps);
+			const __m128i w = _mm_set1_epi32(WeightPair(weights[k], odd ? 0 : weights[k + 1]));
+			const __m128i p = _mm_loadu_si128((const __m128i *)(rows[k] + j));
+			const __m128i q = odd ? zero : _mm_loadu_si128((const __m128i *)(rows[k + 1] + j));
+			const __m128i lo = _mm_unpacklo_epi8(p, q);
+			const __m128i hi = _mm_unpackhi_epi8(p, q);
+			s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+			s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+			s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+			s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+		}
+		const __m128i a = _mm_packs_epi32(_mm_srai_epi32(s0, 14), _mm_srai_epi32(s1, 14));
+		const __m128i b = _mm_packs_epi32(_mm_srai_epi32(s2, 14), _mm_srai_epi32(s3, 14));
+		_mm_storeu_si128((__m128i *)(dst + j), _mm_packus_epi16(a, b));
+	}
+	Vertical8Tail(rows, weights, taps, dst, j, count);
+}
+
+FI_TARGET("sse4.1") static void
+Vertical8_SSE41(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned count) {
+	Vertical8Range_SSE41(rows, weights, taps, dst, 0, count);
+}
+
+FI_TARGET("sse4.1") static void
+VerticalF_SSE41(const float *const *rows, const float *weights, unsigned taps, float *dst, unsigned count) {
+	unsigned j = 0;
+
+	for (; j + 8 <= count; j += 8) {
+		__m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+		for (unsigned k = 0; k < taps; k++) {
+			const __m128 w = _mm_set1_ps(weights[k]);
+			s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(rows[k] + j), w));
+			s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(rows[k] + j + 4), w));
+		}
+		_mm_storeu_ps(dst + j, s0);
+		_mm_storeu_ps(dst + j + 4, s1);
+	}
+	VerticalFTail(rows, weights, taps, dst, j, count);
+}
+
+// ----------------------------------------------------------
+//  AVX2
+// ----------------------------------------------------------
+
+FI_TARGET("avx2") static void
+Horizontal8_AVX2(const uint8_t *src, unsigned src_bytes, uint8_t *dst, unsigned dst_width, unsigned bytespp, const LineWeights &weights) {
+	if (bytespp != 4) {
+		Horizontal8_SSE41(src, src_bytes, dst, dst_width, bytespp, weights);
+		return;
+	}
+
+	// 16-bit channels of two pixels per lane to channel pairs
+	const __m256i pairs = _mm256_setr_epi8(
+		0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+		0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+	const __m128i pairs1 = _mm_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1);
+
+	for (unsigned x = 0; x < dst_width; x++) {
+		const uint8_t *pixel = src + weights.left[x] * 4;
+		const int16_t *w = weights.fixed + x * weights.stride;
+		const unsigned count = weights.count[x];
+		__m256i sum4 = _mm256_setzero_si256();
+		unsigned i = 0;
+
+		for (; i + 4 <= count; i += 4) {
+			const __m256i p = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)pixel));
+			const __m256i wp = _mm256_setr_epi32(
+				WeightPair(w[i], w[i + 1]), WeightPair(w[i], w[i + 1]), WeightPair(w[i], w[i + 1]), WeightPair(w[i], w[i + 1]),
+				WeightPair(w[i + 2], w[i + 3]), WeightPair(w[i + 2], w[i + 3]), WeightPair(w[i + 2], w[i + 3]), WeightPair(w[i + 2], w[i + 3]));
+			sum4 = _mm256_add_epi32(sum4, _mm256_madd_epi16(_mm256_shuffle_epi8(p, pairs), wp));
+			pixel += 16;
+		}
+		__m128i sum = _mm_add_epi32(_mm_set1_epi32(FI_FIXED_ROUND),
+			_mm_add_epi32(_mm256_castsi256_si128(sum4), _mm256_extracti128_si256(sum4, 1)));
+		for (; i + 2 <= count; i += 2) {
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_shuffle_epi8(_mm_loadl_epi64((const __m128i *)pixel), pairs1), _mm_set1_epi32(WeightPair(w[i], w[i + 1]))));
+			pixel += 8;
+		}
+		if (i < count) {
+			int bits;
+			memcpy(&bits, pixel, 4);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_shuffle_epi8(_mm_cvtsi32_si128(bits), pairs1), _mm_set1_epi32(WeightPair(w[i], 0))));
+		}
+
+		sum = _mm_srai_epi32(sum, 14);
+		sum = _mm_packs_epi32(sum, sum);
+		const int result = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+		memcpy(dst, &result, 4);
+		dst += 4;
+	}
+}
+
+FI_TARGET("avx2") static void
+Vertical8_AVX2(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned count) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi32(FI_FIXED_ROUND);
+	unsigned j = 0;
+
+	// the unpacks and packs work within 128-bit lanes, which keeps the samples in order
+	for (; j + 32 <= count; j += 32) {
+		__m256i s0 = round, s1 = round, s2 = round, s3 = round;
+		for (unsigned k = 0; k < taps; k += 2) {
+			const bool odd = (k + 1 == taps);
+			const __m256i w = _mm256_set1_epi32(WeightPair(weights[k], odd ? 0 : weights[k + 1]));
+			const __m256i p = _mm256_loadu_si256((const __m256i *)(rows[k] + j));
+			const __m256i q = odd ? zero : _mm256_loadu_si256((const __m256i *)(rows[k + 1] + j));
+			const __m256i lo = _mm256_unpacklo_epi8(p, q);
+			const __m256i hi = _mm256_unpackhi_epi8(p, q);
+			s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+			s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+			s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+			s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+		}
+		const __m256i a = _mm256_packs_epi32(_mm256_srai_epi32(s0, 14), _mm256_srai_epi32(s1, 14));
+		const __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(s2, 14), _mm256_srai_epi32(s3, 14));
+		_mm256_storeu_si256((__m256i *)(dst + j), _mm256_packus_epi16(a, b));
+	}
+	Vertical8Range_SSE41(rows, weights, taps, dst, j, count);
+}
+
+FI_TARGET("avx2") static void
+VerticalF_AVX2(const float *const *rows, const float *weights, unsigned taps, float *dst, unsigned count) {
+	unsigned j = 0;
+
+	for (; j + 16 <= count; j += 16) {
+		__m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+		for (unsigned k = 0; k < taps; k++) {
+			const __m256 w = _mm256_set1_ps(weights[k]);
+			s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + j), w));
+			s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + j + 8), w));
+		}
+		_mm256_storeu_ps(dst + j, s0);
+		_mm256_storeu_ps(dst + j + 8, s1);
+	}
+	VerticalFTail(rows, weights, taps, dst, j, count);
+}
+
+static const ResizeKernels *
+SelectResizeKernels() {
+	static const ResizeKernels avx2 = { Horizontal8_AVX2, HorizontalF_SSE41, Vertical8_AVX2, VerticalF_AVX2 };
+	static const ResizeKernels sse41 = { Horizontal8_SSE41, HorizontalF_SSE41, Vertical8_SSE41, VerticalF_SSE41 };
+
+	const unsigned features = FreeImage_GetCPUFeatures();
+	if (features & FI_CPU_AVX2) {
+		return &avx2;
+	}
+	if (features & FI_CPU_SSE41) {
+		return &sse41;
+	}
+	return NULL;
+}
+
+#elif defined(FI_RESIZE_NEON)
+
+// ----------------------------------------------------------
+//  NEON
+// ----------------------------------------------------------
+
+static void
+Horizontal8_NEON(const uint8_t *src, unsigned src_bytes, uint8_t *dst, unsigned dst_width, unsigned bytespp, const LineWeights &weights) {
+	(void)src_bytes;
+	for (unsigned x = 0; x < dst_width; x++) {
+		const uint8_t *pixel = src + weights.left[x] * bytespp;
+		const int16_t *w = weights.fixed + x * weights.stride;
+		const unsigned count = weights.count[x];
+		int32x4_t sum = vdupq_n_s32(FI_FIXED_ROUND);
+
+		for (unsigned i = 0; i < count; i++) {
+			uint32_t bits = 0;
+			memcpy(&bits, pixel, bytespp);
+			const int16x4_t p = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vcreate_u8(bits))));
+			sum = vmlal_n_s16(sum, p, w[i]);
+			pixel += bytespp;
+		}
+
+		const uint8x8_t result = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(sum, 14)), vdup_n_s16(0)));
+		uint32_t bits = vget_lane_u32(vreinterpret_u32_u8(result), 0);
+		memcpy(dst, &bits, bytespp);
+		dst += bytespp;
+	}
+}
+
+static void
+HorizontalF_NEON(const float *src, unsigned src_floats, float *dst, unsigned dst_width, unsigned floatspp, const LineWeights &weights) {
+	for (unsigned x = 0; x < dst_width; x++) {
+		const float *pixel = src + weights.left[x] * floatspp;
+		const float *w = weights.real + x * weights.stride;
+		const unsigned count = weights.count[x];
+		float32x4_t sum = vdupq_n_f32(0);
+
+		for (unsigned i = 0; i < count; i++) {
+			float32x4_t p;
+			if (floatspp == 4 || (unsigned)(pixel - src) + 4 <= src_floats) {
+				p = vld1q_f32(pixel);
+			} else {
+				const float rgb[4] = { pixel[0], pixel[1], pixel[2], 0 };
+				p = vld1q_f32(rgb);
+			}
+			sum = vmlaq_n_f32(sum, p, w[i]);
+			pixel += floatspp;
+		}
+
+		float result[4];
+		vst1q_f32(result, sum);
+		memcpy(dst, result, floatspp * sizeof(float));
+		dst += floatspp;
+	}
+}
+
+static void
+Vertical8_NEON(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned count) {
+	unsigned j = 0;
+
+	for (; j + 16 <= count; j += 16) {
+		int32x4_t s0 = vdupq_n_s32(FI_FIXED_ROUND), s1 = s0, s2 = s0, s3 = s0;
+		for (unsigned k = 0; k < taps; k++) {
+			const uint8x16_t p = vld1q_u8(rows[k] + j);
+			const int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(p)));
+			const int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(p)));
+			s0 = vmlal_n_s16(s0, vget_low_s16(lo), weights[k]);
+			s1 = vmlal_n_s16(s1, vget_high_s16(lo), weights[k]);
+			s2 = vmlal_n_s16(s2, vget_low_s16(hi), weights[k]);
+			s3 = vmlal_n_s16(s3, vget_high_s16(hi), weights[k]);
+		}
+		const int16x8_t a = vcombine_s16(vqmovn_s32(vshrq_n_s32(s0, 14)), vqmovn_s32(vshrq_n_s32(s1, 14)));
+		const int16x8_t b = vcombine_s16(vqmovn_s32(vshrq_n_s32(s2, 14)), vqmovn_s32(vshrq_n_s32(s3, 14)));
+		vst1q_u8(dst + j, vcombine_u8(vqmovun_s16(a), vqmovun_s16(b)));
+	}
+	Vertical8Tail(rows, weights, taps, dst, j, count);
+}
+
+static void
+VerticalF_NEON(const float *const *rows, const float *weights, unsigned taps, float *dst, unsigned count) {
+	unsigned j = 0;
+
+	for (; j + 8 <= count; j += 8) {
+		float32x4_t s0 = vdupq_n_f32(0), s1 = s0;
+		for (unsigned k = 0; k < taps; k++) {
+			s0 = vmlaq_n_f32(s0, vld1q_f32(rows[k] + j), weights[k]);
+			s1 = vmlaq_n_f32(s1, vld1q_f32(rows[k] + j + 4), weights[k]);
+		}
+		vst1q_f32(dst + j, s0);
+		vst1q_f32(dst + j + 4, s1);
+	}
+	VerticalFTail(rows, weights, taps, dst, j, count);
+}
+
+static const ResizeKernels *
+SelectResizeKernels() {
+	static const ResizeKernels neon = { Horizontal8_NEON, HorizontalF_NEON, Vertical8_NEON, VerticalF_NEON };
+	return (FreeImage_GetCPUFeatures() & FI_CPU_NEON) ? &neon : NULL;
+}
+
+#else
+
+static const ResizeKernels *
+SelectResizeKernels() {
+	return NULL;
+}
+
+#endif
+
+const ResizeKernels*
+GetResizeKernels() {
+	static const ResizeKernels * const kernels = SelectResizeKernels();
+	return kernels;
+}
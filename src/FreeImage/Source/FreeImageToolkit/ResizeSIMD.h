@@ -0,0 +1,70 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef _RESIZESIMD_H_
+#define _RESIZESIMD_H_
+
+#include "Resize.h"
+
+/**
+ Vectorized line kernels of CResizeEngine.<br>
+ They cover the common cases of 8-bit RGB(A) images, filtered in 2.14 fixed point, and of
+ float images, filtered in single precision. Their results may differ from the double
+ precision filters of CResizeEngine by one level for 8-bit images, and by float rounding
+ for float images. Members are NULL if the CPU has no vector unit they were written for.
+*/
+typedef struct tagResizeKernels {
+	/**
+	Filters a row of 8-bit pixels horizontally
+	@param src First source pixel
+	@param src_bytes Number of bytes that may be read at src
+	@param dst First destination pixel
+	@param dst_width Number of destination pixels
+	@param bytespp Bytes per pixel, 3 or 4
+	@param weights Weights from the source width to dst_width
+	*/
+	void (*horizontal8)(const uint8_t *src, unsigned src_bytes, uint8_t *dst, unsigned dst_width, unsigned bytespp, const LineWeights &weights);
+
+	/**
+	Filters a row of float pixels horizontally
+	@param src First source pixel
+	@param src_floats Number of floats that may be read at src
+	@param dst First destination pixel
+	@param dst_width Number of destination pixels
+	@param floatspp Floats per pixel, 3 or 4
+	@param weights Weights from the source width to dst_width
+	*/
+	void (*horizontalF)(const float *src, unsigned src_floats, float *dst, unsigned dst_width, unsigned floatspp, const LineWeights &weights);
+
+	/**
+	Computes a destination row of 8-bit samples from taps source rows, sample by sample
+	@param rows Source rows, at the first sample to filter
+	@param weights 2.14 fixed point weight of each row
+	@param taps Number of rows
+	@param dst First destination sample
+	@param count Number of samples (bytes)
+	*/
+	void (*vertical8)(const uint8_t *const *rows, const int16_t *weights, unsigned taps, uint8_t *dst, unsigned count);
+
+	/**
+	Computes a destination row of float samples from taps source rows, sample by sample
+	@param rows Source rows, at the first sample to filter
+	@param weights Weight of each row
+	@param taps Number of rows
+	@param dst First destination sample
+	@param count Number of samples (floats)
+	*/
+	void (*verticalF)(const float *const *rows, const float *weights, unsigned taps, float *dst, unsigned count);
+} ResizeKernels;
+
+/**
+Returns the kernels for the CPU the library runs on (AVX2, SSE4.1 or NEON), selected
+on the first call. Define FREEIMAGE_NO_SIMD to build without them.
+@return Returns the kernels, or NULL if there are none
+*/
+const ResizeKernels* GetResizeKernels();
+
+#endif // _RESIZESIMD_H_
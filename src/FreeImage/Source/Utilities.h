@@ -66,6 +66,28 @@ void FreeImage_Aligned_Free(void* mem);
 
 
 
+// ==========================================================
+//   Vectorized code paths
+// ==========================================================
+
+// CPU features used by the vectorized code paths
+#define FI_CPU_SSSE3	0x01
+#define FI_CPU_SSE41	0x02
+#define FI_CPU_AVX2		0x04
+#define FI_CPU_NEON		0x08
+
+// Features of the CPU the library runs on, none if built with FREEIMAGE_NO_SIMD
+// defined in ConversionSIMD.cpp
+unsigned FreeImage_GetCPUFeatures();
+
+// GCC and clang compile functions for a given instruction set with FI_TARGET,
+// the rest of the library keeps the baseline of the build
+#if defined(__GNUC__) || defined(__clang__)
+#define FI_TARGET(x) __attribute__((target(x)))
+#else
+#define FI_TARGET(x)
+#endif
+
 // ==========================================================
 //   File I/O structs
 // ==========================================================
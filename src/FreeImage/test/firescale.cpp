@@ -0,0 +1,447 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+/*
+ firescale checks the vectorized kernels of CResizeEngine (see ResizeSIMD.h) against
+ the double precision filters, which are all a library built with FREEIMAGE_NO_SIMD has.
+ 8-bit greyscale, 24-bit, 32-bit, RGBF and RGBAF images are rescaled with every
+ FREE_IMAGE_FILTER to a few sizes, from the whole image and from a rectangle, once with
+ the kernels and once without. The results may differ by one level per filter pass for
+ 8-bit samples and by about 2e-6 relative to the sample for float samples.
+
+ On a CPU without kernels both runs take the same path, and the check is trivial.
+
+ It also rescales images of a single color with FI_RESCALE_LINEAR and / or
+ FI_RESCALE_PREMULTIPLY, which must come back unchanged: the weights of each pixel sum
+ to one, so this checks the round trip through the linear light tables and through
+ premultiplied alpha, for 8-bit greyscale, 24-bit and 32-bit images and for palletized
+ ones, which are filtered in 24 or 32 bits.
+
+ Finally, it generates mipmap chains on one thread and on several, through
+ FreeImage_SetRescaleThreads and FI_MIPMAP_MULTITHREADED, which must give the same bits.
+
+ firescale prints the first differences it finds and exits with 1 if there are any.
+*/
+
+#include "Resize.h"
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/// Largest difference of float samples, relative to the sample and at least to 1
+#define FIRESCALE_FLOAT_TOLERANCE 2e-6
+
+static unsigned s_seed = 1;
+
+static unsigned
+Random() {
+	s_seed = s_seed * 1103515245 + 12345;
+	return s_seed >> 8;
+}
+
+/**
+Allocates an image of smooth gradients with noise, which gives the filters both flat areas
+and edges. Float samples range from 0 to 4, like a HDR image.
+*/
+static FIBITMAP *
+CreateImage(FREE_IMAGE_TYPE type, unsigned bpp, unsigned width, unsigned height) {
+	FIBITMAP *dib = FreeImage_AllocateT(type, width, height, bpp);
+	if (!dib) {
+		return NULL;
+	}
+	if (bpp == 8) {
+		FIRGBA8 *pal = FreeImage_GetPalette(dib);
+		for (unsigned i = 0; i < 256; i++) {
+			pal[i].red = pal[i].green = pal[i].blue = (uint8_t)i;
+		}
+	}
+	const unsigned line = FreeImage_GetLine(dib);
+	for (unsigned y = 0; y < height; y++) {
+		uint8_t *bits = FreeImage_GetScanLine(dib, y);
+		if (type == FIT_BITMAP) {
+			for (unsigned i = 0; i < line; i++) {
+				bits[i] = (Random() & 3) ? (uint8_t)(y * 5 + i * 3) : (uint8_t)Random();
+			}
+		} else {
+			float *samples = (float *)bits;
+			for (unsigned i = 0; i < line / sizeof(float); i++) {
+				samples[i] = (Random() & 3) ? (float)((y * 5 + i * 3) % 256) / 64 : (float)(Random() % 4096) / 1024;
+			}
+		}
+	}
+	return dib;
+}
+
+/**
+Compares the images rescaled with and without the kernels.
+@param passes Number of filter passes in which the kernels may have been used
+@return Returns the number of samples out of tolerance
+*/
+static unsigned
+Compare(FIBITMAP *simd, FIBITMAP *scalar, unsigned passes, double *worst) {
+	const unsigned width = FreeImage_GetWidth(scalar);
+	const unsigned height = FreeImage_GetHeight(scalar);
+	const unsigned line = FreeImage_GetLine(scalar);
+	if (FreeImage_GetWidth(simd) != width || FreeImage_GetHeight(simd) != height || FreeImage_GetLine(simd) != line) {
+		return 1;
+	}
+
+	unsigned errors = 0;
+	for (unsigned y = 0; y < height; y++) {
+		const uint8_t *a = FreeImage_GetScanLine(simd, y);
+		const uint8_t *b = FreeImage_GetScanLine(scalar, y);
+		if (FreeImage_GetImageType(scalar) == FIT_BITMAP) {
+			for (unsigned i = 0; i < line; i++) {
+				const unsigned diff = (unsigned)abs((int)a[i] - (int)b[i]);
+				*worst = MAX(*worst, (double)diff);
+				if (diff > passes) {
+					errors++;
+				}
+			}
+		} else {
+			for (unsigned i = 0; i < line / sizeof(float); i++) {
+				const double fa = ((const float *)a)[i];
+				const double fb = ((const float *)b)[i];
+				const double diff = fabs(fa - fb) / MAX(fabs(fb), 1.0);
+				*worst = MAX(*worst, diff);
+				if (!(diff <= FIRESCALE_FLOAT_TOLERANCE)) {
+					errors++;
+				}
+			}
+		}
+	}
+	return errors;
+}
+
+/// Creates the CGenericFilter of a FREE_IMAGE_FILTER, as FreeImage_RescaleRect does
+static CGenericFilter *
+CreateFilter(FREE_IMAGE_FILTER filter) {
+	switch (filter) {
+		case FILTER_BOX:
+			return new CBoxFilter();
+		case FILTER_BICUBIC:
+			return new CBicubicFilter();
+		case FILTER_BILINEAR:
+			return new CBilinearFilter();
+		case FILTER_BSPLINE:
+			return new CBSplineFilter();
+		case FILTER_CATMULLROM:
+			return new CCatmullRomFilter();
+		case FILTER_LANCZOS3:
+			return new CLanczos3Filter();
+		case FILTER_KAISER:
+			return new CKaiserFilter();
+	}
+	return NULL;
+}
+
+/**
+Allocates an image of a single color.
+@param bpp 8 for a greyscale image of color.red, 24 or 32, or 0 for an 8-bit image with
+a palette of colors, transparent if color.alpha is not 255
+*/
+static FIBITMAP *
+CreateConstantImage(unsigned bpp, unsigned width, unsigned height, FIRGBA8 color) {
+	FIBITMAP *dib = FreeImage_Allocate(width, height, bpp ? bpp : 8);
+	if (!dib) {
+		return NULL;
+	}
+	uint8_t sample[4];
+	if (bpp == 0) {
+		// a palette of other colors around the one used
+		FIRGBA8 *pal = FreeImage_GetPalette(dib);
+		uint8_t table[256];
+		for (unsigned i = 0; i < 256; i++) {
+			pal[i].red = (uint8_t)(i * 3);
+			pal[i].green = (uint8_t)(255 - i);
+			pal[i].blue = (uint8_t)(i * 7);
+			table[i] = 0xFF;
+		}
+		pal[77] = color;
+		table[77] = color.alpha;
+		if (color.alpha != 0xFF) {
+			FreeImage_SetTransparencyTable(dib, table, 256);
+		}
+		sample[0] = 77;
+	} else if (bpp == 8) {
+		sample[0] = color.red;
+	} else {
+		sample[FI_RGBA_RED] = color.red;
+		sample[FI_RGBA_GREEN] = color.green;
+		sample[FI_RGBA_BLUE] = color.blue;
+		sample[FI_RGBA_ALPHA] = color.alpha;
+	}
+	const unsigned bytespp = MAX(bpp / 8, 1U);
+	for (unsigned y = 0; y < height; y++) {
+		uint8_t *bits = FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < width; x++) {
+			memcpy(bits + x * bytespp, sample, bytespp);
+		}
+	}
+	return dib;
+}
+
+/**
+Checks that images of a single color come back unchanged from FI_RESCALE_LINEAR and / or
+FI_RESCALE_PREMULTIPLY, for every filter and every value of the samples.
+@return Returns the number of images that changed
+*/
+static unsigned
+CheckConstantImages() {
+	static const struct {
+		const char *name;
+		unsigned bpp;
+		unsigned flags;
+		uint8_t alpha;
+	} cases[] = {
+		{ "8-bit linear", 8, FI_RESCALE_LINEAR, 0xFF },
+		{ "24-bit linear", 24, FI_RESCALE_LINEAR, 0xFF },
+		{ "32-bit linear", 32, FI_RESCALE_LINEAR, 0x80 },
+		{ "32-bit premultiplied", 32, FI_RESCALE_PREMULTIPLY, 0x80 },
+		{ "32-bit premultiplied", 32, FI_RESCALE_PREMULTIPLY, 0x01 },
+		{ "32-bit linear premultiplied", 32, FI_RESCALE_LINEAR | FI_RESCALE_PREMULTIPLY, 0xFF },
+		{ "32-bit linear premultiplied", 32, FI_RESCALE_LINEAR | FI_RESCALE_PREMULTIPLY, 0x80 },
+		{ "palletized linear", 0, FI_RESCALE_LINEAR, 0xFF },
+		{ "palletized linear premultiplied", 0, FI_RESCALE_LINEAR | FI_RESCALE_PREMULTIPLY, 0x80 }
+	};
+	// source width and height, destination width and height
+	static const unsigned sizes[][4] = {
+		{ 13, 11, 5, 4 },
+		{ 13, 11, 29, 17 }
+	};
+
+	unsigned errors = 0;
+	for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		unsigned case_errors = 0;
+		for (unsigned value = 0; value < 256; value++) {
+			FIRGBA8 color;
+			color.red = (uint8_t)value;
+			color.green = (uint8_t)(255 - value);
+			color.blue = (uint8_t)(value * 5);
+			color.alpha = cases[c].alpha;
+			for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+				FIBITMAP *src = CreateConstantImage(cases[c].bpp, sizes[s][0], sizes[s][1], color);
+				if (!src) {
+					fprintf(stderr, "firescale: out of memory\n");
+					return errors + 1;
+				}
+				for (int filter = FILTER_BOX; filter <= FILTER_KAISER; filter++) {
+					FIBITMAP *dst = FreeImage_RescaleRect(src, sizes[s][2], sizes[s][3], 0, 0, sizes[s][0], sizes[s][1], (FREE_IMAGE_FILTER)filter, cases[c].flags);
+					unsigned changed = dst ? 0 : 1;
+					const unsigned bpp = dst ? FreeImage_GetBPP(dst) : 0;
+					for (unsigned y = 0; dst && y < FreeImage_GetHeight(dst); y++) {
+						const uint8_t *bits = FreeImage_GetScanLine(dst, y);
+						for (unsigned x = 0; x < FreeImage_GetWidth(dst); x++) {
+							if (bpp == 8) {
+								changed += (bits[x] != color.red);
+							} else {
+								const uint8_t *pixel = bits + x * (bpp / 8);
+								changed += (pixel[FI_RGBA_RED] != color.red) || (pixel[FI_RGBA_GREEN] != color.green) || (pixel[FI_RGBA_BLUE] != color.blue)
+									|| (bpp == 32 && pixel[FI_RGBA_ALPHA] != color.alpha);
+							}
+						}
+					}
+					if (changed && case_errors++ < 4) {
+						fprintf(stderr, "firescale: %s, color %u %u %u %u, %ux%u to %ux%u, filter %d: %u pixels changed\n",
+							cases[c].name, color.red, color.green, color.blue, color.alpha, sizes[s][0], sizes[s][1], sizes[s][2], sizes[s][3], filter, changed);
+					}
+					FreeImage_Unload(dst);
+				}
+				FreeImage_Unload(src);
+			}
+		}
+		printf("%-32s %s\n", cases[c].name, case_errors ? "FAILED" : "ok");
+		errors += case_errors;
+	}
+	return errors;
+}
+
+/**
+Checks that palletized images are filtered with FI_RESCALE_LINEAR like the 24-bit images
+they convert to, and not in their own bit depth.
+@return Returns the number of images that differ
+*/
+static unsigned
+CheckPalletizedImages() {
+	unsigned errors = 0;
+	for (int filter = FILTER_BOX; filter <= FILTER_KAISER; filter++) {
+		FIBITMAP *src = CreateImage(FIT_BITMAP, 8, 37, 23);
+		FIBITMAP *rgb = NULL;
+		if (src) {
+			FIRGBA8 *pal = FreeImage_GetPalette(src);
+			for (unsigned i = 0; i < 256; i++) {
+				pal[i].red = (uint8_t)(i * 3);
+				pal[i].green = (uint8_t)(255 - i);
+				pal[i].blue = (uint8_t)(i * 7);
+			}
+			rgb = FreeImage_ConvertTo24Bits(src);
+		}
+		FIBITMAP *a = FreeImage_RescaleRect(src, 17, 31, 2, 1, 35, 20, (FREE_IMAGE_FILTER)filter, FI_RESCALE_LINEAR);
+		FIBITMAP *b = FreeImage_RescaleRect(rgb, 17, 31, 2, 1, 35, 20, (FREE_IMAGE_FILTER)filter, FI_RESCALE_LINEAR);
+		double worst = 0;
+		if (!a || !b || FreeImage_GetBPP(a) != 24 || Compare(a, b, 0, &worst)) {
+			fprintf(stderr, "firescale: palletized linear, filter %d: differs from 24-bit\n", filter);
+			errors++;
+		}
+		FreeImage_Unload(a);
+		FreeImage_Unload(b);
+		FreeImage_Unload(rgb);
+		FreeImage_Unload(src);
+	}
+	printf("%-32s %s\n", "palletized as 24-bit linear", errors ? "FAILED" : "ok");
+	return errors;
+}
+
+/**
+Checks that FreeImage_GenerateMipmaps gives the same chain on one thread and on several:
+the bands of each filter pass must not depend on the number of threads.
+@return Returns the number of chains that differ
+*/
+static unsigned
+CheckMipmapThreads() {
+	static const struct {
+		const char *name;
+		FREE_IMAGE_TYPE type;
+		unsigned bpp;
+		unsigned flags;
+	} types[] = {
+		{ "8-bit mipmaps", FIT_BITMAP, 8, FI_MIPMAP_DEFAULT },
+		{ "24-bit mipmaps", FIT_BITMAP, 24, FI_MIPMAP_DEFAULT },
+		{ "32-bit mipmaps", FIT_BITMAP, 32, FI_MIPMAP_ALPHA_COVERAGE },
+		{ "RGBF mipmaps", FIT_RGBF, 96, FI_MIPMAP_DEFAULT },
+		{ "RGBAF mipmaps", FIT_RGBAF, 128, FI_MIPMAP_ALPHA_COVERAGE }
+	};
+	static const FREE_IMAGE_FILTER filters[] = { FILTER_BOX, FILTER_LANCZOS3 };
+
+	const unsigned saved_threads = FreeImage_GetRescaleThreads();
+	unsigned errors = 0;
+	for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		unsigned type_errors = 0;
+		// large enough for several threads on the first levels, odd sizes below
+		FIBITMAP *src = CreateImage(types[t].type, types[t].bpp, 611, 437);
+		for (unsigned f = 0; src && f < sizeof(filters) / sizeof(filters[0]); f++) {
+			FreeImage_SetRescaleThreads(1);
+			FIMIPMAPS *single = FreeImage_GenerateMipmaps(src, 0, filters[f], types[t].flags);
+			FIMIPMAPS *multiple[2];
+			FreeImage_SetRescaleThreads(5);
+			multiple[0] = FreeImage_GenerateMipmaps(src, 0, filters[f], types[t].flags);
+			FreeImage_SetRescaleThreads(1);
+			multiple[1] = FreeImage_GenerateMipmaps(src, 0, filters[f], types[t].flags | FI_MIPMAP_MULTITHREADED);
+
+			size_t size = 0;
+			const uint8_t *bits = FreeImage_GetMipmapBits(single, &size);
+			for (unsigned m = 0; m < 2; m++) {
+				size_t other_size = 0;
+				const uint8_t *other_bits = FreeImage_GetMipmapBits(multiple[m], &other_size);
+				if (!bits || !other_bits || size != other_size || memcmp(bits, other_bits, size) != 0) {
+					fprintf(stderr, "firescale: %s, filter %d: %s differ from one thread\n",
+						types[t].name, filters[f], m ? "FI_MIPMAP_MULTITHREADED" : "5 threads");
+					type_errors++;
+				}
+				FreeImage_UnloadMipmaps(multiple[m]);
+			}
+			FreeImage_UnloadMipmaps(single);
+		}
+		if (!src) {
+			type_errors++;
+		}
+		FreeImage_Unload(src);
+		printf("%-32s %s\n", types[t].name, type_errors ? "FAILED" : "ok");
+		errors += type_errors;
+	}
+	FreeImage_SetRescaleThreads(saved_threads);
+	return errors;
+}
+
+int
+main() {
+	static const struct {
+		const char *name;
+		FREE_IMAGE_TYPE type;
+		unsigned bpp;
+	} types[] = {
+		{ "8-bit", FIT_BITMAP, 8 },
+		{ "24-bit", FIT_BITMAP, 24 },
+		{ "32-bit", FIT_BITMAP, 32 },
+		{ "RGBF", FIT_RGBF, 96 },
+		{ "RGBAF", FIT_RGBAF, 128 }
+	};
+	// source width and height, destination width and height
+	static const unsigned sizes[][4] = {
+		{ 67, 53, 31, 29 },		// down
+		{ 67, 53, 130, 101 },	// up
+		{ 67, 53, 67, 20 },		// height only
+		{ 67, 53, 19, 53 },		// width only
+		{ 17, 9, 5, 40 },		// down and up
+		{ 300, 200, 7, 3 },		// wide windows
+		{ 64, 64, 64, 63 }
+	};
+
+	unsigned failed = 0;
+	for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		double worst = 0;
+		unsigned errors = 0;
+		for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+			const unsigned src_width = sizes[s][0], src_height = sizes[s][1];
+			const unsigned dst_width = sizes[s][2], dst_height = sizes[s][3];
+			FIBITMAP *src = CreateImage(types[t].type, types[t].bpp, src_width, src_height);
+			if (!src) {
+				fprintf(stderr, "firescale: out of memory\n");
+				return 1;
+			}
+
+			for (int filter = FILTER_BOX; filter <= FILTER_KAISER; filter++) {
+				for (int rect = 0; rect < 2; rect++) {
+					// the whole image, then without a border of 1 to 3 pixels
+					const unsigned left = rect ? 3 : 0, top = rect ? 1 : 0;
+					const unsigned width = src_width - (rect ? 5 : 0), height = src_height - (rect ? 3 : 0);
+
+					// the row kernels only take 24- and 32-bit images and float images
+					unsigned passes = (dst_height != height) ? 1 : 0;
+					if (dst_width != width && types[t].bpp != 8) {
+						passes++;
+					}
+
+					CGenericFilter *pFilter = CreateFilter((FREE_IMAGE_FILTER)filter);
+					CResizeEngine engine(pFilter);
+					FIBITMAP *simd = engine.scale(src, dst_width, dst_height, left, top, width, height, 0);
+					engine.setVectorized(FALSE);
+					FIBITMAP *scalar = engine.scale(src, dst_width, dst_height, left, top, width, height, 0);
+					delete pFilter;
+
+					if (!simd || !scalar) {
+						fprintf(stderr, "firescale: %s %ux%u to %ux%u, filter %d: no image\n",
+							types[t].name, width, height, dst_width, dst_height, filter);
+						errors++;
+					} else {
+						double image_worst = 0;
+						const unsigned image_errors = Compare(simd, scalar, passes, &image_worst);
+						if (image_errors) {
+							fprintf(stderr, "firescale: %s %ux%u to %ux%u, filter %d: %u samples differ, by up to %g\n",
+								types[t].name, width, height, dst_width, dst_height, filter, image_errors, image_worst);
+						}
+						errors += image_errors;
+						worst = MAX(worst, image_worst);
+					}
+					FreeImage_Unload(simd);
+					FreeImage_Unload(scalar);
+				}
+			}
+			FreeImage_Unload(src);
+		}
+		printf("%-8s %s, largest difference %g\n", types[t].name, errors ? "FAILED" : "ok", worst);
+		if (errors) {
+			failed = 1;
+		}
+	}
+
+	if (CheckConstantImages() + CheckPalletizedImages() + CheckMipmapThreads()) {
+		failed = 1;
+	}
+
+	return failed ? 1 : 0;
+}
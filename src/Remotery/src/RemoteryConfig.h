@@ -0,0 +1,6 @@
+
+#define RMT_USE_OPENGL 1
+#define RMT_USE_D3D11 0
+#define RMT_USE_METAL 0
+
+#define RMT_DLL
@@ -57,6 +57,190 @@
 #  define MOD63(a) a %= BASE
 #endif
 
+#ifdef Z_X86_SIMD
+#  include <immintrin.h>
+#endif
+#ifdef Z_ARM_SIMD
+#  include <arm_neon.h>
+#endif
+
+#if defined(Z_X86_SIMD) || defined(Z_ARM_SIMD)
+
+/*
+   The SIMD versions take 32-byte blocks, at most NMAX / 32 of them between
+   the modulos. For a run of n blocks, sum2 grows by 32 * n * adler (added
+   up front), by 32 times the running sum of the block sums (ps), and by the
+   bytes of each block weighted with 32..1 (the taps). The adler sum is the
+   plain sum of the bytes. Vector lanes are added up at the end of each run.
+   The split sums adler and sum2 are passed in and the combined checksum is
+   returned, as from adler32_z().
+ */
+#define BLOCK 32
+
+local uLong adler32_tail(unsigned long adler, unsigned long sum2,
+                         const Bytef *buf, z_size_t len) {
+    if (len) {
+        while (len >= 16) {
+            len -= 16;
+            DO16(buf);
+            buf += 16;
+        }
+        while (len--) {
+            adler += *buf++;
+            sum2 += adler;
+        }
+        MOD(adler);
+        MOD(sum2);
+    }
+    return adler | (sum2 << 16);
+}
+
+#endif
+
+#ifdef Z_X86_SIMD
+
+Z_TARGET("sse2")
+local unsigned long hsum128(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return (unsigned)_mm_cvtsi128_si32(v);
+}
+
+Z_TARGET("ssse3")
+local uLong adler32_ssse3(unsigned long adler, unsigned long sum2,
+                          const Bytef *buf, z_size_t len) {
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                       24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                       8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    z_size_t blocks = len / BLOCK;
+
+    len -= blocks * BLOCK;
+    while (blocks) {
+        __m128i v_ps = zero, v_s1 = zero, v_s2 = zero, bytes;
+        unsigned n = NMAX / BLOCK;
+        if (n > blocks)
+            n = (unsigned)blocks;
+        blocks -= n;
+        sum2 += adler * n * BLOCK;
+        do {
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            bytes = _mm_loadu_si128((const __m128i *)buf);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                                     _mm_maddubs_epi16(bytes, tap1), ones));
+            bytes = _mm_loadu_si128((const __m128i *)(buf + 16));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                                     _mm_maddubs_epi16(bytes, tap2), ones));
+            buf += BLOCK;
+        } while (--n);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+        adler += hsum128(v_s1);
+        sum2 += hsum128(v_s2);
+        MOD(adler);
+        MOD(sum2);
+    }
+    return adler32_tail(adler, sum2, buf, len);
+}
+
+Z_TARGET("avx2")
+local uLong adler32_avx2(unsigned long adler, unsigned long sum2,
+                         const Bytef *buf, z_size_t len) {
+    const __m256i tap = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                         24, 23, 22, 21, 20, 19, 18, 17,
+                                         16, 15, 14, 13, 12, 11, 10, 9,
+                                         8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    z_size_t blocks = len / BLOCK;
+
+    len -= blocks * BLOCK;
+    while (blocks) {
+        __m256i v_ps = zero, v_s1 = zero, v_s2 = zero, bytes;
+        unsigned n = NMAX / BLOCK;
+        if (n > blocks)
+            n = (unsigned)blocks;
+        blocks -= n;
+        sum2 += adler * n * BLOCK;
+        do {
+            v_ps = _mm256_add_epi32(v_ps, v_s1);
+            bytes = _mm256_loadu_si256((const __m256i *)buf);
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+            v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(
+                                        _mm256_maddubs_epi16(bytes, tap), ones));
+            buf += BLOCK;
+        } while (--n);
+        v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+        adler += hsum128(_mm_add_epi32(_mm256_castsi256_si128(v_s1),
+                                       _mm256_extracti128_si256(v_s1, 1)));
+        sum2 += hsum128(_mm_add_epi32(_mm256_castsi256_si128(v_s2),
+                                      _mm256_extracti128_si256(v_s2, 1)));
+        MOD(adler);
+        MOD(sum2);
+    }
+    return adler32_tail(adler, sum2, buf, len);
+}
+
+#endif
+
+#ifdef Z_ARM_SIMD
+
+/* Here the bytes of each column are summed in 16-bit lanes (at most
+   255 * NMAX / 32 fits) and weighted with the taps at the end of a run. */
+local uLong adler32_neon(unsigned long adler, unsigned long sum2,
+                         const Bytef *buf, z_size_t len) {
+    static const uint16_t taps[32] = {
+        32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+    };
+    z_size_t blocks = len / BLOCK;
+
+    len -= blocks * BLOCK;
+    while (blocks) {
+        uint32x4_t v_ps = vdupq_n_u32(0), v_s1 = vdupq_n_u32(0), v_s2;
+        uint16x8_t col1 = vdupq_n_u16(0), col2 = vdupq_n_u16(0);
+        uint16x8_t col3 = vdupq_n_u16(0), col4 = vdupq_n_u16(0);
+        uint32x2_t s1s2;
+        unsigned n = NMAX / BLOCK;
+        if (n > blocks)
+            n = (unsigned)blocks;
+        blocks -= n;
+        sum2 += adler * n * BLOCK;
+        do {
+            uint8x16_t bytes1 = vld1q_u8(buf);
+            uint8x16_t bytes2 = vld1q_u8(buf + 16);
+            v_ps = vaddq_u32(v_ps, v_s1);
+            v_s1 = vpadalq_u16(v_s1, vpadalq_u8(vpaddlq_u8(bytes1), bytes2));
+            col1 = vaddw_u8(col1, vget_low_u8(bytes1));
+            col2 = vaddw_u8(col2, vget_high_u8(bytes1));
+            col3 = vaddw_u8(col3, vget_low_u8(bytes2));
+            col4 = vaddw_u8(col4, vget_high_u8(bytes2));
+            buf += BLOCK;
+        } while (--n);
+        v_s2 = vshlq_n_u32(v_ps, 5);
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(col1), vld1_u16(taps));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(col1), vld1_u16(taps + 4));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(col2), vld1_u16(taps + 8));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(col2), vld1_u16(taps + 12));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(col3), vld1_u16(taps + 16));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(col3), vld1_u16(taps + 20));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(col4), vld1_u16(taps + 24));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(col4), vld1_u16(taps + 28));
+        s1s2 = vpadd_u32(vpadd_u32(vget_low_u32(v_s1), vget_high_u32(v_s1)),
+                         vpadd_u32(vget_low_u32(v_s2), vget_high_u32(v_s2)));
+        adler += vget_lane_u32(s1s2, 0);
+        sum2 += vget_lane_u32(s1s2, 1);
+        MOD(adler);
+        MOD(sum2);
+    }
+    return adler32_tail(adler, sum2, buf, len);
+}
+
+#endif
+
 /* ========================================================================= */
 uLong ZEXPORT adler32_z(uLong adler, const Bytef *buf, z_size_t len) {
     unsigned long sum2;
@@ -93,6 +277,21 @@ uLong ZEXPORT adler32_z(uLong adler, const Bytef *buf, z_size_t len) {
         return adler | (sum2 << 16);
     }
 
+    /* use the vector units for longer runs if there are any */
+#ifdef Z_X86_SIMD
+    if (len >= 64) {
+        int cpu = z_cpu_features();
+        if (cpu & Z_CPU_AVX2)
+            return adler32_avx2(adler, sum2, buf, len);
+        if (cpu & Z_CPU_SSSE3)
+            return adler32_ssse3(adler, sum2, buf, len);
+    }
+#endif
+#ifdef Z_ARM_SIMD
+    if (len >= 64)
+        return adler32_neon(adler, sum2, buf, len);
+#endif
+
     /* do length NMAX blocks -- requires just one modulo operation */
     while (len >= NMAX) {
         len -= NMAX;
@@ -103,6 +103,24 @@
 #  define ARMCRC32
 #endif
 
+/*
+  Otherwise use the hardware CRC paths that are selected at run time: the
+  ARMv8 CRC32 instructions on Linux, and carry-less multiplication (PCLMULQDQ)
+  on x86-64. Define NO_CRC32_SIMD (or NO_ZLIB_SIMD for all of zlib) to only
+  use the braided calculation.
+ */
+#ifndef NO_CRC32_SIMD
+#  if defined(Z_ARM_SIMD) && defined(__linux__) && defined(__GNUC__) && \
+      !defined(ARMCRC32) && W == 8
+#    define ARMCRC32_RUNTIME
+#    define Z_CRC32_ARM_TARGET __attribute__((target("+crc")))
+#  endif
+#  ifdef Z_X86_SIMD
+#    define PCLMULCRC32
+#    include <wmmintrin.h>
+#  endif
+#endif
+
 #if defined(W) && (!defined(ARMCRC32) || defined(DYNAMIC_CRC_TABLE))
 /*
   Swap the bytes in a z_word_t to convert between little and big endian. Any
@@ -562,7 +580,11 @@ const z_crc_t FAR * ZEXPORT get_crc_table(void) {
  * -march=armv8-a+crc, or -march=native if the compile machine has the crc32
  * instructions.
  */
-#ifdef ARMCRC32
+#if defined(ARMCRC32) || defined(ARMCRC32_RUNTIME)
+
+#ifndef Z_CRC32_ARM_TARGET
+#  define Z_CRC32_ARM_TARGET
+#endif
 
 /*
    Constants empirically determined to maximize speed. These values are from
@@ -572,8 +594,13 @@ const z_crc_t FAR * ZEXPORT get_crc_table(void) {
 #define Z_BATCH_ZEROS 0xa10d3d0c    /* computed from Z_BATCH = 3990 */
 #define Z_BATCH_MIN 800             /* fewest words in a final batch */
 
-unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
-                              z_size_t len) {
+/*
+  Return the CRC of buf[0..len-1] using the crc32 instructions, where crc is
+  already pre-conditioned and the result is not post-conditioned.
+ */
+Z_CRC32_ARM_TARGET
+local z_crc_t crc32_armv8(z_word_t crc, const unsigned char FAR *buf,
+                          z_size_t len) {
     z_crc_t val;
     z_word_t crc1, crc2;
     const z_word_t *word;
@@ -581,16 +608,6 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
     z_size_t last, last2, i;
     z_size_t num;
 
-    /* Return initial CRC, if requested. */
-    if (buf == Z_NULL) return 0;
-
-#ifdef DYNAMIC_CRC_TABLE
-    once(&made, make_crc_table);
-#endif /* DYNAMIC_CRC_TABLE */
-
-    /* Pre-condition the CRC */
-    crc = (~crc) & 0xffffffff;
-
     /* Compute the CRC up to a word boundary. */
     while (len && ((z_size_t)buf & 7) != 0) {
         len--;
@@ -659,13 +676,120 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
         val = *buf++;
         __asm__ volatile("crc32b %w0, %w0, %w1" : "+r"(crc) : "r"(val));
     }
+    return (z_crc_t)crc;
+}
 
-    /* Return the CRC, post-conditioned. */
-    return crc ^ 0xffffffff;
+#endif
+
+#ifdef ARMCRC32
+
+/* ========================================================================= */
+unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
+                              z_size_t len) {
+    /* Return initial CRC, if requested. */
+    if (buf == Z_NULL) return 0;
+
+#ifdef DYNAMIC_CRC_TABLE
+    once(&made, make_crc_table);
+#endif /* DYNAMIC_CRC_TABLE */
+
+    /* Pre-condition the CRC, then post-condition the result. */
+    return crc32_armv8((~crc) & 0xffffffff, buf, len) ^ 0xffffffff;
 }
 
 #else
 
+#ifdef PCLMULCRC32
+
+/*
+  Fold 64 bytes at a time with carry-less multiplication, then fold down to
+  128 bits and do a Barrett reduction to the 32-bit CRC, as described in
+  "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+  by Gopal et al. (Intel, 2009). The constants are the bit-reflected k1..k5,
+  P(x) and mu for the CRC-32 polynomial. len must be at least 64 and a
+  multiple of 16. crc is pre-conditioned and the result is not
+  post-conditioned.
+ */
+Z_TARGET("sse2,pclmul")
+local z_crc_t crc32_pclmul(z_crc_t crc, const unsigned char FAR *buf,
+                           z_size_t len) {
+    __m128i x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    len -= 64;
+
+    /* Fold four 128-bit lanes in parallel. */
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four lanes into one. */
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Fold in the remaining 16-byte blocks. */
+    while (len >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 bits to 64 bits. */
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return (z_crc_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif
+
 #ifdef W
 
 /*
@@ -690,19 +814,12 @@ local z_word_t crc_word_big(z_word_t data) {
 
 #endif
 
-/* ========================================================================= */
-unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
-                              z_size_t len) {
-    /* Return initial CRC, if requested. */
-    if (buf == Z_NULL) return 0;
-
-#ifdef DYNAMIC_CRC_TABLE
-    once(&made, make_crc_table);
-#endif /* DYNAMIC_CRC_TABLE */
-
-    /* Pre-condition the CRC */
-    crc = (~crc) & 0xffffffff;
-
+/*
+  Return the CRC of buf[0..len-1] using the tables, where crc is already
+  pre-conditioned and the result is not post-conditioned.
+ */
+local z_crc_t crc32_braid(z_crc_t crc, const unsigned char FAR *buf,
+                          z_size_t len) {
 #ifdef W
 
     /* If provided enough bytes, do a braided CRC calculation. */
@@ -1004,9 +1121,40 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
         len--;
         crc = (crc >> 8) ^ crc_table[(crc ^ *buf++) & 0xff];
     }
+    return crc;
+}
+
+/* ========================================================================= */
+unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
+                              z_size_t len) {
+    z_crc_t val;
+
+    /* Return initial CRC, if requested. */
+    if (buf == Z_NULL) return 0;
+
+#ifdef DYNAMIC_CRC_TABLE
+    once(&made, make_crc_table);
+#endif /* DYNAMIC_CRC_TABLE */
+
+    /* Pre-condition the CRC */
+    val = (z_crc_t)((~crc) & 0xffffffff);
+
+#ifdef ARMCRC32_RUNTIME
+    if (z_cpu_features() & Z_CPU_ARMCRC32)
+        return crc32_armv8(val, buf, len) ^ 0xffffffff;
+#endif
+#ifdef PCLMULCRC32
+    /* Fold the multiples of 16 bytes, the tables do the rest. */
+    if (len >= 64 && (z_cpu_features() & Z_CPU_PCLMUL)) {
+        val = crc32_pclmul(val, buf, len & ~(z_size_t)15);
+        buf += len & ~(z_size_t)15;
+        len &= 15;
+    }
+#endif
+    val = crc32_braid(val, buf, len);
 
     /* Return the CRC, post-conditioned. */
-    return crc ^ 0xffffffff;
+    return val ^ 0xffffffff;
 }
 
 #endif
@@ -140,6 +140,33 @@ local const config configuration_table[10] = {
  */
 #define UPDATE_HASH(s,h,c) (h = (((h) << s->hash_shift) ^ (c)) & s->hash_mask)
 
+/* ===========================================================================
+ * With DEFLATE_HASH4 the hash key is a multiplicative hash of the four bytes
+ * at str instead of the rolling hash of three. That gives much shorter hash
+ * chains on image data and the like, at the price of not finding matches of
+ * only three bytes. The compressed data is different from the default but
+ * the same on all machines. It needs the vector match compare below, which
+ * does not rely on equal hash keys for equal bytes, so it is not available
+ * with FASTEST. HASH_AT() sets s->ins_h to the hash key of the string at str.
+ */
+#if defined(DEFLATE_HASH4) && (defined(FASTEST) || \
+    !(defined(Z_X86_SIMD) || defined(Z_ARM_SIMD)))
+#  undef DEFLATE_HASH4
+#endif
+
+#ifdef DEFLATE_HASH4
+#  define HASH_AT(s, str) \
+   (s->ins_h = (((ulg)s->window[str] | ((ulg)s->window[(str) + 1] << 8) | \
+                 ((ulg)s->window[(str) + 2] << 16) | \
+                 ((ulg)s->window[(str) + 3] << 24)) * 0x9e3779b1UL \
+                & 0xffffffffUL) >> (32 - s->hash_bits))
+#  define WINDOW_PAD 4  /* window items after 2*w_size, the hash reads them */
+#else
+#  define HASH_AT(s, str) \
+   UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)])
+#  define WINDOW_PAD 0
+#endif
+
 
 /* ===========================================================================
  * Insert string str in the dictionary and set match_head to the previous head
@@ -153,12 +180,12 @@ local const config configuration_table[10] = {
  */
 #ifdef FASTEST
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_AT(s, str), \
     match_head = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #else
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_AT(s, str), \
     match_head = s->prev[(str) & s->w_mask] = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #endif
@@ -312,7 +339,7 @@ local void fill_window(deflate_state *s) {
             Call UPDATE_HASH() MIN_MATCH-3 more times
 #endif
             while (s->insert) {
-                UPDATE_HASH(s, s->ins_h, s->window[str + MIN_MATCH-1]);
+                HASH_AT(s, str);
 #ifndef FASTEST
                 s->prev[str & s->w_mask] = s->head[s->ins_h];
 #endif
@@ -446,7 +473,7 @@ int ZEXPORT deflateInit2_(z_streamp strm, int level, int method,
     s->hash_mask = s->hash_size - 1;
     s->hash_shift =  ((s->hash_bits + MIN_MATCH-1) / MIN_MATCH);
 
-    s->window = (Bytef *) ZALLOC(strm, s->w_size, 2*sizeof(Byte));
+    s->window = (Bytef *) ZALLOC(strm, s->w_size + WINDOW_PAD, 2*sizeof(Byte));
     s->prev   = (Posf *)  ZALLOC(strm, s->w_size, sizeof(Pos));
     s->head   = (Posf *)  ZALLOC(strm, s->hash_size, sizeof(Pos));
 
@@ -503,6 +530,12 @@ int ZEXPORT deflateInit2_(z_streamp strm, int level, int method,
         deflateEnd (strm);
         return Z_MEM_ERROR;
     }
+#ifdef DEFLATE_HASH4
+    /* HASH_AT() reads a byte beyond the lookahead, which must be defined to
+     * make the output repeatable, so do not rely on high_water for that.
+     */
+    zmemzero(s->window, (unsigned)(s->w_size + WINDOW_PAD) * 2);
+#endif
 #ifdef LIT_MEM
     s->d_buf = (ushf *)(s->pending_buf + (s->lit_bufsize << 1));
     s->l_buf = s->pending_buf + (s->lit_bufsize << 2);
@@ -589,7 +622,7 @@ int ZEXPORT deflateSetDictionary(z_streamp strm, const Bytef *dictionary,
         str = s->strstart;
         n = s->lookahead - (MIN_MATCH-1);
         do {
-            UPDATE_HASH(s, s->ins_h, s->window[str + MIN_MATCH-1]);
+            HASH_AT(s, str);
 #ifndef FASTEST
             s->prev[str & s->w_mask] = s->head[s->ins_h];
 #endif
@@ -807,6 +840,55 @@ int ZEXPORT deflateTune(z_streamp strm, int good_length, int max_lazy,
     return Z_OK;
 }
 
+/* ========================================================================= */
+uLong ZEXPORT deflateWorkspaceSize(int windowBits, int memLevel) {
+    uLong w_size, hash_size, lit_bufsize;
+
+    /* same parameter checks and adjustments as deflateInit2_() */
+    if (windowBits < 0) {
+        if (windowBits < -15)
+            return 0;
+        windowBits = -windowBits;
+        if (windowBits == 8)
+            return 0;
+    }
+#ifdef GZIP
+    else if (windowBits > 15) {
+        windowBits -= 16;
+        if (windowBits == 8)
+            return 0;
+    }
+#endif
+    if (memLevel < 1 || memLevel > MAX_MEM_LEVEL || windowBits < 8 ||
+        windowBits > 15)
+        return 0;
+    if (windowBits == 8) windowBits = 9;
+
+    /* what deflateInit2_() allocates, each piece rounded for alignment */
+    w_size = 1UL << windowBits;
+    hash_size = 1UL << (memLevel + 7);
+    lit_bufsize = 1UL << (memLevel + 6);
+    return Z_WS_HEAD + Z_WS_ROUND(sizeof(deflate_state)) +
+           Z_WS_ROUND((w_size + WINDOW_PAD) * 2 * sizeof(Byte)) +
+           Z_WS_ROUND(w_size * sizeof(Pos)) +
+           Z_WS_ROUND(hash_size * sizeof(Pos)) +
+           Z_WS_ROUND(lit_bufsize * LIT_BUFS);
+}
+
+/* ========================================================================= */
+int ZEXPORT deflateInitWorkspace(z_streamp strm, int level, int windowBits,
+                                 int memLevel, int strategy, voidpf work,
+                                 uLong size) {
+    int ret;
+
+    ret = z_wsinit(strm, work, size,
+                   deflateWorkspaceSize(windowBits, memLevel));
+    if (ret != Z_OK)
+        return ret;
+    return deflateInit2(strm, level, Z_DEFLATED, windowBits, memLevel,
+                        strategy);
+}
+
 /* =========================================================================
  * For the default windowBits of 15 and memLevel of 8, this function returns a
  * close to exact, as well as small, upper bound on the compressed size. This
@@ -1303,7 +1385,7 @@ int ZEXPORT deflateCopy(z_streamp dest, z_streamp source) {
     zmemcpy((voidpf)ds, (voidpf)ss, sizeof(deflate_state));
     ds->strm = dest;
 
-    ds->window = (Bytef *) ZALLOC(dest, ds->w_size, 2*sizeof(Byte));
+    ds->window = (Bytef *) ZALLOC(dest, ds->w_size + WINDOW_PAD, 2*sizeof(Byte));
     ds->prev   = (Posf *)  ZALLOC(dest, ds->w_size, sizeof(Pos));
     ds->head   = (Posf *)  ZALLOC(dest, ds->hash_size, sizeof(Pos));
     ds->pending_buf = (uchf *) ZALLOC(dest, ds->lit_bufsize, LIT_BUFS);
@@ -1314,7 +1396,7 @@ int ZEXPORT deflateCopy(z_streamp dest, z_streamp source) {
         return Z_MEM_ERROR;
     }
     /* following zmemcpy do not work for 16-bit MSDOS */
-    zmemcpy(ds->window, ss->window, ds->w_size * 2 * sizeof(Byte));
+    zmemcpy(ds->window, ss->window, (ds->w_size + WINDOW_PAD) * 2 * sizeof(Byte));
     zmemcpy((voidpf)ds->prev, (voidpf)ss->prev, ds->w_size * sizeof(Pos));
     zmemcpy((voidpf)ds->head, (voidpf)ss->head, ds->hash_size * sizeof(Pos));
     zmemcpy(ds->pending_buf, ss->pending_buf, ds->lit_bufsize * LIT_BUFS);
@@ -1345,6 +1427,94 @@ int ZEXPORT deflateCopy(z_streamp dest, z_streamp source) {
  *   string (strstart) and its distance is <= MAX_DIST, and prev_length >= 1
  * OUT assertion: the match length is not greater than s->lookahead.
  */
+#if defined(Z_X86_SIMD) || defined(Z_ARM_SIMD)
+#  define COMPARE258
+
+#ifdef Z_X86_SIMD
+#  include <immintrin.h>
+#else
+#  include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+local unsigned ctz32(unsigned long x) {
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return (unsigned)i;
+}
+#  ifdef Z_ARM_SIMD
+local unsigned ctz64(unsigned __int64 x) {
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (unsigned)i;
+}
+#  endif
+#else
+#  define ctz32(x) ((unsigned)__builtin_ctz(x))
+#  define ctz64(x) ((unsigned)__builtin_ctzll(x))
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Return the number of equal bytes at scan and match, up to MAX_MATCH. The
+ * vectors cover the first 256 bytes, so this never reads more than MAX_MATCH
+ * bytes from either, which the window always has after strstart.
+ */
+#ifdef Z_X86_SIMD
+local unsigned compare258_sse2(const Bytef *scan, const Bytef *match) {
+    unsigned len = 0, diff;
+
+    do {
+        diff = 0xffff ^ (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                   _mm_loadu_si128((const __m128i *)(scan + len)),
+                   _mm_loadu_si128((const __m128i *)(match + len))));
+        if (diff)
+            return len + ctz32(diff);
+        len += 16;
+    } while (len < 256);
+    if (scan[256] != match[256]) return 256;
+    return scan[257] != match[257] ? 257 : 258;
+}
+
+Z_TARGET("avx2")
+local unsigned compare258_avx2(const Bytef *scan, const Bytef *match) {
+    unsigned len = 0, diff;
+
+    do {
+        diff = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                   _mm256_loadu_si256((const __m256i *)(scan + len)),
+                   _mm256_loadu_si256((const __m256i *)(match + len))));
+        if (diff)
+            return len + ctz32(diff);
+        len += 32;
+    } while (len < 256);
+    if (scan[256] != match[256]) return 256;
+    return scan[257] != match[257] ? 257 : 258;
+}
+#else
+local unsigned compare258_neon(const Bytef *scan, const Bytef *match) {
+    unsigned len = 0;
+    uint64x2_t eq;
+    uint64_t diff;
+
+    do {
+        eq = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(scan + len),
+                                           vld1q_u8(match + len)));
+        diff = ~vgetq_lane_u64(eq, 0);
+        if (diff)
+            return len + (ctz64(diff) >> 3);
+        diff = ~vgetq_lane_u64(eq, 1);
+        if (diff)
+            return len + 8 + (ctz64(diff) >> 3);
+        len += 16;
+    } while (len < 256);
+    if (scan[256] != match[256]) return 256;
+    return scan[257] != match[257] ? 257 : 258;
+}
+#endif
+
+#endif /* Z_X86_SIMD || Z_ARM_SIMD */
+
 local uInt longest_match(deflate_state *s, IPos cur_match) {
     unsigned chain_length = s->max_chain_length;/* max hash chain length */
     register Bytef *scan = s->window + s->strstart; /* current string */
@@ -1360,7 +1530,14 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
     Posf *prev = s->prev;
     uInt wmask = s->w_mask;
 
-#ifdef UNALIGNED_OK
+#if defined(COMPARE258)
+    /* Compare 16 or 32 bytes at a time, from the first byte on. */
+    register Byte scan_end1  = scan[best_len - 1];
+    register Byte scan_end   = scan[best_len];
+#  ifdef Z_X86_SIMD
+    int avx2 = z_cpu_features() & Z_CPU_AVX2;
+#  endif
+#elif defined(UNALIGNED_OK)
     /* Compare two bytes at a time. Note: this is not always beneficial.
      * Try with and without -DUNALIGNED_OK to check.
      */
@@ -1402,7 +1579,20 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
          * However the length of the match is limited to the lookahead, so
          * the output of deflate is not affected by the uninitialized values.
          */
-#if (defined(UNALIGNED_OK) && MAX_MATCH == 258)
+#if defined(COMPARE258)
+        if (match[best_len]     != scan_end  ||
+            match[best_len - 1] != scan_end1 ||
+            *match              != *scan     ||
+            match[1]            != scan[1])      continue;
+
+#  ifdef Z_X86_SIMD
+        len = (int)(avx2 ? compare258_avx2(scan, match) :
+                           compare258_sse2(scan, match));
+#  else
+        len = (int)compare258_neon(scan, match);
+#  endif
+
+#elif (defined(UNALIGNED_OK) && MAX_MATCH == 258)
         /* This code assumes sizeof(unsigned short) == 2. Do not use
          * UNALIGNED_OK if your compiler uses a different size.
          */
@@ -1474,7 +1664,7 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
             s->match_start = cur_match;
             best_len = len;
             if (len >= nice_match) break;
-#ifdef UNALIGNED_OK
+#if defined(UNALIGNED_OK) && !defined(COMPARE258)
             scan_end = *(ushf*)(scan + best_len - 1);
 #else
             scan_end1  = scan[best_len - 1];
@@ -143,6 +143,17 @@
     ZEXTERN z_off64_t ZEXPORT gzoffset64(gzFile);
 #endif
 
+/* lseek() for 64-bit offsets where available */
+#if defined(_WIN32) && !defined(__BORLANDC__)
+#  define LSEEK _lseeki64
+#else
+#if defined(_LARGEFILE64_SOURCE) && _LFS64_LARGEFILE-0
+#  define LSEEK lseek64
+#else
+#  define LSEEK lseek
+#endif
+#endif
+
 /* default memLevel */
 #if MAX_MEM_LEVEL >= 8
 #  define DEF_MEM_LEVEL 8
@@ -154,6 +165,16 @@
    twice this must be able to fit in an unsigned type) */
 #define GZBUFSIZE 8192
 
+/* input buffer size when reading with the 'm' mode, and the output size from
+   which gzread() decompresses straight into the caller's buffer */
+#define GZBIGBUFSIZE 262144
+#define GZDIRECT 32768
+
+/* the 'm' mode maps the input file into memory where mmap() is available */
+#if !defined(NO_GZMMAP) && (defined(__unix__) || defined(__APPLE__))
+#  define GZ_MMAP
+#endif
+
 /* gzip modes, also provide a little integrity check on the passed structure */
 #define GZ_NONE 0
 #define GZ_READ 7247
@@ -165,6 +186,26 @@
 #define COPY 1      /* copy input directly */
 #define GZIP 2      /* decompress a gzip stream */
 
+/* access point for gzseek() into a gzip stream, see gzindex() */
+typedef struct {
+    z_off64_t out;          /* uncompressed offset of the point */
+    z_off64_t in;           /* file offset of the first whole input byte */
+    int bits;               /* bits of the byte before in that belong here */
+    unsigned dict;          /* bytes of history at window */
+    unsigned char *window;  /* the uncompressed data before out, up to 32K */
+} gz_point;
+
+/* default distance between access points */
+#define GZ_INDEX_SPAN 1048576L
+
+/* list of access points, in increasing out order */
+typedef struct {
+    z_off64_t span;         /* minimum distance between access points */
+    int have;               /* number of points in list */
+    int size;               /* number of points allocated */
+    gz_point *list;         /* access points */
+} gz_index;
+
 /* internal gzip file state data structure */
 typedef struct {
         /* exposed contents for gzgetc() macro */
@@ -186,10 +227,24 @@ typedef struct {
     z_off64_t start;        /* where the gzip data started, for rewinding */
     int eof;                /* true if end of input file reached */
     int past;               /* true if read requested past end */
+    int domap;              /* true for 'm': big reads, mapped if possible */
+    unsigned char *map;     /* the whole input file in memory, or NULL */
+    z_off64_t maplen;       /* length of map */
+    gz_index *index;        /* access points for seeking, or NULL */
+    int raw;                /* true if inflating from an access point */
+    unsigned trail;         /* gzip trailer bytes to skip after raw inflate */
         /* just for writing */
     int level;              /* compression level */
     int strategy;           /* compression strategy */
     int reset;              /* true if a reset is pending after a Z_FINISH */
+    int threads;            /* threads for block-parallel deflate, 0 if off */
+    unsigned char *batch;   /* parallel input, PZ_DICT history + bsize */
+    z_size_t bsize;         /* batch size, PZ_BATCH or a chunk per thread */
+    unsigned hist;          /* history bytes at the start of batch */
+    z_size_t fill;          /* input bytes in batch after the history */
+    uLong check;            /* crc32 of the member written so far */
+    uLong total;            /* uncompressed length of the member, mod 2^32 */
+    int header;             /* true if the member header was written */
         /* seek request */
     z_off64_t skip;         /* amount to skip (already rewound if backwards) */
     int seek;               /* true if seek request pending */
@@ -203,10 +258,24 @@ typedef gz_state FAR *gz_statep;
 
 /* shared functions */
 void ZLIB_INTERNAL gz_error(gz_statep, int, const char *);
+
+/* block-parallel deflate (pdeflate.c): chunk size, dictionary size, and the
+   least amount of input gzwrite() collects before compressing it -- with more
+   than eight threads it collects one chunk per thread */
+#define PZ_CHUNK 131072U
+#define PZ_DICT 32768U
+#define PZ_BATCH (PZ_CHUNK * 8)
+typedef int (*pz_out_func)(void *, const unsigned char *, z_size_t);
+int ZLIB_INTERNAL pz_deflate(const unsigned char *, z_size_t, unsigned, int,
+                             int, int, int, int, uLong *, pz_out_func, void *);
+void ZLIB_INTERNAL pz_gzheader(unsigned char *, int, int);
 #if defined UNDER_CE
 char ZLIB_INTERNAL *gz_strwinerror(DWORD error);
 #endif
 
+/* gzip access point index (gzread.c) */
+int ZLIB_INTERNAL gz_jump(gz_statep, z_off64_t);
+
 /* GT_OFF(x), where x is an unsigned value, is true if x > maximum z_off64_t
    value -- needed when comparing unsigned to z_off64_t, which is signed
    (possible z_off64_t types off_t, off64_t, and long are all signed) */
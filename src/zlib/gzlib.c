@@ -5,16 +5,6 @@
 
 #include "gzguts.h"
 
-#if defined(_WIN32) && !defined(__BORLANDC__)
-#  define LSEEK _lseeki64
-#else
-#if defined(_LARGEFILE64_SOURCE) && _LFS64_LARGEFILE-0
-#  define LSEEK lseek64
-#else
-#  define LSEEK lseek
-#endif
-#endif
-
 #if defined UNDER_CE
 
 /* Map the Windows error number in ERROR to a locale-dependent error message
@@ -72,9 +62,17 @@ local void gz_reset(gz_statep state) {
         state->eof = 0;             /* not at end of file */
         state->past = 0;            /* have not read past end yet */
         state->how = LOOK;          /* look for gzip header */
+        state->raw = 0;             /* inflating with a gzip wrapper */
+        state->trail = 0;           /* no trailer to skip */
     }
-    else                            /* for writing ... */
+    else {                          /* for writing ... */
         state->reset = 0;           /* no deflateReset pending */
+        state->header = 0;          /* no parallel member header yet */
+        state->hist = 0;            /* no parallel history */
+        state->fill = 0;            /* no parallel input */
+        state->check = 0;           /* crc32 of nothing */
+        state->total = 0;           /* no parallel input yet */
+    }
     state->seek = 0;                /* no seek request pending */
     gz_error(state, Z_OK, NULL);    /* clear error */
     state->x.pos = 0;               /* no uncompressed data yet */
@@ -103,6 +101,11 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
         return NULL;
     state->size = 0;            /* no buffers allocated yet */
     state->want = GZBUFSIZE;    /* requested buffer size */
+    state->threads = 0;         /* single deflate stream */
+    state->batch = NULL;        /* no parallel input buffer */
+    state->index = NULL;        /* no access points */
+    state->domap = 0;           /* plain reads */
+    state->map = NULL;          /* not mapped */
     state->msg = NULL;          /* no error message yet */
 
     /* interpret mode */
@@ -156,6 +159,9 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
             case 'T':
                 state->direct = 1;
                 break;
+            case 'm':
+                state->domap = 1;
+                break;
             default:        /* could consider as an error, but just ignore */
                 ;
             }
@@ -175,6 +181,8 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
             return NULL;
         }
         state->direct = 1;      /* for empty file */
+        if (state->domap)
+            state->want = GZBIGBUFSIZE;
     }
 
     /* save the path name for error messages */
@@ -379,6 +387,15 @@ z_off64_t ZEXPORT gzseek64(gzFile file, z_off64_t offset, int whence) {
         return state->x.pos;
     }
 
+    /* jump to the nearest access point if that saves decompressing */
+    if (state->mode == GZ_READ && state->index != NULL &&
+            state->x.pos + offset >= 0) {
+        ret = state->x.pos + offset;
+        if (gz_jump(state, ret) == -1)
+            return -1;
+        offset = ret - state->x.pos;
+    }
+
     /* calculate skip amount, rewinding if needed for back seek when reading */
     if (offset < 0) {
         if (state->mode != GZ_READ)         /* writing -- can't go backwards */
@@ -4,6 +4,11 @@
  */
 
 #include "gzguts.h"
+#ifdef GZ_MMAP
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#endif
 
 /* Use read() to load a buffer -- return -1 on error, otherwise 0.  Read from
    state->fd, and update state->eof, state->err, and state->msg as appropriate.
@@ -33,6 +38,54 @@ local int gz_load(gz_statep state, unsigned char *buf, unsigned len,
     return 0;
 }
 
+#ifdef GZ_MMAP
+/* Map the input file for the 'm' mode if it is a regular file that fits in
+   the address space.  If it can't be mapped, read() is used as usual. */
+local void gz_map(gz_statep state) {
+    struct stat st;
+    void *map;
+
+    if (fstat(state->fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+            st.st_size <= 0 || (z_off64_t)(size_t)st.st_size != st.st_size)
+        return;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, state->fd, 0);
+    if (map == MAP_FAILED)
+        return;
+#  ifdef MADV_SEQUENTIAL
+    (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#  endif
+    state->map = (unsigned char *)map;
+    state->maplen = st.st_size;
+}
+
+/* Point next_in at the mapped input from the current file position on, and
+   move the file position past it, so that the rest of the code sees the same
+   file position as after a read().  Return 1 if input was provided, or 0 to
+   read() instead, as at the end of the map. */
+local int gz_mapped(gz_statep state) {
+    z_off64_t at, len;
+    unsigned max = ((unsigned)-1 >> 2) + 1;
+    z_streamp strm = &(state->strm);
+
+    at = LSEEK(state->fd, 0, SEEK_CUR);
+    if (at == -1)
+        return 0;
+    at -= strm->avail_in;
+    if (at < 0 || at >= state->maplen ||
+            (strm->avail_in && strm->next_in != state->map + at))
+        return 0;
+    len = state->maplen - at;
+    if (len > max)
+        len = max;
+    if (len <= strm->avail_in ||
+            LSEEK(state->fd, at + len, SEEK_SET) == -1)
+        return 0;
+    strm->next_in = state->map + at;
+    strm->avail_in = (unsigned)len;
+    return 1;
+}
+#endif
+
 /* Load up input buffer and set eof flag if last data loaded -- return -1 on
    error, 0 otherwise.  Note that the eof flag is set when the end of the input
    file is reached, even though there may be unused data in the buffer.  Once
@@ -47,6 +100,10 @@ local int gz_avail(gz_statep state) {
     if (state->err != Z_OK && state->err != Z_BUF_ERROR)
         return -1;
     if (state->eof == 0) {
+#ifdef GZ_MMAP
+        if (state->map != NULL && gz_mapped(state))
+            return 0;
+#endif
         if (strm->avail_in) {       /* copy what's there to the start */
             unsigned char *p = state->in;
             unsigned const char *q = strm->next_in;
@@ -88,6 +145,10 @@ local int gz_look(gz_statep state) {
             return -1;
         }
         state->size = state->want;
+#ifdef GZ_MMAP
+        if (state->domap)
+            gz_map(state);
+#endif
 
         /* allocate inflate memory */
         state->strm.zalloc = Z_NULL;
@@ -104,6 +165,21 @@ local int gz_look(gz_statep state) {
         }
     }
 
+    /* skip the gzip trailer of a stream inflated from an access point, which
+       cannot be checked since the stream was not decompressed from its start */
+    while (state->trail) {
+        unsigned n;
+
+        if (strm->avail_in == 0 && gz_avail(state) == -1)
+            return -1;
+        if (strm->avail_in == 0)
+            return 0;
+        n = strm->avail_in < state->trail ? strm->avail_in : state->trail;
+        strm->avail_in -= n;
+        strm->next_in += n;
+        state->trail -= n;
+    }
+
     /* get at least the magic bytes in the input buffer */
     if (strm->avail_in < 2) {
         if (gz_avail(state) == -1)
@@ -121,7 +197,8 @@ local int gz_look(gz_statep state) {
        single byte is sufficient indication that it is not a gzip file) */
     if (strm->avail_in > 1 &&
             strm->next_in[0] == 31 && strm->next_in[1] == 139) {
-        inflateReset(strm);
+        inflateReset2(strm, 15 + 16);   /* may have been raw from gz_jump() */
+        state->raw = 0;
         state->how = GZIP;
         state->direct = 0;
         return 0;
@@ -148,6 +225,48 @@ local int gz_look(gz_statep state) {
     return 0;
 }
 
+/* Add an access point at the current deflate block boundary, which is at
+   uncompressed offset pos, if that is at least span past the last one.  Give
+   up on the index if the file offset can't be determined.  Return -1 if out of
+   memory, otherwise 0. */
+local int gz_mark(gz_statep state, z_off64_t pos) {
+    z_off64_t in;
+    gz_point *point;
+    gz_index *index = state->index;
+    z_streamp strm = &(state->strm);
+
+    if (pos - (index->have ? index->list[index->have - 1].out : 0) <
+            index->span)
+        return 0;
+    in = LSEEK(state->fd, 0, SEEK_CUR);
+    if (in == -1)
+        return 0;
+
+    /* grow the list if needed */
+    if (index->have == index->size) {
+        int size = index->size ? index->size << 1 : 8;
+        point = (gz_point *)realloc(index->list, size * sizeof(gz_point));
+        if (point == NULL)
+            goto nomem;
+        index->list = point;
+        index->size = size;
+    }
+    point = index->list + index->have;
+    point->out = pos;
+    point->in = in - strm->avail_in;
+    point->bits = strm->data_type & 7;
+    point->window = (unsigned char *)malloc(32768U);
+    if (point->window == NULL)
+        goto nomem;
+    inflateGetDictionary(strm, point->window, &point->dict);
+    index->have++;
+    return 0;
+
+  nomem:
+    gz_error(state, Z_MEM_ERROR, "out of memory");
+    return -1;
+}
+
 /* Decompress from input to the provided next_out and avail_out in the state.
    On return, state->x.have and state->x.next point to the just decompressed
    data.  If the gzip stream completes, state->how is reset to LOOK to look for
@@ -157,6 +276,7 @@ local int gz_decomp(gz_statep state) {
     int ret = Z_OK;
     unsigned had;
     z_streamp strm = &(state->strm);
+    int flush = state->index != NULL ? Z_BLOCK : Z_NO_FLUSH;
 
     /* fill output buffer up to end of deflate stream */
     had = strm->avail_out;
@@ -170,7 +290,7 @@ local int gz_decomp(gz_statep state) {
         }
 
         /* decompress and handle errors */
-        ret = inflate(strm, Z_NO_FLUSH);
+        ret = inflate(strm, flush);
         if (ret == Z_STREAM_ERROR || ret == Z_NEED_DICT) {
             gz_error(state, Z_STREAM_ERROR,
                      "internal error: inflate stream corrupt");
@@ -185,6 +305,13 @@ local int gz_decomp(gz_statep state) {
                      strm->msg == NULL ? "compressed data error" : strm->msg);
             return -1;
         }
+
+        /* at a block boundary that is not the end, maybe add an access point
+           (the output at x.pos was already delivered, since x.have is 0) */
+        if (flush == Z_BLOCK && ret != Z_STREAM_END &&
+                (strm->data_type & 192) == 128 &&
+                gz_mark(state, state->x.pos + (had - strm->avail_out)) == -1)
+            return -1;
     } while (strm->avail_out && ret != Z_STREAM_END);
 
     /* update available output */
@@ -192,8 +319,11 @@ local int gz_decomp(gz_statep state) {
     state->x.next = strm->next_out - state->x.have;
 
     /* if the gzip stream completed successfully, look for another */
-    if (ret == Z_STREAM_END)
+    if (ret == Z_STREAM_END) {
         state->how = LOOK;
+        if (state->raw)
+            state->trail = 8;
+    }
 
     /* good decompression */
     return 0;
@@ -261,6 +391,71 @@ local int gz_skip(gz_statep state, z_off64_t len) {
     return 0;
 }
 
+/* Position the input at the last access point at or before uncompressed
+   offset pos, if that is past what is already decompressed or if pos is behind
+   the current position, and set up raw inflate from there.  Return -1 on
+   error, otherwise 0, with state->x.pos at the point if jumped. */
+int ZLIB_INTERNAL gz_jump(gz_statep state, z_off64_t pos) {
+    int lo, hi, mid, ret;
+    unsigned char ch;
+    unsigned got;
+    gz_point *point;
+    gz_index *index = state->index;
+    z_streamp strm = &(state->strm);
+
+    /* find the last point at or before pos */
+    lo = 0;
+    hi = index->have;
+    while (lo < hi) {
+        mid = lo + ((hi - lo) >> 1);
+        if (index->list[mid].out <= pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return 0;
+    point = index->list + lo - 1;
+    if (pos >= state->x.pos && point->out <= state->x.pos + state->x.have)
+        return 0;
+
+    /* need the buffers and inflate state, and a gzip stream to jump in */
+    if (state->size == 0 && gz_look(state) == -1)
+        return -1;
+    if (state->direct)
+        return 0;
+
+    /* go to the point, loading the partial byte for inflatePrime() */
+    if (LSEEK(state->fd, point->in - (point->bits ? 1 : 0), SEEK_SET) == -1)
+        return -1;
+    state->x.have = 0;
+    state->eof = 0;
+    state->past = 0;
+    state->trail = 0;
+    gz_error(state, Z_OK, NULL);
+    strm->avail_in = 0;
+    inflateReset2(strm, -15);
+    if (point->bits) {
+        if (gz_load(state, &ch, 1, &got) == -1)
+            return -1;
+        if (got == 0) {
+            gz_error(state, Z_DATA_ERROR, "access point past end of file");
+            return -1;
+        }
+        inflatePrime(strm, point->bits, ch >> (8 - point->bits));
+    }
+    ret = point->dict ?
+          inflateSetDictionary(strm, point->window, point->dict) : Z_OK;
+    if (ret != Z_OK) {
+        gz_error(state, Z_STREAM_ERROR, "internal error: bad access point");
+        return -1;
+    }
+    state->how = GZIP;
+    state->raw = 1;
+    state->x.pos = point->out;
+    return 0;
+}
+
 /* Read len bytes into buf from file, or less than len up to the end of the
    input.  Return the number of bytes read.  If zero is returned, either the
    end of file was reached, or there was an error.  state->err must be
@@ -305,7 +500,8 @@ local z_size_t gz_read(gz_statep state, voidp buf, z_size_t len) {
 
         /* need output data -- for small len or new stream load up our output
            buffer */
-        else if (state->how == LOOK || n < (state->size << 1)) {
+        else if (state->how == LOOK ||
+                 (n < (state->size << 1) && n < GZDIRECT)) {
             /* get more output, looking for header if required */
             if (gz_fetch(state) == -1)
                 return 0;
@@ -573,6 +769,248 @@ int ZEXPORT gzdirect(gzFile file) {
     return state->direct;
 }
 
+/* Free an access point index. */
+local void gz_index_free(gz_index *index) {
+    if (index != NULL) {
+        while (index->have)
+            free(index->list[--index->have].window);
+        free(index->list);
+        free(index);
+    }
+}
+
+/* -- see zlib.h -- */
+int ZEXPORT gzindex(gzFile file, z_off_t span) {
+    gz_statep state;
+
+    /* get internal structure */
+    if (file == NULL)
+        return -1;
+    state = (gz_statep)file;
+
+    /* check that we're reading */
+    if (state->mode != GZ_READ)
+        return -1;
+
+    /* start an index, or change the span of the current one */
+    if (state->index == NULL) {
+        state->index = (gz_index *)malloc(sizeof(gz_index));
+        if (state->index == NULL) {
+            gz_error(state, Z_MEM_ERROR, "out of memory");
+            return -1;
+        }
+        state->index->have = 0;
+        state->index->size = 0;
+        state->index->list = NULL;
+    }
+    state->index->span = span > 0 ? span : GZ_INDEX_SPAN;
+    return 0;
+}
+
+/* -- see zlib.h -- */
+int ZEXPORT gzindexbuild(gzFile file) {
+    z_off64_t pos;
+    gz_statep state;
+
+    /* get internal structure */
+    if (file == NULL)
+        return -1;
+    state = (gz_statep)file;
+
+    /* check that we're reading and that there's no error */
+    if (state->mode != GZ_READ ||
+            (state->err != Z_OK && state->err != Z_BUF_ERROR))
+        return -1;
+    if (state->index == NULL && gzindex(file, 0) == -1)
+        return -1;
+
+    /* decompress the rest of the input, collecting access points */
+    pos = state->x.pos + (state->seek ? state->skip : 0);
+    state->seek = 0;
+    do {
+        state->x.pos += state->x.have;
+        state->x.have = 0;
+        if (gz_fetch(state) == -1)
+            return -1;
+    } while (state->x.have);
+
+    /* return to where we were, using the new access points */
+    if (gz_jump(state, pos) == -1)
+        return -1;
+    if (state->x.pos > pos && gzrewind(file) == -1)
+        return -1;
+    if (state->x.pos < pos) {
+        state->seek = 1;
+        state->skip = pos - state->x.pos;
+    }
+    return state->index->have;
+}
+
+/* Store n bytes of val at buf, least significant first. */
+local void gz_put(unsigned char *buf, z_off64_t val, int n) {
+    while (n--) {
+        *buf++ = (unsigned char)val;
+        val >>= 8;
+    }
+}
+
+/* Return the n bytes at buf as a number, least significant first. */
+local z_off64_t gz_get(const unsigned char *buf, int n) {
+    z_off64_t val = 0;
+
+    while (n--)
+        val = (val << 8) + buf[n];
+    return val;
+}
+
+/* Identify the file behind an index with its length and its last 8 bytes (the
+   gzip trailer of the last member) in key[0..15].  Return -1 on error. */
+local int gz_index_key(gz_statep state, unsigned char *key) {
+    z_off64_t at, end;
+    int ret = 0;
+
+    at = LSEEK(state->fd, 0, SEEK_CUR);
+    end = LSEEK(state->fd, 0, SEEK_END);
+    if (at == -1 || end == -1)
+        return -1;
+    gz_put(key, end, 8);
+    memset(key + 8, 0, 8);
+    if (end >= 8 && (LSEEK(state->fd, end - 8, SEEK_SET) == -1 ||
+                     read(state->fd, key + 8, 8) != 8))
+        ret = -1;
+    if (LSEEK(state->fd, at, SEEK_SET) == -1)
+        ret = -1;
+    return ret;
+}
+
+/* index file layout: magic, key, span, count, then for each access point out,
+   in, bits, dict, and dict bytes of window -- numbers are little endian */
+#define GZ_INDEX_MAGIC "GZINDEX1"
+#define GZ_INDEX_HEAD 36
+#define GZ_INDEX_POINT 21
+
+/* -- see zlib.h -- */
+int ZEXPORT gzindexsave(gzFile file, const char *path) {
+    int n, ret = 0;
+    FILE *out;
+    gz_point *point;
+    gz_statep state;
+    unsigned char head[GZ_INDEX_HEAD];
+
+    /* get internal structure */
+    if (file == NULL || path == NULL)
+        return -1;
+    state = (gz_statep)file;
+
+    /* check that we're reading and have an index */
+    if (state->mode != GZ_READ || state->index == NULL)
+        return -1;
+
+    /* write the header and the access points */
+    memcpy(head, GZ_INDEX_MAGIC, 8);
+    if (gz_index_key(state, head + 8) == -1)
+        return -1;
+    gz_put(head + 24, state->index->span, 8);
+    gz_put(head + 32, state->index->have, 4);
+    out = fopen(path, "wb");
+    if (out == NULL)
+        return -1;
+    if (fwrite(head, 1, GZ_INDEX_HEAD, out) != GZ_INDEX_HEAD)
+        ret = -1;
+    for (n = 0; ret == 0 && n < state->index->have; n++) {
+        point = state->index->list + n;
+        gz_put(head, point->out, 8);
+        gz_put(head + 8, point->in, 8);
+        head[16] = (unsigned char)point->bits;
+        gz_put(head + 17, point->dict, 4);
+        if (fwrite(head, 1, GZ_INDEX_POINT, out) != GZ_INDEX_POINT ||
+                fwrite(point->window, 1, point->dict, out) != point->dict)
+            ret = -1;
+    }
+    if (fclose(out))
+        ret = -1;
+    return ret;
+}
+
+/* -- see zlib.h -- */
+int ZEXPORT gzindexload(gzFile file, const char *path) {
+    int n;
+    z_off64_t size;
+    FILE *in;
+    gz_point *point;
+    gz_index *index;
+    gz_statep state;
+    unsigned char head[GZ_INDEX_HEAD], key[16];
+
+    /* get internal structure */
+    if (file == NULL || path == NULL)
+        return -1;
+    state = (gz_statep)file;
+
+    /* check that we're reading */
+    if (state->mode != GZ_READ)
+        return -1;
+
+    /* check that the index is for this file */
+    in = fopen(path, "rb");
+    if (in == NULL)
+        return -1;
+    if (fread(head, 1, GZ_INDEX_HEAD, in) != GZ_INDEX_HEAD ||
+            memcmp(head, GZ_INDEX_MAGIC, 8) ||
+            gz_index_key(state, key) == -1 || memcmp(head + 8, key, 16) ||
+            gz_get(head + 32, 4) > INT_MAX / (int)sizeof(gz_point)) {
+        fclose(in);
+        return -1;
+    }
+    size = gz_get(key, 8);
+
+    /* read the access points, checking that they make sense */
+    index = (gz_index *)malloc(sizeof(gz_index));
+    if (index == NULL) {
+        fclose(in);
+        return -1;
+    }
+    index->span = gz_get(head + 24, 8);
+    index->size = (int)gz_get(head + 32, 4);
+    index->have = 0;
+    index->list = (gz_point *)malloc((index->size ? index->size : 1) *
+                                     sizeof(gz_point));
+    if (index->list == NULL) {
+        free(index);
+        fclose(in);
+        return -1;
+    }
+    for (n = 0; n < index->size; n++) {
+        point = index->list + n;
+        if (fread(head, 1, GZ_INDEX_POINT, in) != GZ_INDEX_POINT)
+            break;
+        point->out = gz_get(head, 8);
+        point->in = gz_get(head + 8, 8);
+        point->bits = head[16];
+        point->dict = (unsigned)gz_get(head + 17, 4);
+        if (point->out <= (n ? point[-1].out : 0) || point->in > size ||
+                point->in < (point->bits ? 1 : 0) || point->bits > 7 ||
+                point->dict > 32768U)
+            break;
+        point->window = (unsigned char *)malloc(point->dict ? point->dict : 1);
+        if (point->window == NULL)
+            break;
+        index->have++;
+        if (fread(point->window, 1, point->dict, in) != point->dict)
+            break;
+    }
+    fclose(in);
+    if (index->have < index->size || index->span <= 0) {
+        gz_index_free(index);
+        return -1;
+    }
+
+    /* replace the current index */
+    gz_index_free(state->index);
+    state->index = index;
+    return index->have;
+}
+
 /* -- see zlib.h -- */
 int ZEXPORT gzclose_r(gzFile file) {
     int ret, err;
@@ -593,6 +1031,11 @@ int ZEXPORT gzclose_r(gzFile file) {
         free(state->out);
         free(state->in);
     }
+    gz_index_free(state->index);
+#ifdef GZ_MMAP
+    if (state->map != NULL)
+        munmap(state->map, (size_t)state->maplen);
+#endif
     err = state->err == Z_BUF_ERROR ? Z_BUF_ERROR : Z_OK;
     gz_error(state, Z_OK, NULL);
     free(state->path);
@@ -19,6 +19,25 @@ local int gz_init(gz_statep state) {
         return -1;
     }
 
+    /* block-parallel deflate only needs its input batch with history, with
+       enough chunks in the batch to keep all of the threads busy */
+    if (!state->direct && state->threads) {
+        state->bsize = PZ_BATCH;
+        if ((unsigned)state->threads > PZ_BATCH / PZ_CHUNK)
+            state->bsize = (z_size_t)PZ_CHUNK * (unsigned)state->threads;
+        state->batch = NULL;            /* too many threads for memory */
+        if (state->bsize / PZ_CHUNK >= (unsigned)state->threads &&
+            state->bsize <= (z_size_t)-1 - PZ_DICT)
+            state->batch = (unsigned char *)malloc(PZ_DICT + state->bsize);
+        if (state->batch == NULL) {
+            free(state->in);
+            gz_error(state, Z_MEM_ERROR, "out of memory");
+            return -1;
+        }
+        state->size = state->want;
+        return 0;
+    }
+
     /* only need output buffer and deflate state if compressing */
     if (!state->direct) {
         /* allocate output buffer */
@@ -56,6 +75,114 @@ local int gz_init(gz_statep state) {
     return 0;
 }
 
+/* Write compressed data from pz_deflate() to the output file.  Return Z_OK, or
+   Z_ERRNO on a write error. */
+local int gz_pwrite(void *opaque, const unsigned char *buf, z_size_t len) {
+    int writ;
+    unsigned put, max = ((unsigned)-1 >> 2) + 1;
+    gz_statep state = (gz_statep)opaque;
+
+    while (len) {
+        put = len > max ? max : (unsigned)len;
+        writ = write(state->fd, buf, put);
+        if (writ < 0) {
+            gz_error(state, Z_ERRNO, zstrerror());
+            return Z_ERRNO;
+        }
+        buf += writ;
+        len -= (unsigned)writ;
+    }
+    return Z_OK;
+}
+
+/* Compress the input collected in the batch with block-parallel deflate,
+   writing the gzip header first if this starts a member.  If last is true,
+   end the deflate stream and write the gzip trailer.  Keep up to 32K of the
+   input as the dictionary for the next batch.  Return -1 on error, or 0. */
+local int gz_pbatch(gz_statep state, int last) {
+    int ret;
+    unsigned keep;
+    unsigned char head[10];
+
+    if (!state->header) {
+        pz_gzheader(head, state->level, state->strategy);
+        if (gz_pwrite(state, head, 10) != Z_OK)
+            return -1;
+        state->header = 1;
+    }
+    ret = pz_deflate(state->batch + state->hist, state->fill, state->hist,
+                     state->level, state->strategy, last, state->threads, 1,
+                     &state->check, gz_pwrite, state);
+    if (ret != Z_OK) {
+        if (state->err == Z_OK)
+            gz_error(state, ret == Z_MEM_ERROR ? Z_MEM_ERROR : Z_STREAM_ERROR,
+                     ret == Z_MEM_ERROR ? "out of memory" :
+                     "internal error: deflate stream corrupt");
+        return -1;
+    }
+    state->total += (uLong)state->fill;
+    keep = state->hist + state->fill > PZ_DICT ? PZ_DICT :
+           state->hist + (unsigned)state->fill;
+    memmove(state->batch, state->batch + state->hist + state->fill - keep,
+            keep);
+    state->hist = keep;
+    state->fill = 0;
+
+    if (last) {
+        head[0] = (unsigned char)state->check;
+        head[1] = (unsigned char)(state->check >> 8);
+        head[2] = (unsigned char)(state->check >> 16);
+        head[3] = (unsigned char)(state->check >> 24);
+        head[4] = (unsigned char)state->total;
+        head[5] = (unsigned char)(state->total >> 8);
+        head[6] = (unsigned char)(state->total >> 16);
+        head[7] = (unsigned char)(state->total >> 24);
+        if (gz_pwrite(state, head, 8) != Z_OK)
+            return -1;
+    }
+    return 0;
+}
+
+/* gz_comp() for block-parallel deflate: collect the input in the batch and
+   compress it when the batch is full, or when flushing. */
+local int gz_pcomp(gz_statep state, int flush) {
+    z_size_t copy;
+    z_streamp strm = &(state->strm);
+
+    /* start a new member, but only if there is data to write */
+    if (state->reset) {
+        if (strm->avail_in == 0)
+            return 0;
+        state->header = 0;
+        state->hist = 0;
+        state->check = 0;
+        state->total = 0;
+        state->reset = 0;
+    }
+
+    while (strm->avail_in) {
+        copy = state->bsize - state->fill;
+        if (copy > strm->avail_in)
+            copy = strm->avail_in;
+        memcpy(state->batch + state->hist + state->fill, strm->next_in, copy);
+        state->fill += copy;
+        strm->next_in += copy;
+        strm->avail_in -= (uInt)copy;
+        if (state->fill == state->bsize && gz_pbatch(state, 0) == -1)
+            return -1;
+    }
+
+    if (flush != Z_NO_FLUSH) {
+        if (gz_pbatch(state, flush == Z_FINISH) == -1)
+            return -1;
+        if (flush == Z_FINISH)
+            state->reset = 1;
+        else if (flush == Z_FULL_FLUSH)
+            state->hist = 0;
+    }
+    return 0;
+}
+
 /* Compress whatever is at avail_in and next_in and write to the output file.
    Return -1 if there is an error writing to the output file or if gz_init()
    fails to allocate memory, otherwise 0.  flush is assumed to be a valid
@@ -86,6 +213,10 @@ local int gz_comp(gz_statep state, int flush) {
         return 0;
     }
 
+    /* collect input for block-parallel deflate if requested */
+    if (state->threads)
+        return gz_pcomp(state, flush);
+
     /* check for a pending reset */
     if (state->reset) {
         /* don't start a new gzip member unless there is data to write */
@@ -582,15 +713,33 @@ int ZEXPORT gzsetparams(gzFile file, int level, int strategy) {
     /* change compression parameters for subsequent input */
     if (state->size) {
         /* flush previous input with previous parameters before changing */
-        if (strm->avail_in && gz_comp(state, Z_BLOCK) == -1)
+        if ((strm->avail_in || (state->threads && state->fill)) &&
+            gz_comp(state, Z_BLOCK) == -1)
             return state->err;
-        deflateParams(strm, level, strategy);
+        if (!state->threads)
+            deflateParams(strm, level, strategy);
     }
     state->level = level;
     state->strategy = strategy;
     return Z_OK;
 }
 
+/* -- see zlib.h -- */
+int ZEXPORT gzsetthreads(gzFile file, int threads) {
+    gz_statep state;
+
+    /* get internal structure */
+    if (file == NULL)
+        return -1;
+    state = (gz_statep)file;
+
+    /* check that we're writing and haven't allocated memory yet */
+    if (state->mode != GZ_WRITE || state->size != 0 || threads < 0)
+        return -1;
+    state->threads = threads;
+    return 0;
+}
+
 /* -- see zlib.h -- */
 int ZEXPORT gzclose_w(gzFile file) {
     int ret = Z_OK;
@@ -616,7 +765,9 @@ int ZEXPORT gzclose_w(gzFile file) {
     if (gz_comp(state, Z_FINISH) == -1)
         ret = state->err;
     if (state->size) {
-        if (!state->direct) {
+        if (state->batch != NULL)
+            free(state->batch);
+        else if (!state->direct) {
             (void)deflateEnd(&(state->strm));
             free(state->out);
         }
@@ -0,0 +1,131 @@
+/* infbatch.c -- inflate many small buffers with reused inflate states
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/*
+   A batch context keeps one inflate state per thread, set up once with
+   inflateInit2() and only reset with inflateReset() between items, so that
+   the state and the window are allocated once for the whole batch and for
+   later batches, instead of once per buffer as with uncompress(). The items
+   are taken in turn by the threads started with z_parallel() for each call
+   of inflateBatch().
+ */
+
+#include "zutil.h"
+
+struct z_inflate_batch_s {
+    int threads;                /* number of inflate states */
+    z_stream *strm;             /* one inflate state per thread */
+};
+
+typedef struct {
+    z_inflate_batch *batch;
+    z_inflate_item *item;
+    long count;
+    long next;                  /* next item to take */
+} batch_work;
+
+/* Inflate one item with strm, like uncompress2() does, but with a state that
+   was already initialized. */
+local int batch_item(z_streamp strm, z_inflate_item *item) {
+    int err;
+    uLong len, left;
+    const uInt max = (uInt)-1;
+
+    if (inflateReset(strm) != Z_OK)
+        return Z_STREAM_ERROR;
+    len = item->sourceLen;
+    left = item->destLen;
+    strm->next_in = (z_const Bytef *)item->source;
+    strm->avail_in = 0;
+    strm->next_out = item->dest;
+    strm->avail_out = 0;
+
+    do {
+        if (strm->avail_out == 0) {
+            strm->avail_out = left > (uLong)max ? max : (uInt)left;
+            left -= strm->avail_out;
+        }
+        if (strm->avail_in == 0) {
+            strm->avail_in = len > (uLong)max ? max : (uInt)len;
+            len -= strm->avail_in;
+        }
+        err = inflate(strm, Z_NO_FLUSH);
+    } while (err == Z_OK);
+
+    item->sourceLen -= len + strm->avail_in;
+    item->destLen = strm->total_out;
+    return err == Z_STREAM_END ? Z_OK :
+           err == Z_NEED_DICT ? Z_DATA_ERROR :
+           err == Z_BUF_ERROR && left + strm->avail_out ? Z_DATA_ERROR :
+           err;
+}
+
+local void batch_worker(void *arg, int slot) {
+    long i;
+    batch_work *work = (batch_work *)arg;
+    z_streamp strm = work->batch->strm + slot;
+
+    while ((i = Z_NEXT(work->next)) < work->count)
+        work->item[i].status = batch_item(strm, work->item + i);
+}
+
+/* ========================================================================= */
+z_inflate_batch * ZEXPORT inflateBatchInit(int windowBits, int threads) {
+    int n;
+    z_inflate_batch *batch;
+
+    if (threads < 1)
+        threads = 1;
+    batch = (z_inflate_batch *)malloc(sizeof(z_inflate_batch));
+    if (batch == Z_NULL)
+        return Z_NULL;
+    batch->strm = (z_stream *)calloc((size_t)threads, sizeof(z_stream));
+    if (batch->strm == Z_NULL) {
+        free(batch);
+        return Z_NULL;
+    }
+    for (n = 0; n < threads; n++)
+        if (inflateInit2(batch->strm + n, windowBits) != Z_OK)
+            break;
+    batch->threads = n;
+    if (n < threads) {
+        inflateBatchEnd(batch);
+        return Z_NULL;
+    }
+    return batch;
+}
+
+/* ========================================================================= */
+long ZEXPORT inflateBatch(z_inflate_batch *batch, z_inflate_item *items,
+                          long count) {
+    long i, failed = 0;
+    int threads;
+    batch_work work;
+
+    if (batch == Z_NULL || (items == Z_NULL && count) || count < 0)
+        return Z_STREAM_ERROR;
+    work.batch = batch;
+    work.item = items;
+    work.count = count;
+    work.next = 0;
+    threads = batch->threads;
+    if (threads > count)
+        threads = (int)count;
+    z_parallel(batch_worker, &work, threads);
+
+    for (i = 0; i < count; i++)
+        if (items[i].status != Z_OK)
+            failed++;
+    return failed;
+}
+
+/* ========================================================================= */
+void ZEXPORT inflateBatchEnd(z_inflate_batch *batch) {
+    if (batch == Z_NULL)
+        return;
+    while (batch->threads)
+        (void)inflateEnd(batch->strm + --batch->threads);
+    free(batch->strm);
+    free(batch);
+}
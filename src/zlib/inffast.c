@@ -12,6 +12,272 @@
 #  pragma message("Assembler code may have bugs -- use at your own risk")
 #else
 
+#ifdef INFLATE_FAST_WIDE
+
+/*
+   This is the same decoder as the one below, with these changes:
+
+    - The bit buffer hold is 64 bits. At the start of each loop it is refilled
+      with one unaligned eight-byte load to hold at least 56 bits, which is
+      more than the 48 bits a length/distance pair can use. So there are no
+      other refills in the loop. This needs strm->avail_in >= 8.
+
+    - Matches are copied in chunks of 16 bytes, or 8 bytes for distances of 8
+      to 15. For shorter distances, the first bytes are copied one at a time
+      until the pattern repeats at a distance of eight or more. A chunk may
+      write up to 15 bytes beyond the match, which requires strm->avail_out
+      >= 258 + 15. Copies out of the window are exact and never read past its
+      end, so the window does not need a guard area.
+
+   The loads assume a little endian processor, see inffast.h.
+ */
+
+typedef Z_U8 z_hold_t;
+
+local z_hold_t load64(z_const unsigned char FAR *p) {
+    z_hold_t v;
+    zmemcpy((Bytef *)&v, (z_const Bytef *)p, sizeof(v));
+    return v;
+}
+
+/* Copy len bytes from out - dist to out with dist <= out - beg, allowing to
+   write up to 15 bytes past out + len. Return out + len. */
+local unsigned char FAR *chunk_copy(unsigned char FAR *out, unsigned dist,
+                                    unsigned len) {
+    unsigned char FAR *end = out + len;
+    z_const unsigned char FAR *from = out - dist;
+
+    if (dist >= 16) {
+        do {
+            zmemcpy(out, from, 16);
+            out += 16;
+            from += 16;
+        } while (out < end);
+    }
+    else if (dist == 1)
+        memset(out, *from, len);
+    else {
+        if (dist < 8) {             /* repeat the pattern up to 8 or more */
+            unsigned step = dist, n;
+            while (step < 8)
+                step += dist;
+            n = len < step ? len : step;
+            do {
+                *out++ = *from++;
+            } while (--n);
+            from = out - step;
+        }
+        while (out < end) {
+            zmemcpy(out, from, 8);
+            out += 8;
+            from += 8;
+        }
+    }
+    return end;
+}
+
+void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
+    struct inflate_state FAR *state;
+    z_const unsigned char FAR *in;      /* local strm->next_in */
+    z_const unsigned char FAR *last;    /* have enough input while in < last */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned wnext;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    z_hold_t hold;              /* local strm->hold */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code const *here;           /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_HAVE - 1));
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_LEFT - 1));
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    wnext = state->wnext;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        hold |= load64(in) << bits;
+        in += (63 - bits) >> 3;
+        bits |= 56;
+        here = lcode + (hold & lmask);
+      dolen:
+        op = (unsigned)(here->bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(here->op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, here->val >= 0x20 && here->val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", here->val));
+            *out++ = (unsigned char)(here->val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(here->val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            here = dcode + (hold & dmask);
+          dodist:
+            op = (unsigned)(here->bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(here->op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(here->val);
+                op &= 15;                       /* number of extra bits */
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        if (state->sane) {
+                            strm->msg =
+                                (char *)"invalid distance too far back";
+                            state->mode = BAD;
+                            break;
+                        }
+#ifdef INFLATE_ALLOW_INVALID_DISTANCE_TOOFAR_ARRR
+                        if (len <= op - whave) {
+                            do {
+                                *out++ = 0;
+                            } while (--len);
+                            continue;
+                        }
+                        len -= op - whave;
+                        do {
+                            *out++ = 0;
+                        } while (--op > whave);
+                        if (op == 0) {
+                            from = out - dist;
+                            do {
+                                *out++ = *from++;
+                            } while (--len);
+                            continue;
+                        }
+#endif
+                    }
+                    from = window;
+                    if (wnext == 0)             /* very common case */
+                        from += wsize - op;
+                    else if (wnext < op) {      /* wrap around window */
+                        from += wsize + wnext - op;
+                        op -= wnext;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            zmemcpy(out, from, op);
+                            out += op;
+                            from = window;
+                            op = wnext;
+                        }
+                    }
+                    else                        /* contiguous in window */
+                        from += wnext - op;
+                    if (op < len) {             /* some from window */
+                        len -= op;
+                        zmemcpy(out, from, op);
+                        out = chunk_copy(out + op, dist, len);
+                    }
+                    else {                      /* all from window */
+                        zmemcpy(out, from, len);
+                        out += len;
+                    }
+                }
+                else                            /* copy direct from output */
+                    out = chunk_copy(out, dist, len);
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                here = dcode + here->val + (hold & ((1U << op) - 1));
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            here = lcode + here->val + (hold & ((1U << op) - 1));
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes, these were all loaded by this loop */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1U << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in < last ?
+                                (INFLATE_FAST_MIN_HAVE - 1) + (last - in) :
+                                (INFLATE_FAST_MIN_HAVE - 1) - (in - last));
+    strm->avail_out = (unsigned)(out < end ?
+                                 (INFLATE_FAST_MIN_LEFT - 1) + (end - out) :
+                                 (INFLATE_FAST_MIN_LEFT - 1) - (out - end));
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+    return;
+}
+
+#else /* !INFLATE_FAST_WIDE */
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -317,4 +583,6 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
    - Moving len -= 3 statement into middle of loop
  */
 
+#endif /* !INFLATE_FAST_WIDE */
+
 #endif /* !ASMINF */
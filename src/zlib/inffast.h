@@ -8,4 +8,25 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* The wide inflate_fast() refills a 64-bit bit buffer eight bytes at a time
+   and copies matches in 8 or 16-byte chunks. It is used on 64-bit little
+   endian targets unless NO_INFLATE_FAST_WIDE is defined. It needs a little
+   more input and output to be available for each loop, because the refill
+   reads eight bytes and a chunked copy may write up to 15 bytes past the end
+   of a match. Those bytes are rewritten later or left unused. */
+#if !defined(INFLATE_FAST_WIDE) && !defined(NO_INFLATE_FAST_WIDE) && \
+    defined(Z_U8) && (defined(__x86_64__) || defined(_M_X64) || \
+    defined(_M_ARM64) || (defined(__aarch64__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#  define INFLATE_FAST_WIDE
+#endif
+
+#ifdef INFLATE_FAST_WIDE
+#  define INFLATE_FAST_MIN_HAVE 8
+#  define INFLATE_FAST_MIN_LEFT (258 + 15)
+#else
+#  define INFLATE_FAST_MIN_HAVE 6
+#  define INFLATE_FAST_MIN_LEFT 258
+#endif
+
 void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start);
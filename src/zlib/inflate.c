@@ -220,6 +220,34 @@ int ZEXPORT inflateInit_(z_streamp strm, const char *version,
     return inflateInit2_(strm, DEF_WBITS, version, stream_size);
 }
 
+uLong ZEXPORT inflateWorkspaceSize(int windowBits) {
+    /* same checks as inflateReset2(), and room for the largest window if
+       the zlib header is to say */
+    if (windowBits < 0) {
+        if (windowBits < -15)
+            return 0;
+        windowBits = -windowBits;
+    }
+    else if (windowBits < 48)
+        windowBits &= 15;
+    if (windowBits && (windowBits < 8 || windowBits > 15))
+        return 0;
+    if (windowBits == 0)
+        windowBits = 15;
+    return Z_WS_HEAD + Z_WS_ROUND(sizeof(struct inflate_state)) +
+           Z_WS_ROUND(1UL << windowBits);
+}
+
+int ZEXPORT inflateInitWorkspace(z_streamp strm, int windowBits, voidpf work,
+                                 uLong size) {
+    int ret;
+
+    ret = z_wsinit(strm, work, size, inflateWorkspaceSize(windowBits));
+    if (ret != Z_OK)
+        return ret;
+    return inflateInit2(strm, windowBits);
+}
+
 int ZEXPORT inflatePrime(z_streamp strm, int bits, int value) {
     struct inflate_state FAR *state;
 
@@ -1024,7 +1052,7 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
             state->mode = LEN;
                 /* fallthrough */
         case LEN:
-            if (have >= 6 && left >= 258) {
+            if (have >= INFLATE_FAST_MIN_HAVE && left >= INFLATE_FAST_MIN_LEFT) {
                 RESTORE();
                 inflate_fast(strm, out);
                 LOAD();
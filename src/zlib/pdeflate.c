@@ -0,0 +1,240 @@
+/* pdeflate.c -- block-parallel deflate on several threads
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/*
+   The input is cut into chunks that are compressed independently, each one
+   primed with the 32K of input before it as a dictionary, so that only the
+   first matches of a chunk are lost. The chunks end with a sync flush (an
+   empty stored block), or are stored as they are if they don't compress, so
+   they are byte aligned and can be concatenated as they are, the last chunk
+   of the stream ends with the final block. The check values of the chunks
+   are joined with crc32_combine() or adler32_combine(). This is the approach
+   of pigz by Mark Adler.
+
+   The chunks are spread over the threads with z_parallel(). Without thread
+   support the chunks are simply compressed one after the other, which gives
+   the same result.
+ */
+
+#include "zutil.h"
+#include "gzguts.h"
+
+typedef struct {
+    const unsigned char *in;    /* chunk input, with dict bytes before it */
+    z_size_t len;               /* chunk length */
+    unsigned dict;              /* bytes before in to use as dictionary */
+    int flush;                  /* Z_SYNC_FLUSH, or Z_FINISH for the last */
+    unsigned char *out;         /* compressed chunk, allocated here */
+    z_size_t have;              /* bytes at out */
+    uLong check;                /* crc32 or adler32 of the chunk */
+    int err;                    /* Z_OK or error */
+} pz_job;
+
+typedef struct {
+    pz_job *job;
+    long count;
+    int level;
+    int strategy;
+    int gzip;
+    long next;                  /* next job to take */
+} pz_work;
+
+/* Compress one chunk into its own buffer as a raw deflate stream. */
+local void pz_run(pz_job *job, int level, int strategy, int gzip) {
+    z_stream strm;
+    uLong bound;
+    z_size_t stored;
+    int ret;
+
+    job->check = gzip ? crc32_z(0L, job->in, job->len) :
+                        adler32_z(1L, job->in, job->len);
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    job->err = deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS,
+                            DEF_MEM_LEVEL, strategy);
+    if (job->err != Z_OK)
+        return;
+    if (job->dict)
+        (void)deflateSetDictionary(&strm, job->in - job->dict, job->dict);
+
+    /* room for the worst case plus the empty stored block of the flush */
+    bound = deflateBound(&strm, (uLong)job->len) + 10;
+    job->out = (unsigned char *)malloc(bound);
+    if (job->out == NULL) {
+        job->err = Z_MEM_ERROR;
+        (void)deflateEnd(&strm);
+        return;
+    }
+    strm.next_in = (z_const Bytef *)job->in;
+    strm.avail_in = (uInt)job->len;
+    strm.next_out = job->out;
+    strm.avail_out = (uInt)bound;
+    ret = deflate(&strm, job->flush);
+    if (job->flush == Z_FINISH ? ret != Z_STREAM_END :
+        ret != Z_OK || strm.avail_in || strm.avail_out == 0)
+        job->err = Z_STREAM_ERROR;
+    job->have = bound - strm.avail_out;
+    (void)deflateEnd(&strm);
+
+    /* if deflate expanded the data, store it instead -- stored blocks end on
+       a byte boundary, so no sync marker is needed, and the result stays in
+       the part of compressBound() that belongs to this chunk */
+    stored = job->len + 5 * (job->len ? (job->len + 65534) / 65535 : 1);
+    if (job->err == Z_OK && job->have > stored) {
+        unsigned char *put = job->out;
+        const unsigned char *next = job->in;
+        z_size_t left = job->len;
+        unsigned n;
+
+        do {
+            n = left > 65535 ? 65535 : (unsigned)left;
+            left -= n;
+            *put++ = left == 0 && job->flush == Z_FINISH ? 1 : 0;
+            put[0] = (unsigned char)n;
+            put[1] = (unsigned char)(n >> 8);
+            put[2] = (unsigned char)~n;
+            put[3] = (unsigned char)(~n >> 8);
+            zmemcpy(put + 4, next, n);
+            put += 4 + n;
+            next += n;
+        } while (left);
+        job->have = (z_size_t)(put - job->out);
+    }
+}
+
+local void pz_worker(void *arg, int slot) {
+    long i;
+    pz_work *work = (pz_work *)arg;
+
+    (void)slot;
+    while ((i = Z_NEXT(work->next)) < work->count)
+        pz_run(&work->job[i], work->level, work->strategy, work->gzip);
+}
+
+/* Compress len bytes at in as raw deflate data, using threads threads, and
+   pass the compressed data to out() in order. The dict bytes before in are
+   used as the dictionary of the first chunk (at most 32K are used). If last
+   is true the data ends with the final block, otherwise it ends with a sync
+   flush so that more can follow. *check is updated with the crc32 (if gzip
+   is true) or adler32 of the input. Return Z_OK, or an error from deflate,
+   memory allocation, or out(). */
+int ZLIB_INTERNAL pz_deflate(const unsigned char *in, z_size_t len,
+                             unsigned dict, int level, int strategy, int last,
+                             int threads, int gzip, uLong *check,
+                             pz_out_func out, void *opaque) {
+    pz_work work;
+    long i;
+    int ret = Z_OK;
+
+    if (len == 0 && !last)
+        return Z_OK;
+    work.count = len ? (long)((len + PZ_CHUNK - 1) / PZ_CHUNK) : 1;
+    work.job = (pz_job *)calloc((size_t)work.count, sizeof(pz_job));
+    if (work.job == NULL)
+        return Z_MEM_ERROR;
+    work.level = level;
+    work.strategy = strategy;
+    work.gzip = gzip;
+    work.next = 0;
+
+    for (i = 0; i < work.count; i++) {
+        pz_job *job = &work.job[i];
+        job->in = in + (z_size_t)i * PZ_CHUNK;
+        job->len = len - (z_size_t)i * PZ_CHUNK < PZ_CHUNK ?
+                   len - (z_size_t)i * PZ_CHUNK : PZ_CHUNK;
+        job->dict = i ? PZ_DICT : (dict > PZ_DICT ? PZ_DICT : dict);
+        job->flush = last && i == work.count - 1 ? Z_FINISH : Z_SYNC_FLUSH;
+    }
+    if (threads > work.count)
+        threads = (int)work.count;
+    z_parallel(pz_worker, &work, threads);
+
+    /* write the chunks in order and join the check values */
+    for (i = 0; i < work.count; i++) {
+        pz_job *job = &work.job[i];
+        if (ret == Z_OK)
+            ret = job->err;
+        if (ret == Z_OK) {
+            *check = gzip ? crc32_combine64(*check, job->check,
+                                            (z_off64_t)job->len) :
+                            adler32_combine64(*check, job->check,
+                                              (z_off64_t)job->len);
+            ret = out(opaque, job->out, job->have);
+        }
+        free(job->out);
+    }
+    free(work.job);
+    return ret;
+}
+
+/* Write the ten-byte gzip header that deflate() would write for level and
+   strategy with no gz_header given, to buf. */
+void ZLIB_INTERNAL pz_gzheader(unsigned char *buf, int level, int strategy) {
+    buf[0] = 31;
+    buf[1] = 139;
+    buf[2] = 8;
+    buf[3] = 0;                 /* no flags */
+    buf[4] = buf[5] = buf[6] = buf[7] = 0;      /* no mtime */
+    buf[8] = level == 9 ? 2 :
+             (strategy >= Z_HUFFMAN_ONLY || (level >= 0 && level < 2) ?
+              4 : 0);
+    buf[9] = OS_CODE;
+}
+
+/* output into the destination buffer of compressParallel() */
+typedef struct {
+    Bytef *next;
+    uLong left;
+} pz_dest;
+
+local int pz_put(void *opaque, const unsigned char *buf, z_size_t len) {
+    pz_dest *dest = (pz_dest *)opaque;
+
+    if (len > dest->left)
+        return Z_BUF_ERROR;
+    zmemcpy(dest->next, buf, (uInt)len);
+    dest->next += len;
+    dest->left -= (uLong)len;
+    return Z_OK;
+}
+
+/* ========================================================================= */
+int ZEXPORT compressParallel(Bytef *dest, uLongf *destLen,
+                             const Bytef *source, uLong sourceLen, int level,
+                             int threads) {
+    pz_dest put;
+    uLong check = 1L;
+    unsigned header;
+    int ret;
+
+    if (level == Z_DEFAULT_COMPRESSION)
+        level = 6;
+    if (level < 0 || level > 9 || *destLen < 6)
+        return level < 0 || level > 9 ? Z_STREAM_ERROR : Z_BUF_ERROR;
+
+    /* zlib header, as deflate() writes it */
+    header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8;
+    header |= (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+    header += 31 - (header % 31);
+    dest[0] = (Bytef)(header >> 8);
+    dest[1] = (Bytef)header;
+    put.next = dest + 2;
+    put.left = *destLen - 6;
+
+    ret = pz_deflate(source, sourceLen, 0, level, Z_DEFAULT_STRATEGY, 1,
+                     threads, 0, &check, pz_put, &put);
+    if (ret != Z_OK) {
+        *destLen = 0;
+        return ret;
+    }
+
+    /* adler32 trailer, most significant byte first */
+    put.next[0] = (Bytef)(check >> 24);
+    put.next[1] = (Bytef)(check >> 16);
+    put.next[2] = (Bytef)(check >> 8);
+    put.next[3] = (Bytef)check;
+    *destLen = (uLong)(put.next + 4 - dest);
+    return Z_OK;
+}
@@ -0,0 +1,931 @@
+/* zbench.c -- throughput benchmark for the bundled zlib
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/*
+   zbench measures compression and decompression speed and ratio of deflate
+   at every level and strategy, the speed of crc32_z() and adler32_z(), and
+   of the gz* file functions, on a few synthetic corpora (text, image rows,
+   random bytes) and on any files given on the command line.  The synthetic
+   data is generated from a fixed seed, so runs are comparable between builds
+   on the same machine.  Each measurement takes the best of several runs.
+
+   With -v zbench does not time anything but checks inflate instead: every
+   corpus is deflated at windowBits 9 to 15 with a few levels and strategies,
+   then inflated in one call, in small pieces of input and output, and by the
+   reference decoder: inflate() given less output space than inflate_fast()
+   needs, so that it decodes everything in its own state machine.  All three
+   must give back the corpus.  This compares the wide inflate_fast() (see
+   inffast.h) with the reference.  Each corpus also goes through deflate and
+   inflate streams set up with deflateInitWorkspace() and
+   inflateInitWorkspace() in blocks of exactly the advertised size, which
+   must be enough at any alignment while one byte less is refused.  Pieces of
+   it are decompressed with inflateBatch() on one and on several threads,
+   where a corrupted piece and one with too little room must fail alone.
+   Last, it is written to a gzip file of three members in tmpdir, which is
+   indexed with gzindexbuild() and read at random offsets after gzseek().
+   The index is saved with gzindexsave() and loaded into a new gzFile with
+   gzindexload() to seek again, and must be refused once the last byte of
+   the file changes, and once the file is appended to.  zbench exits with 1
+   on any difference.
+
+   usage: zbench [-s MiB] [-r runs] [-l level] [-S strategy] [-t threads]
+                 [-d tmpdir] [-q] [-v] [file ...]
+
+     -s MiB       size of each synthetic corpus (default 8)
+     -r runs      runs per measurement, the fastest counts (default 3)
+     -l level     only this deflate level (default all, 0..9)
+     -S strategy  only this strategy: default, filtered, huffman, rle, fixed
+     -t threads   also time compressParallel() and gzsetthreads() on threads
+     -d tmpdir    directory for the gz* test files (default /tmp)
+     -q           skip the synthetic corpora, only use the given files
+     -v           verify inflate instead of timing (corpora of 256K unless -s)
+ */
+
+#include "zutil.h"
+#include "inffast.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const char *name;
+    unsigned char *data;
+    size_t len;
+} corpus;
+
+static const char *strategy_name[] = {
+    "default", "filtered", "huffman", "rle", "fixed"
+};
+static const int strategy_value[] = {
+    Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED
+};
+#define STRATEGIES 5
+
+static int runs = 3;
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *xmalloc(size_t size) {
+    void *p = malloc(size ? size : 1);
+
+    if (p == NULL) {
+        fprintf(stderr, "zbench: out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+/* deterministic generator, so every run sees the same corpora */
+static unsigned long long seed;
+
+static unsigned rnd(void) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(seed >> 33);
+}
+
+/* English-like text from a small vocabulary, with punctuation and lines */
+static void gen_text(unsigned char *buf, size_t len) {
+    static const char *word[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+        "as", "was", "with", "be", "by", "on", "not", "he", "this", "are",
+        "or", "his", "from", "at", "which", "but", "have", "an", "had",
+        "they", "you", "were", "their", "one", "all", "we", "can", "her",
+        "has", "there", "been", "if", "more", "when", "will", "would",
+        "who", "so", "no", "texture", "material", "shader", "buffer",
+        "vertex", "render", "pass", "scene", "node", "mesh", "compositor"
+    };
+    size_t n = 0, col = 0;
+
+    seed = 1;
+    while (n < len) {
+        const char *w = word[rnd() % (sizeof(word) / sizeof(word[0]))];
+        size_t k = strlen(w);
+
+        while (*w && n < len)
+            buf[n++] = (unsigned char)*w++;
+        col += k + 1;
+        if (n < len) {
+            unsigned r = rnd() % 16;
+            buf[n++] = col > 70 ? '\n' : r == 0 ? ',' : r == 1 ? '.' : ' ';
+            if (col > 70)
+                col = 0;
+        }
+    }
+}
+
+/* 1024-pixel RGBA rows of smooth gradients with a little noise, the kind of
+   data PNG and zip archives of textures feed to deflate */
+static void gen_image(unsigned char *buf, size_t len) {
+    size_t n;
+
+    seed = 2;
+    for (n = 0; n < len; n++) {
+        size_t px = (n >> 2) & 1023, row = n >> 12, ch = n & 3;
+        unsigned v = ch == 3 ? 255 :
+                     (unsigned)(px * (ch + 1) / 5 + row * (3 - ch) / 3);
+        buf[n] = (unsigned char)(v + (rnd() % 5) - 2);
+    }
+}
+
+/* runs of short periods, for the overlapping match copies of inflate_fast */
+static void gen_periodic(unsigned char *buf, size_t len) {
+    size_t n = 0;
+
+    seed = 4;
+    while (n < len) {
+        size_t period = 1 + rnd() % 24, run = rnd() % 2000, k;
+
+        for (k = 0; k < period && n + k < len; k++)
+            buf[n + k] = (unsigned char)rnd();
+        for (; k < run && n + k < len; k++)
+            buf[n + k] = buf[n + k - period];
+        n += k;
+    }
+}
+
+static void gen_random(unsigned char *buf, size_t len) {
+    size_t n;
+
+    seed = 3;
+    for (n = 0; n < len; n++)
+        buf[n] = (unsigned char)rnd();
+}
+
+static int load_file(corpus *c, const char *path) {
+    FILE *in;
+    long size;
+
+    in = fopen(path, "rb");
+    if (in == NULL || fseek(in, 0, SEEK_END) || (size = ftell(in)) < 0 ||
+            fseek(in, 0, SEEK_SET)) {
+        fprintf(stderr, "zbench: cannot read %s\n", path);
+        if (in != NULL)
+            fclose(in);
+        return -1;
+    }
+    c->name = path;
+    c->len = (size_t)size;
+    c->data = (unsigned char *)xmalloc(c->len);
+    if (fread(c->data, 1, c->len, in) != c->len) {
+        fprintf(stderr, "zbench: cannot read %s\n", path);
+        fclose(in);
+        free(c->data);
+        return -1;
+    }
+    fclose(in);
+    return 0;
+}
+
+static void report(const corpus *c, const char *test, const char *param,
+                   double secs, size_t in, size_t out) {
+    printf("%-12.12s %-16s %-12s %9.1f MB/s", c->name, test, param,
+           secs > 0 ? in / 1e6 / secs : 0.0);
+    if (out)
+        printf("  ratio %6.3f", (double)in / out);
+    putchar('\n');
+}
+
+/* plain byte-at-a-time table CRC, the reference for the crc32_z() speedup */
+static unsigned long crc_bytewise(unsigned long crc, const unsigned char *buf,
+                                  size_t len) {
+    const z_crc_t *table = get_crc_table();
+
+    crc = ~crc & 0xffffffff;
+    while (len--)
+        crc = table[(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+    return ~crc & 0xffffffff;
+}
+
+static void bench_checks(const corpus *c) {
+    int r;
+    double t, best;
+    unsigned long a = 0, b = 0, x = 0;
+
+    for (best = 1e9, r = 0; r < runs; r++) {
+        t = now();
+        a = crc32_z(0, c->data, c->len);
+        t = now() - t;
+        if (t < best) best = t;
+    }
+    report(c, "crc32_z", "", best, c->len, 0);
+
+    for (best = 1e9, r = 0; r < runs; r++) {
+        t = now();
+        b = crc_bytewise(0, c->data, c->len);
+        t = now() - t;
+        if (t < best) best = t;
+    }
+    report(c, "crc32 bytewise", "", best, c->len, 0);
+    if (a != b)
+        printf("zbench: crc32_z mismatch %08lx != %08lx\n", a, b);
+
+    for (best = 1e9, r = 0; r < runs; r++) {
+        t = now();
+        x = adler32_z(1, c->data, c->len);
+        t = now() - t;
+        if (t < best) best = t;
+    }
+    report(c, "adler32_z", "", best, c->len, 0);
+    (void)x;
+}
+
+/* deflate all of c into out as a zlib stream, return the compressed length */
+static size_t deflate_all(const corpus *c, unsigned char *out, size_t size,
+                          int level, int strategy) {
+    z_stream strm;
+    size_t len;
+
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, level, Z_DEFLATED, MAX_WBITS, 8, strategy) !=
+            Z_OK)
+        return 0;
+    strm.next_in = c->data;
+    strm.next_out = out;
+    len = c->len;
+    /* feed in pieces that fit in uInt */
+    do {
+        size_t in = len > 0x40000000 ? 0x40000000 : len;
+        strm.avail_in = (uInt)in;
+        strm.avail_out = (uInt)(size - strm.total_out > 0x40000000 ?
+                                0x40000000 : size - strm.total_out);
+        len -= in;
+        if (deflate(&strm, len ? Z_NO_FLUSH : Z_FINISH) == Z_STREAM_ERROR)
+            break;
+        len += strm.avail_in;
+    } while (len || strm.avail_in);
+    len = strm.total_out;
+    deflateEnd(&strm);
+    return len;
+}
+
+static int inflate_all(const unsigned char *in, size_t len,
+                       unsigned char *out, size_t size) {
+    z_stream strm;
+    int ret;
+
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit(&strm) != Z_OK)
+        return Z_MEM_ERROR;
+    strm.next_in = (z_const Bytef *)in;
+    strm.avail_in = (uInt)len;
+    strm.next_out = out;
+    strm.avail_out = (uInt)size;
+    ret = inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+    return ret == Z_STREAM_END && strm.total_out == size ? Z_OK : Z_DATA_ERROR;
+}
+
+static void bench_deflate(const corpus *c, int level, int strategy) {
+    int r;
+    double t, dbest, ibest;
+    size_t size = (size_t)compressBound((uLong)c->len), len = 0;
+    unsigned char *comp = (unsigned char *)xmalloc(size);
+    unsigned char *back = (unsigned char *)xmalloc(c->len);
+    char param[32];
+
+    for (dbest = ibest = 1e9, r = 0; r < runs; r++) {
+        t = now();
+        len = deflate_all(c, comp, size, level, strategy_value[strategy]);
+        t = now() - t;
+        if (t < dbest) dbest = t;
+        t = now();
+        if (inflate_all(comp, len, back, c->len) != Z_OK ||
+                memcmp(back, c->data, c->len)) {
+            printf("zbench: %s level %d %s did not round trip\n", c->name,
+                   level, strategy_name[strategy]);
+            break;
+        }
+        t = now() - t;
+        if (t < ibest) ibest = t;
+    }
+    sprintf(param, "%d %s", level, strategy_name[strategy]);
+    report(c, "deflate", param, dbest, c->len, len);
+    report(c, "inflate", param, ibest, c->len, 0);
+    free(back);
+    free(comp);
+}
+
+static void bench_parallel(const corpus *c, int threads) {
+    int r;
+    double t, best;
+    uLongf len = 0;
+    uLong size = compressBound((uLong)c->len);
+    unsigned char *comp = (unsigned char *)xmalloc(size);
+    unsigned char *back = (unsigned char *)xmalloc(c->len);
+    char param[32];
+
+    for (best = 1e9, r = 0; r < runs; r++) {
+        len = size;
+        t = now();
+        if (compressParallel(comp, &len, c->data, (uLong)c->len, 6,
+                             threads) != Z_OK) {
+            printf("zbench: compressParallel failed\n");
+            break;
+        }
+        t = now() - t;
+        if (inflate_all(comp, len, back, c->len) != Z_OK ||
+                memcmp(back, c->data, c->len)) {
+            printf("zbench: %s compressParallel x%d did not round trip\n",
+                   c->name, threads);
+            break;
+        }
+        if (t < best) best = t;
+    }
+    sprintf(param, "6 x%d", threads);
+    report(c, "compressParallel", param, best, c->len, len);
+    free(back);
+    free(comp);
+}
+
+static void bench_gz(const corpus *c, const char *path, int threads) {
+    static const char *rmode[] = {"rb", "rbm"};
+    int r, m;
+    double t, best;
+    size_t n, chunk = 65536, len = 0;
+    unsigned char *back = (unsigned char *)xmalloc(chunk);
+    gzFile gz;
+
+    for (best = 1e9, r = 0; r < runs; r++) {
+        t = now();
+        gz = gzopen(path, "wb6");
+        if (gz == NULL) {
+            printf("zbench: cannot write %s\n", path);
+            free(back);
+            return;
+        }
+        if (threads > 1)
+            gzsetthreads(gz, threads);
+        for (n = 0; n < c->len; n += chunk)
+            gzwrite(gz, c->data + n,
+                    (unsigned)(c->len - n < chunk ? c->len - n : chunk));
+        gzclose(gz);
+        t = now() - t;
+        if (t < best) best = t;
+    }
+    {
+        FILE *f = fopen(path, "rb");
+        if (f != NULL) {
+            fseek(f, 0, SEEK_END);
+            len = (size_t)ftell(f);
+            fclose(f);
+        }
+    }
+    report(c, "gzwrite", threads > 1 ? "6 threads" : "6", best, c->len, len);
+
+    for (m = 0; m < 2; m++) {
+        for (best = 1e9, r = 0; r < runs; r++) {
+            int got;
+
+            t = now();
+            gz = gzopen(path, rmode[m]);
+            if (gz == NULL)
+                break;
+            n = 0;
+            while ((got = gzread(gz, back, (unsigned)chunk)) > 0) {
+                if (memcmp(back, c->data + n, (size_t)got)) {
+                    printf("zbench: gzread mismatch\n");
+                    break;
+                }
+                n += (size_t)got;
+            }
+            gzclose(gz);
+            t = now() - t;
+            if (n != c->len)
+                printf("zbench: gzread got %lu of %lu bytes\n",
+                       (unsigned long)n, (unsigned long)c->len);
+            if (t < best) best = t;
+        }
+        report(c, "gzread", rmode[m], best, c->len, 0);
+    }
+    remove(path);
+    free(back);
+}
+
+/* inflate a zlib stream of windowBits wbits into out, size bytes, giving
+   inflate() at most inchunk bytes of input and outchunk bytes of output
+   space at a time (0 for all of it); step adds up to that many bytes to each
+   chunk, drawn from rnd() */
+static int inflate_pieces(const unsigned char *in, size_t len,
+                          unsigned char *out, size_t size, int wbits,
+                          size_t inchunk, size_t outchunk, unsigned step) {
+    z_stream strm;
+    size_t inpos = 0;
+    int ret = Z_OK;
+
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, wbits) != Z_OK)
+        return Z_MEM_ERROR;
+    strm.next_in = (z_const Bytef *)in;
+    strm.next_out = out;
+    while (ret == Z_OK) {
+        size_t i = inchunk ? inchunk + (step ? rnd() % step : 0) : len;
+        size_t o = outchunk ? outchunk + (step ? rnd() % step : 0) : size;
+
+        if (strm.avail_in == 0) {
+            if (i > len - inpos)
+                i = len - inpos;
+            strm.next_in = (z_const Bytef *)in + inpos;
+            strm.avail_in = (uInt)i;
+            inpos += i;
+        }
+        if (o > size - strm.total_out)
+            o = size - strm.total_out;
+        strm.avail_out = (uInt)o;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR && strm.avail_in == 0 && inpos < len)
+            ret = Z_OK;
+    }
+    inflateEnd(&strm);
+    return ret == Z_STREAM_END && strm.total_out == size ? Z_OK : Z_DATA_ERROR;
+}
+
+/* deflate c at windowBits 9..15 and check inflate against the reference
+   decoder, returns the number of failures */
+static int verify_inflate(const corpus *c) {
+    static const int level[] = {1, 6, 9};
+    static const int strategy[] = {0, 3, 4};    /* default, rle, fixed */
+    static const char *how[] = {"reference", "one call", "small pieces"};
+    size_t size = (size_t)compressBound((uLong)c->len), len;
+    unsigned char *comp = (unsigned char *)xmalloc(size);
+    unsigned char *back = (unsigned char *)xmalloc(c->len);
+    int wbits, l, s, k, ret, failed = 0;
+
+    for (wbits = 9; wbits <= 15; wbits++)
+        for (l = 0; l < 3; l++)
+            for (s = 0; s < 3; s++) {
+                z_stream strm;
+
+                memset(&strm, 0, sizeof(strm));
+                if (deflateInit2(&strm, level[l], Z_DEFLATED, wbits, 8,
+                                 strategy_value[strategy[s]]) != Z_OK) {
+                    printf("zbench: deflateInit2 failed\n");
+                    failed++;
+                    continue;
+                }
+                /* small windows and fixed codes can exceed compressBound() */
+                if (deflateBound(&strm, (uLong)c->len) > size) {
+                    size = deflateBound(&strm, (uLong)c->len);
+                    free(comp);
+                    comp = (unsigned char *)xmalloc(size);
+                }
+                strm.next_in = c->data;
+                strm.avail_in = (uInt)c->len;
+                strm.next_out = comp;
+                strm.avail_out = (uInt)size;
+                ret = deflate(&strm, Z_FINISH);
+                len = strm.total_out;
+                deflateEnd(&strm);
+                if (ret != Z_STREAM_END) {
+                    printf("zbench: deflate failed\n");
+                    failed++;
+                    continue;
+                }
+
+                seed = (unsigned long long)(wbits * 100 + l * 10 + s);
+                for (k = 0; k < 3; k++) {
+                    memset(back, 0, c->len);
+                    /* less than 258 bytes of output never reach
+                       inflate_fast(), the pieces reach it now and then */
+                    ret = k == 0 ? inflate_pieces(comp, len, back, c->len,
+                                                  wbits, 0, 257, 0) :
+                          k == 1 ? inflate_pieces(comp, len, back, c->len,
+                                                  wbits, 0, 0, 0) :
+                                   inflate_pieces(comp, len, back, c->len,
+                                                  wbits, 1,
+                                                  INFLATE_FAST_MIN_LEFT, 4096);
+                    if (ret != Z_OK || memcmp(back, c->data, c->len)) {
+                        printf("zbench: %s windowBits %d level %d %s: "
+                               "%s inflate differs\n", c->name, wbits,
+                               level[l], strategy_name[strategy[s]], how[k]);
+                        failed++;
+                    }
+                }
+            }
+    printf("%-12.12s inflate %s\n", c->name, failed ? "FAILED" : "ok");
+    free(back);
+    free(comp);
+    return failed;
+}
+
+/* set up deflate and inflate in caller-owned blocks of exactly the advertised
+   size at every alignment, check that one byte less is refused, and round
+   trip c through such streams, returns the number of failures */
+static int verify_workspace(const corpus *c) {
+    static const int memlevel[] = {1, 8, 9};
+    size_t size = (size_t)compressBound((uLong)c->len), len;
+    unsigned char *comp = (unsigned char *)xmalloc(size);
+    unsigned char *back = (unsigned char *)xmalloc(c->len);
+    unsigned char *block, *work;
+    uLong need;
+    int wbits, m, off, ret, failed = 0;
+
+    block = (unsigned char *)xmalloc(deflateWorkspaceSize(15, 9) +
+                                     inflateWorkspaceSize(15) + Z_WS_ALIGN);
+    for (wbits = 9; wbits <= 15; wbits++)
+        for (m = 0; m < 3; m++) {
+            z_stream strm;
+
+            need = deflateWorkspaceSize(wbits, memlevel[m]);
+            for (off = 0; off < Z_WS_ALIGN; off++) {
+                work = block + off;
+                memset(&strm, 0, sizeof(strm));
+                if (deflateInitWorkspace(&strm, 6, wbits, memlevel[m],
+                                         Z_DEFAULT_STRATEGY, work,
+                                         need - 1) != Z_MEM_ERROR) {
+                    printf("zbench: deflateInitWorkspace windowBits %d "
+                           "memLevel %d took %lu bytes\n", wbits,
+                           memlevel[m], need - 1);
+                    failed++;
+                }
+                memset(&strm, 0, sizeof(strm));
+                if (deflateInitWorkspace(&strm, 6, wbits, memlevel[m],
+                                         Z_DEFAULT_STRATEGY, work,
+                                         need) != Z_OK) {
+                    printf("zbench: deflateInitWorkspace windowBits %d "
+                           "memLevel %d refused %lu bytes\n", wbits,
+                           memlevel[m], need);
+                    failed++;
+                    continue;
+                }
+                if (off != (wbits + m) % Z_WS_ALIGN) {
+                    deflateEnd(&strm);
+                    continue;
+                }
+
+                /* one alignment per parameters compresses and inflates in
+                   a block of its own right after this one */
+                if (deflateBound(&strm, (uLong)c->len) > size) {
+                    size = deflateBound(&strm, (uLong)c->len);
+                    free(comp);
+                    comp = (unsigned char *)xmalloc(size);
+                }
+                strm.next_in = c->data;
+                strm.avail_in = (uInt)c->len;
+                strm.next_out = comp;
+                strm.avail_out = (uInt)size;
+                ret = deflate(&strm, Z_FINISH);
+                len = strm.total_out;
+                deflateEnd(&strm);
+                memset(&strm, 0, sizeof(strm));
+                work = block + off + need;
+                if (ret != Z_STREAM_END ||
+                        inflateInitWorkspace(&strm, wbits, work,
+                                             inflateWorkspaceSize(wbits)) !=
+                        Z_OK) {
+                    printf("zbench: windowBits %d memLevel %d workspace "
+                           "deflate failed\n", wbits, memlevel[m]);
+                    failed++;
+                    continue;
+                }
+                memset(back, 0, c->len);
+                strm.next_in = comp;
+                strm.avail_in = (uInt)len;
+                strm.next_out = back;
+                strm.avail_out = (uInt)c->len;
+                ret = inflate(&strm, Z_FINISH);
+                inflateEnd(&strm);
+                if (ret != Z_STREAM_END || strm.total_out != c->len ||
+                        memcmp(back, c->data, c->len)) {
+                    printf("zbench: windowBits %d memLevel %d workspace "
+                           "inflate differs\n", wbits, memlevel[m]);
+                    failed++;
+                }
+            }
+        }
+    for (wbits = 8; wbits <= 15; wbits++) {
+        z_stream strm;
+        int w = wbits == 8 ? 0 : wbits;     /* 0: window from the header */
+
+        need = inflateWorkspaceSize(w);
+        for (off = 0; off < Z_WS_ALIGN; off++) {
+            memset(&strm, 0, sizeof(strm));
+            if (inflateInitWorkspace(&strm, w, block + off, need - 1) !=
+                    Z_MEM_ERROR) {
+                printf("zbench: inflateInitWorkspace windowBits %d took "
+                       "%lu bytes\n", w, need - 1);
+                failed++;
+            }
+            memset(&strm, 0, sizeof(strm));
+            if (inflateInitWorkspace(&strm, w, block + off, need) != Z_OK) {
+                printf("zbench: inflateInitWorkspace windowBits %d refused "
+                       "%lu bytes\n", w, need);
+                failed++;
+            }
+            else
+                inflateEnd(&strm);
+        }
+    }
+    printf("%-12.12s workspace %s\n", c->name, failed ? "FAILED" : "ok");
+    free(block);
+    free(back);
+    free(comp);
+    return failed;
+}
+
+/* cut c into pieces compressed with compress2() and decompress them with
+   inflateBatch() on one and on several threads, with one piece corrupted and
+   one given too little room, which must fail alone with Z_DATA_ERROR and
+   Z_BUF_ERROR, returns the number of failures */
+#define PIECES 16
+static int verify_batch(const corpus *c) {
+    size_t piece = c->len / PIECES, bound = compressBound((uLong)piece);
+    unsigned char *comp = (unsigned char *)xmalloc(bound * PIECES);
+    unsigned char *back = (unsigned char *)xmalloc(c->len);
+    uLong len[PIECES];
+    z_inflate_item item[PIECES];
+    z_inflate_batch *batch;
+    int threads, bad, i, want, failed = 0;
+    long ret;
+
+    if (piece == 0)
+        return 0;
+    for (i = 0; i < PIECES; i++) {
+        len[i] = (uLong)bound;
+        if (compress2(comp + i * bound, len + i, c->data + i * piece,
+                      (uLong)piece, 6) != Z_OK) {
+            printf("zbench: compress2 failed\n");
+            failed++;
+        }
+    }
+    for (threads = 1; threads <= 4; threads += 3) {
+        batch = inflateBatchInit(15, threads);
+        if (batch == Z_NULL) {
+            printf("zbench: inflateBatchInit failed\n");
+            failed++;
+            continue;
+        }
+        for (bad = 0; bad < 2; bad++) {
+            memset(back, 0, c->len);
+            for (i = 0; i < PIECES; i++) {
+                item[i].source = comp + i * bound;
+                item[i].sourceLen = len[i];
+                item[i].dest = back + i * piece;
+                item[i].destLen = (uLong)piece;
+            }
+            if (bad) {
+                /* wrong adler32 trailer, and one byte short of room */
+                comp[5 * bound + len[5] - 1] ^= 1;
+                item[9].destLen--;
+            }
+            ret = inflateBatch(batch, item, PIECES);
+            if (bad)
+                comp[5 * bound + len[5] - 1] ^= 1;
+            if (ret != (bad ? 2 : 0)) {
+                printf("zbench: %s inflateBatch on %d thread(s) returned "
+                       "%ld\n", c->name, threads, ret);
+                failed++;
+            }
+            for (i = 0; i < PIECES; i++) {
+                want = bad && i == 5 ? Z_DATA_ERROR :
+                       bad && i == 9 ? Z_BUF_ERROR : Z_OK;
+                if (item[i].status != want || (want == Z_OK &&
+                        (item[i].sourceLen != len[i] ||
+                         item[i].destLen != (uLong)piece ||
+                         memcmp(back + i * piece, c->data + i * piece,
+                                piece)))) {
+                    printf("zbench: %s inflateBatch on %d thread(s) item %d: "
+                           "status %d, expected %d\n", c->name, threads, i,
+                           item[i].status, want);
+                    failed++;
+                }
+            }
+        }
+        inflateBatchEnd(batch);
+    }
+    printf("%-12.12s batch %s\n", c->name, failed ? "FAILED" : "ok");
+    free(back);
+    free(comp);
+    return failed;
+}
+
+/* seek to count random offsets of the gzip file of c, backwards and forwards,
+   and compare what is read there with c, returns the number of failures */
+static int seek_random(gzFile gz, const corpus *c, int count) {
+    unsigned char back[4096];
+    size_t pos, want;
+    int got, failed = 0;
+
+    while (count--) {
+        pos = (size_t)(((unsigned long long)rnd() << 16 ^ rnd()) %
+                       (c->len + 1));
+        want = rnd() % sizeof(back);
+        if (want > c->len - pos)
+            want = c->len - pos;
+        if (gzseek(gz, (z_off_t)pos, SEEK_SET) != (z_off_t)pos ||
+                (got = gzread(gz, back, (unsigned)sizeof(back))) < 0 ||
+                (size_t)got < want || memcmp(back, c->data + pos, want)) {
+            printf("zbench: %s gzseek to %lu differs\n", c->name,
+                   (unsigned long)pos);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+/* write c to path as three gzip members, index it with gzindexbuild(), seek
+   around in it, then save the index, load it into a new gzFile and seek
+   again, and check that the saved index is refused once the file changes,
+   returns the number of failures */
+static int verify_gzindex(const corpus *c, const char *path) {
+    static const char *wmode[] = {"wb6", "ab1", "ab9"};
+    char side[1040];
+    size_t from = 0, to;
+    int m, points = -1, failed = 0;
+    gzFile gz;
+
+    sprintf(side, "%.1000s.idx", path);
+    for (m = 0; m < 3; m++) {
+        to = c->len / 3 * (m + 1);
+        if (m == 2)
+            to = c->len;
+        gz = gzopen(path, wmode[m]);
+        if (gz == NULL) {
+            printf("zbench: cannot write %s\n", path);
+            return 1;
+        }
+        if (m == 2)
+            gzsetthreads(gz, 2);
+        if (to > from)
+            gzwrite(gz, c->data + from, (unsigned)(to - from));
+        if (gzclose(gz) != Z_OK)
+            failed++;
+        from = to;
+    }
+
+    seed = 5;
+    gz = gzopen(path, "rb");
+    if (gz != NULL) {
+        gzindex(gz, 32768);
+        points = gzindexbuild(gz);
+        if (points > 0) {
+            failed += seek_random(gz, c, 200);
+            if (gzindexsave(gz, side) != 0)
+                failed++;
+        }
+        gzclose(gz);
+    }
+    if (points <= 0) {
+        printf("zbench: %s gzindexbuild returned %d\n", c->name, points);
+        failed++;
+    }
+
+    gz = gzopen(path, "rbm");
+    if (gz != NULL) {
+        m = gzindexload(gz, side);
+        if (m != points) {
+            printf("zbench: %s gzindexload returned %d of %d points\n",
+                   c->name, m, points);
+            failed++;
+        }
+        failed += seek_random(gz, c, 200);
+        gzclose(gz);
+    }
+    else
+        failed++;
+
+    /* a changed trailer at the same length, then another member, make the
+       saved index stale */
+    for (m = 0; m < 2; m++) {
+        if (m == 0) {
+            FILE *f = fopen(path, "r+b");
+            int ch;
+
+            if (f == NULL || fseek(f, -1, SEEK_END) ||
+                    (ch = getc(f)) == EOF || fseek(f, -1, SEEK_END) ||
+                    putc(ch ^ 1, f) == EOF) {
+                printf("zbench: cannot change %s\n", path);
+                failed++;
+            }
+            if (f != NULL)
+                fclose(f);
+        }
+        else {
+            gz = gzopen(path, "ab");
+            if (gz != NULL) {
+                gzwrite(gz, "stale", 5);
+                gzclose(gz);
+            }
+        }
+        gz = gzopen(path, "rb");
+        if (gz == NULL || gzindexload(gz, side) != -1) {
+            printf("zbench: %s gzindexload took a stale index\n", c->name);
+            failed++;
+        }
+        if (gz != NULL)
+            gzclose(gz);
+    }
+    remove(side);
+    remove(path);
+    printf("%-12.12s gzindex %s\n", c->name, failed ? "FAILED" : "ok");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    int i, level, strategy, have = 0, quiet = 0, verify = 0, failed = 0;
+    int onlylevel = -1, onlystrategy = -1, threads = 0;
+    size_t size = 0;
+    const char *tmpdir = "/tmp";
+    char path[1024];
+    corpus *c;
+
+    c = (corpus *)xmalloc((argc + 4) * sizeof(corpus));
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && argv[i][1] && !argv[i][2] &&
+                strchr("srlStd", argv[i][1]) && i + 1 < argc) {
+            const char *arg = argv[++i];
+            switch (argv[i - 1][1]) {
+            case 's': size = (size_t)atol(arg) << 20; break;
+            case 'r': runs = atoi(arg) > 0 ? atoi(arg) : 1; break;
+            case 'l': onlylevel = atoi(arg); break;
+            case 't': threads = atoi(arg); break;
+            case 'd': tmpdir = arg; break;
+            case 'S':
+                for (strategy = 0; strategy < STRATEGIES; strategy++)
+                    if (strcmp(arg, strategy_name[strategy]) == 0)
+                        onlystrategy = strategy;
+                if (onlystrategy < 0) {
+                    fprintf(stderr, "zbench: unknown strategy %s\n", arg);
+                    return 1;
+                }
+                break;
+            }
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+            quiet = 1;
+        else if (strcmp(argv[i], "-v") == 0)
+            verify = 1;
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: zbench [-s MiB] [-r runs] [-l level] "
+                    "[-S strategy] [-t threads] [-d tmpdir] [-q] [-v] "
+                    "[file ...]\n");
+            return 1;
+        }
+        else if (load_file(&c[have], argv[i]) == 0)
+            have++;
+    }
+    if (size == 0)
+        size = verify ? 1 << 18 : 8 << 20;
+    if (!quiet) {
+        c[have].name = "text";
+        c[have].len = size;
+        c[have].data = (unsigned char *)xmalloc(size);
+        gen_text(c[have++].data, size);
+        c[have].name = "image";
+        c[have].len = size;
+        c[have].data = (unsigned char *)xmalloc(size);
+        gen_image(c[have++].data, size);
+        c[have].name = "random";
+        c[have].len = size;
+        c[have].data = (unsigned char *)xmalloc(size);
+        gen_random(c[have++].data, size);
+        if (verify) {
+            c[have].name = "periodic";
+            c[have].len = size;
+            c[have].data = (unsigned char *)xmalloc(size);
+            gen_periodic(c[have++].data, size);
+        }
+    }
+    sprintf(path, "%.1000s/zbench%d.gz", tmpdir, (int)(now() * 1000) % 100000);
+    if (verify) {
+#ifdef INFLATE_FAST_WIDE
+        printf("zlib %s, wide inflate_fast\n", zlibVersion());
+#else
+        printf("zlib %s, inflate_fast\n", zlibVersion());
+#endif
+        for (i = 0; i < have; i++) {
+            failed += verify_inflate(&c[i]);
+            failed += verify_workspace(&c[i]);
+            failed += verify_batch(&c[i]);
+            failed += verify_gzindex(&c[i], path);
+            free(c[i].data);
+        }
+        free(c);
+        return failed ? 1 : 0;
+    }
+    printf("zlib %s, %d run(s) per test, best run reported\n",
+           zlibVersion(), runs);
+    for (i = 0; i < have; i++) {
+        printf("\n%s: %lu bytes\n", c[i].name, (unsigned long)c[i].len);
+        bench_checks(&c[i]);
+        for (strategy = 0; strategy < STRATEGIES; strategy++) {
+            if (onlystrategy >= 0 && strategy != onlystrategy)
+                continue;
+            for (level = 0; level <= 9; level++)
+                if (onlylevel < 0 || level == onlylevel)
+                    bench_deflate(&c[i], level, strategy);
+        }
+        if (threads > 1)
+            bench_parallel(&c[i], threads);
+        bench_gz(&c[i], path, threads);
+        free(c[i].data);
+    }
+    free(c);
+    return 0;
+}
@@ -34,6 +34,7 @@
 #    define compress              z_compress
 #    define compress2             z_compress2
 #    define compressBound         z_compressBound
+#    define compressParallel      z_compressParallel
 #  endif
 #  define crc32                 z_crc32
 #  define crc32_combine         z_crc32_combine
@@ -50,6 +51,7 @@
 #  define deflateInit           z_deflateInit
 #  define deflateInit2          z_deflateInit2
 #  define deflateInit2_         z_deflateInit2_
+#  define deflateInitWorkspace  z_deflateInitWorkspace
 #  define deflateInit_          z_deflateInit_
 #  define deflateParams         z_deflateParams
 #  define deflatePending        z_deflatePending
@@ -59,6 +61,7 @@
 #  define deflateSetDictionary  z_deflateSetDictionary
 #  define deflateSetHeader      z_deflateSetHeader
 #  define deflateTune           z_deflateTune
+#  define deflateWorkspaceSize  z_deflateWorkspaceSize
 #  define deflate_copyright     z_deflate_copyright
 #  define get_crc_table         z_get_crc_table
 #  ifndef Z_SOLO
@@ -80,6 +83,10 @@
 #    define gzgetc                z_gzgetc
 #    define gzgetc_               z_gzgetc_
 #    define gzgets                z_gzgets
+#    define gzindex               z_gzindex
+#    define gzindexbuild          z_gzindexbuild
+#    define gzindexload           z_gzindexload
+#    define gzindexsave           z_gzindexsave
 #    define gzoffset              z_gzoffset
 #    define gzoffset64            z_gzoffset64
 #    define gzopen                z_gzopen
@@ -95,6 +102,7 @@
 #    define gzseek                z_gzseek
 #    define gzseek64              z_gzseek64
 #    define gzsetparams           z_gzsetparams
+#    define gzsetthreads          z_gzsetthreads
 #    define gztell                z_gztell
 #    define gztell64              z_gztell64
 #    define gzungetc              z_gzungetc
@@ -106,6 +114,9 @@
 #  define inflateBackEnd        z_inflateBackEnd
 #  define inflateBackInit       z_inflateBackInit
 #  define inflateBackInit_      z_inflateBackInit_
+#  define inflateBatch          z_inflateBatch
+#  define inflateBatchEnd       z_inflateBatchEnd
+#  define inflateBatchInit      z_inflateBatchInit
 #  define inflateCodesUsed      z_inflateCodesUsed
 #  define inflateCopy           z_inflateCopy
 #  define inflateEnd            z_inflateEnd
@@ -114,6 +125,7 @@
 #  define inflateInit           z_inflateInit
 #  define inflateInit2          z_inflateInit2
 #  define inflateInit2_         z_inflateInit2_
+#  define inflateInitWorkspace  z_inflateInitWorkspace
 #  define inflateInit_          z_inflateInit_
 #  define inflateMark           z_inflateMark
 #  define inflatePrime          z_inflatePrime
@@ -125,6 +137,7 @@
 #  define inflateSyncPoint      z_inflateSyncPoint
 #  define inflateUndermine      z_inflateUndermine
 #  define inflateValidate       z_inflateValidate
+#  define inflateWorkspaceSize  z_inflateWorkspaceSize
 #  define inflate_copyright     z_inflate_copyright
 #  define inflate_fast          z_inflate_fast
 #  define inflate_table         z_inflate_table
@@ -773,6 +773,35 @@ ZEXTERN uLong ZEXPORT deflateBound(z_streamp strm,
    than Z_FINISH or Z_NO_FLUSH are used.
 */
 
+ZEXTERN uLong ZEXPORT deflateWorkspaceSize(int windowBits,
+                                           int memLevel);
+ZEXTERN int ZEXPORT deflateInitWorkspace(z_streamp strm,
+                                         int level,
+                                         int windowBits,
+                                         int memLevel,
+                                         int strategy,
+                                         voidpf work,
+                                         uLong size);
+/*
+     deflateWorkspaceSize() returns the number of bytes of memory that a
+   deflate state for windowBits and memLevel needs when it is set up with
+   deflateInitWorkspace(), or 0 if the parameters are invalid, with the same
+   meaning of windowBits and memLevel as for deflateInit2().  The size allows
+   for any alignment of the block.
+
+     deflateInitWorkspace() is the same as deflateInit2() with the method
+   Z_DEFLATED, except that all of the state is taken from the size bytes at
+   work, which must stay valid until deflateEnd() is called and are not freed
+   by zlib.  zalloc, zfree and opaque are set by this call, and no other
+   memory is allocated for the stream.  A stream set up this way can be reset
+   and used again as any other, but it can not be copied with deflateCopy()
+   unless the destination provides its own zalloc and zfree.
+
+     deflateInitWorkspace() returns Z_OK if success, Z_MEM_ERROR if work is
+   Z_NULL or size is less than deflateWorkspaceSize() returns for the
+   parameters, or as deflateInit2() does otherwise.
+*/
+
 ZEXTERN int ZEXPORT deflatePending(z_streamp strm,
                                    unsigned *pending,
                                    int *bits);
@@ -885,6 +914,33 @@ ZEXTERN int ZEXPORT inflateInit2(z_streamp strm,
    deferred until inflate() is called.
 */
 
+ZEXTERN uLong ZEXPORT inflateWorkspaceSize(int windowBits);
+ZEXTERN int ZEXPORT inflateInitWorkspace(z_streamp strm,
+                                         int windowBits,
+                                         voidpf work,
+                                         uLong size);
+/*
+     inflateWorkspaceSize() returns the number of bytes of memory that an
+   inflate state for windowBits needs when it is set up with
+   inflateInitWorkspace(), including its window, or 0 if windowBits is
+   invalid.  windowBits has the same meaning as for inflateInit2(); if it is
+   zero, or asks for the window size of the zlib header to be used, room for a
+   32K window is included.
+
+     inflateInitWorkspace() is the same as inflateInit2(), except that all of
+   the state is taken from the size bytes at work, which must stay valid until
+   inflateEnd() is called and are not freed by zlib.  zalloc, zfree and opaque
+   are set by this call, and no other memory is allocated for the stream.  The
+   stream can be reset with inflateReset() or inflateReset2() and used again
+   as any other, but inflateReset2() must not ask for a larger window than
+   the block was sized for, or inflate() will return Z_MEM_ERROR when it
+   needs the window.
+
+     inflateInitWorkspace() returns Z_OK if success, Z_MEM_ERROR if work is
+   Z_NULL or size is less than inflateWorkspaceSize() returns for windowBits,
+   or as inflateInit2() does otherwise.
+*/
+
 ZEXTERN int ZEXPORT inflateSetDictionary(z_streamp strm,
                                          const Bytef *dictionary,
                                          uInt  dictLength);
@@ -1267,6 +1323,23 @@ ZEXTERN uLong ZEXPORT compressBound(uLong sourceLen);
    compress() or compress2() call to allocate the destination buffer.
 */
 
+ZEXTERN int ZEXPORT compressParallel(Bytef *dest,   uLongf *destLen,
+                                     const Bytef *source, uLong sourceLen,
+                                     int level, int threads);
+/*
+     Same as compress2(), but the source is cut into 128K chunks that are
+   compressed at the same time on up to threads threads (threads <= 1 uses
+   only the calling thread).  Each chunk is primed with the 32K of source
+   before it, so the result is only slightly larger than that of compress2().
+   The result is a valid zlib stream, but is not the same as the compress2()
+   output.  It does not depend on the number of threads.  Each chunk allocates
+   its own deflate state and output buffer while it is compressed.
+
+     compressParallel returns Z_OK if success, Z_MEM_ERROR if there was not
+   enough memory, Z_BUF_ERROR if there was not enough room in the output
+   buffer, Z_STREAM_ERROR if the level parameter is invalid.
+*/
+
 ZEXTERN int ZEXPORT uncompress(Bytef *dest,   uLongf *destLen,
                                const Bytef *source, uLong sourceLen);
 /*
@@ -1293,6 +1366,41 @@ ZEXTERN int ZEXPORT uncompress2(Bytef *dest,   uLongf *destLen,
    source bytes consumed.
 */
 
+typedef struct z_inflate_item_s {
+    const Bytef *source;    /* zlib (or as windowBits says) compressed data */
+    uLong sourceLen;        /* in: length of source, out: bytes used */
+    Bytef *dest;            /* where to put the decompressed data */
+    uLong destLen;          /* in: room at dest, out: bytes decompressed */
+    int status;             /* out: Z_OK or error, as from uncompress() */
+} z_inflate_item;
+
+typedef struct z_inflate_batch_s z_inflate_batch;
+
+ZEXTERN z_inflate_batch * ZEXPORT inflateBatchInit(int windowBits,
+                                                   int threads);
+ZEXTERN long ZEXPORT inflateBatch(z_inflate_batch *batch,
+                                  z_inflate_item *items, long count);
+ZEXTERN void ZEXPORT inflateBatchEnd(z_inflate_batch *batch);
+/*
+     Decompress many independent buffers without setting up an inflate state
+   for each of them.  inflateBatchInit() creates a context with threads
+   inflate states initialized by inflateInit2() with windowBits (15 for zlib
+   streams, as uncompress() expects, 15 + 32 to accept zlib or gzip, -15 for
+   raw deflate), or returns Z_NULL if there is not enough memory or windowBits
+   is invalid.  The context is kept for any number of inflateBatch() calls and
+   freed with inflateBatchEnd().
+
+     inflateBatch() decompresses each of the count items as uncompress2()
+   would, reusing the inflate states with inflateReset(), and sets the status,
+   sourceLen and destLen of every item.  If the context has more than one
+   state, the items are spread over that many threads (the calling thread and
+   threads - 1 started for the call) where threads are supported.  A context
+   must not be used by two inflateBatch() calls at the same time.
+
+     inflateBatch() returns the number of items whose status is not Z_OK, or
+   Z_STREAM_ERROR if batch or items is Z_NULL, or count is negative.
+*/
+
                         /* gzip file access functions */
 
 /*
@@ -1322,6 +1430,10 @@ ZEXTERN gzFile ZEXPORT gzopen(const char *path, const char *mode);
    "x" when writing will create the file exclusively, which fails if the file
    already exists.  On systems that support it, the addition of "e" when
    reading or writing will set the flag to close the file on an execve() call.
+   The addition of "m" when reading reads the input in 256K blocks instead of
+   8K (gzbuffer() can still change that), and where mmap() is available maps
+   the whole input file into memory, so that inflate consumes it in place.  A
+   mapped file must not be truncated while it is being read.
 
      These functions, as well as gzip, will read and decode a sequence of gzip
    streams in a file.  The append function of gzopen() can be used to create
@@ -1381,6 +1493,22 @@ ZEXTERN int ZEXPORT gzbuffer(gzFile file, unsigned size);
    too late.
 */
 
+ZEXTERN int ZEXPORT gzsetthreads(gzFile file, int threads);
+/*
+     Compress the data written to file with block-parallel deflate on up to
+   threads threads, or with the normal single deflate stream if threads is
+   zero (the default).  The written data is collected in batches of one 128K
+   chunk per thread, but of no less than 1M, and each chunk is compressed on
+   its own and primed with the 32K of data before it.  The output is a valid
+   gzip stream that any gzip reader can decompress.  gzflush() and
+   gzsetparams() compress what was collected so far.  This function must be
+   called after gzopen() or gzdopen() for writing, and before any other calls
+   that write the file.
+
+     gzsetthreads() returns 0 on success, or -1 on failure, such as the file
+   being open for reading, or being called too late.
+*/
+
 ZEXTERN int ZEXPORT gzsetparams(gzFile file, int level, int strategy);
 /*
      Dynamically update the compression level and strategy for file.  See the
@@ -1574,6 +1702,44 @@ ZEXTERN int ZEXPORT    gzrewind(gzFile file);
      gzrewind(file) is equivalent to (int)gzseek(file, 0L, SEEK_SET).
 */
 
+ZEXTERN int ZEXPORT gzindex(gzFile file, z_off_t span);
+/*
+     Collect access points while reading file, so that gzseek() can continue
+   decompressing from the closest access point before the requested offset,
+   instead of from the start of the file for a backward seek, or from the
+   current position for a long forward seek.  The points are placed at deflate
+   block boundaries at least span uncompressed bytes apart (span <= 0 selects
+   1M), and each holds 32K of history.  Points are added as new parts of the
+   file are decompressed, by reading or by seeking forward.  Calling gzindex()
+   on a file that already has an index only changes the span for new points.
+   The index is only used for gzip streams, not for transparent reading.
+
+     gzindex() returns 0 on success, or -1 if file is not open for reading or
+   there was not enough memory.
+*/
+
+ZEXTERN int ZEXPORT gzindexbuild(gzFile file);
+/*
+     Decompress the rest of file to complete its index, starting one with the
+   default span if gzindex() was not called, and then return to the current
+   position.  gzindexbuild() returns the number of access points, or -1 on
+   error, in which case gzerror() may tell what went wrong.
+*/
+
+ZEXTERN int ZEXPORT gzindexsave(gzFile file, const char *path);
+ZEXTERN int ZEXPORT gzindexload(gzFile file, const char *path);
+/*
+     Write the index of file to a sidecar file at path, or replace the index
+   of file with the one read from path.  The sidecar records the length and
+   the last eight bytes of the gzip file, and gzindexload() refuses a sidecar
+   that does not match file.  Loading an index before the first read lets a
+   later run seek at once without decompressing the file first.
+
+     gzindexsave() returns 0 on success, or -1 on error or if there is no
+   index.  gzindexload() returns the number of access points loaded, or -1 if
+   the sidecar could not be read, is damaged, or is for another file.
+*/
+
 /*
 ZEXTERN z_off_t ZEXPORT    gztell(gzFile file);
 
@@ -0,0 +1,102 @@
+/* zthread.c -- run a function on several threads at once
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/*
+   z_parallel() is the threading used by compressParallel(), gzsetthreads()
+   and inflateBatch(). The threads are started for each call and joined
+   before it returns. The work is shared through an index that the workers
+   take items from with Z_NEXT(), so it doesn't matter how many of the threads
+   could actually be started. Without thread support, or when none can be
+   started, all the work is done on the calling thread.
+ */
+
+#include "zutil.h"
+
+#if defined(_WIN32) && !defined(NO_Z_THREADS)
+#  include <windows.h>
+#  include <process.h>
+#  define Z_THREADS
+#elif defined(Z_HAVE_PTHREAD) && !defined(NO_Z_THREADS)
+#  include <pthread.h>
+#  define Z_THREADS
+#endif
+
+#ifdef Z_THREADS
+typedef struct {
+    void (*work)(void *, int);
+    void *arg;
+    int slot;
+} z_thread_arg;
+
+#  ifdef _WIN32
+local unsigned __stdcall z_thread(void *arg) {
+    z_thread_arg *t = (z_thread_arg *)arg;
+    t->work(t->arg, t->slot);
+    return 0;
+}
+#  else
+local void *z_thread(void *arg) {
+    z_thread_arg *t = (z_thread_arg *)arg;
+    t->work(t->arg, t->slot);
+    return NULL;
+}
+#  endif
+#endif
+
+/* ========================================================================= */
+void ZLIB_INTERNAL z_parallel(void (*work)(void *, int), void *arg,
+                              int threads) {
+#if defined(Z_THREADS) && defined(Z_NEXT_ATOMIC)
+    if (threads > 1) {
+        int started;
+        z_thread_arg *t;
+#  ifdef _WIN32
+        HANDLE *thread;
+#  else
+        pthread_t *thread;
+#  endif
+
+        t = (z_thread_arg *)malloc((threads - 1) * sizeof(z_thread_arg));
+#  ifdef _WIN32
+        thread = (HANDLE *)malloc((threads - 1) * sizeof(HANDLE));
+#  else
+        thread = (pthread_t *)malloc((threads - 1) * sizeof(pthread_t));
+#  endif
+        if (t != NULL && thread != NULL) {
+            for (started = 0; started < threads - 1; started++) {
+                t[started].work = work;
+                t[started].arg = arg;
+                t[started].slot = started + 1;
+#  ifdef _WIN32
+                thread[started] = (HANDLE)_beginthreadex(NULL, 0, z_thread,
+                                                         t + started, 0, NULL);
+                if (thread[started] == 0)
+                    break;
+#  else
+                if (pthread_create(&thread[started], NULL, z_thread,
+                                   t + started))
+                    break;
+#  endif
+            }
+            work(arg, 0);
+            while (started) {
+#  ifdef _WIN32
+                WaitForSingleObject(thread[--started], INFINITE);
+                CloseHandle(thread[started]);
+#  else
+                pthread_join(thread[--started], NULL);
+#  endif
+            }
+            free(thread);
+            free(t);
+            return;
+        }
+        free(thread);
+        free(t);
+    }
+#else
+    (void)threads;
+#endif
+    work(arg, 0);
+}
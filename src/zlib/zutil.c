@@ -24,6 +24,65 @@ z_const char * const z_errmsg[10] = {
 };
 
 
+#ifdef Z_X86_SIMD
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+#endif
+#if defined(Z_ARM_SIMD) && defined(__linux__)
+#  include <sys/auxv.h>
+#endif
+
+/* Return the Z_CPU_* features of this processor, these are checked once. A
+   race between threads only repeats the check with the same result. */
+int ZLIB_INTERNAL z_cpu_features(void) {
+    static volatile int features = -1;
+    int found = 0;
+
+    if (features >= 0)
+        return features;
+#if defined(Z_X86_SIMD) && defined(_MSC_VER)
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 1) {
+            int max = info[0];
+            __cpuid(info, 1);
+            if (info[2] & (1 << 1)) found |= Z_CPU_PCLMUL;
+            if (info[2] & (1 << 9)) found |= Z_CPU_SSSE3;
+            if ((info[2] & (1 << 27)) && max >= 7 &&
+                (_xgetbv(0) & 6) == 6) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5)) found |= Z_CPU_AVX2;
+            }
+        }
+    }
+#elif defined(Z_X86_SIMD)
+    {
+        unsigned eax, ebx, ecx, edx, max = __get_cpuid_max(0, 0);
+        if (max >= 1) {
+            __cpuid(1, eax, ebx, ecx, edx);
+            if (ecx & bit_PCLMUL) found |= Z_CPU_PCLMUL;
+            if (ecx & bit_SSSE3) found |= Z_CPU_SSSE3;
+            if ((ecx & bit_OSXSAVE) && max >= 7) {
+                unsigned xcr0;
+                __asm__ ("xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0));
+                __cpuid_count(7, 0, eax, ebx, ecx, edx);
+                if ((xcr0 & 6) == 6 && (ebx & (1 << 5)))
+                    found |= Z_CPU_AVX2;
+            }
+        }
+    }
+#elif defined(Z_ARM_SIMD) && defined(__linux__)
+    if (getauxval(AT_HWCAP) & (1 << 7))         /* HWCAP_CRC32 */
+        found |= Z_CPU_ARMCRC32;
+#endif
+    features = found;
+    return found;
+}
+
 const char * ZEXPORT zlibVersion(void) {
     return ZLIB_VERSION;
 }
@@ -297,3 +356,55 @@ void ZLIB_INTERNAL zcfree(voidpf opaque, voidpf ptr) {
 #endif /* MY_ZCALLOC */
 
 #endif /* !Z_SOLO */
+
+/* workspace allocator of deflateInitWorkspace() and inflateInitWorkspace() --
+   hands out aligned pieces of one caller-owned block, and can only take back
+   the last piece, which is enough for inflate to replace its window */
+
+local voidpf z_wsalloc(voidpf opaque, unsigned items, unsigned size) {
+    z_workspace *ws = (z_workspace *)opaque;
+    uLong len;
+
+    if (size && items > (uLong)-1 / size - Z_WS_ALIGN)
+        return Z_NULL;
+    len = Z_WS_ROUND((uLong)items * size);
+    if (len > ws->left)
+        return Z_NULL;
+    ws->last = ws->next;
+    ws->next += len;
+    ws->left -= len;
+    return (voidpf)ws->last;
+}
+
+local void z_wsfree(voidpf opaque, voidpf ptr) {
+    z_workspace *ws = (z_workspace *)opaque;
+
+    if (ptr != Z_NULL && (uchf *)ptr == ws->last) {
+        ws->left += (uLong)(ws->next - ws->last);
+        ws->next = ws->last;
+        ws->last = Z_NULL;
+    }
+}
+
+int ZLIB_INTERNAL z_wsinit(z_streamp strm, voidpf work, uLong size,
+                           uLong need) {
+    uchf *next;
+    z_workspace *ws;
+
+    if (strm == Z_NULL)
+        return Z_STREAM_ERROR;
+    if (work == Z_NULL || size < need)
+        return Z_MEM_ERROR;
+    next = (uchf *)work + ((Z_WS_ALIGN - ((z_size_t)work & (Z_WS_ALIGN - 1))) &
+                           (Z_WS_ALIGN - 1));
+    if (size < (uLong)(next - (uchf *)work) + Z_WS_ROUND(sizeof(z_workspace)))
+        return Z_MEM_ERROR;
+    ws = (z_workspace *)next;
+    ws->next = next + Z_WS_ROUND(sizeof(z_workspace));
+    ws->left = size - (uLong)(ws->next - (uchf *)work);
+    ws->last = Z_NULL;
+    strm->zalloc = z_wsalloc;
+    strm->zfree = z_wsfree;
+    strm->opaque = (voidpf)ws;
+    return Z_OK;
+}
@@ -242,6 +242,62 @@ extern z_const char * const z_errmsg[10]; /* indexed by 2-zlib_error */
    void ZLIB_INTERNAL zcfree(voidpf opaque, voidpf ptr);
 #endif
 
+/* SIMD code paths, selected at run time with z_cpu_features(). Define
+   NO_ZLIB_SIMD to build the portable code only. Z_TARGET() enables the
+   instructions for a single function, so no compiler flags are needed. */
+#ifndef NO_ZLIB_SIMD
+#  if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 || \
+      (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#    define Z_X86_SIMD
+#    define Z_TARGET(x) __attribute__((target(x)))
+#  elif defined(_M_X64) && defined(_MSC_VER) && _MSC_VER >= 1800
+#    define Z_X86_SIMD
+#    define Z_TARGET(x)
+#  elif defined(__aarch64__) || defined(_M_ARM64)
+#    define Z_ARM_SIMD          /* NEON is always there on aarch64 */
+#  endif
+#endif
+
+#define Z_CPU_PCLMUL    0x01    /* x86-64 carry-less multiplication */
+#define Z_CPU_SSSE3     0x02
+#define Z_CPU_AVX2      0x04    /* with the ymm state saved by the OS */
+#define Z_CPU_ARMCRC32  0x08    /* ARMv8 crc32 instructions */
+
+int ZLIB_INTERNAL z_cpu_features(void);
+
+/* Run work(arg, slot) on the calling thread with slot 0, and at the same time
+   on up to threads - 1 more threads with slots 1, 2, ... (zthread.c). The
+   workers share the work with Z_NEXT(), an atomic post-increment of a long. */
+void ZLIB_INTERNAL z_parallel(void (*work)(void *, int), void *arg,
+                              int threads);
+#if defined(__GNUC__)
+#  define Z_NEXT(x) __sync_fetch_and_add(&(x), 1)
+#  define Z_NEXT_ATOMIC
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define Z_NEXT(x) (_InterlockedIncrement(&(x)) - 1)
+#  define Z_NEXT_ATOMIC
+#else
+#  define Z_NEXT(x) ((x)++)     /* only used on one thread */
+#endif
+
+/* Caller-owned memory block that deflate or inflate state is carved from
+   (zutil.c). Z_WS_HEAD is the most that z_wsinit() takes for itself, and
+   each allocation takes Z_WS_ROUND() of its size. z_wsinit() refuses a block
+   of less than need bytes, the advertised size for the stream parameters. */
+typedef struct {
+    uchf *next;                 /* free space */
+    uLong left;                 /* bytes at next */
+    uchf *last;                 /* last piece handed out, or Z_NULL */
+} z_workspace;
+
+#define Z_WS_ALIGN 16
+#define Z_WS_ROUND(n) (((uLong)(n) + Z_WS_ALIGN - 1) & ~(uLong)(Z_WS_ALIGN - 1))
+#define Z_WS_HEAD (Z_WS_ALIGN - 1 + Z_WS_ROUND(sizeof(z_workspace)))
+
+int ZLIB_INTERNAL z_wsinit(z_streamp strm, voidpf work, uLong size,
+                           uLong need);
+
 #define ZALLOC(strm, items, size) \
            (*((strm)->zalloc))((strm)->opaque, (items), (size))
 #define ZFREE(strm, addr)  (*((strm)->zfree))((strm)->opaque, (voidpf)(addr))
@@ -0,0 +1,61 @@
+#ifndef __ZZIP_INTERNAL_ZSTD_H
+#define __ZZIP_INTERNAL_ZSTD_H
+#include <zzip/types.h>
+#include <zlib.h>
+
+/*
+ * DO NOT USE THIS CODE.
+ *
+ * It is an internal header file for zziplib that carries the decoder
+ * for zip method 93 (Zstandard) if the library was built with libzstd.
+ * The decoder is driven through the next_in/avail_in/next_out/avail_out
+ * fields of a z_stream so that it can share the inflate bookkeeping.
+ */
+
+#ifdef ZZIP_HAVE_ZSTD_H
+#include <zstd.h>
+#define USE_ZSTD 1
+
+#define _zzip_zstd_new()        ((void*) ZSTD_createDStream())
+#define _zzip_zstd_free(zs)     ZSTD_freeDStream((ZSTD_DStream*) (zs))
+#define _zzip_zstd_reset(zs) \
+        ZSTD_isError(ZSTD_DCtx_reset((ZSTD_DStream*) (zs), \
+                                     ZSTD_reset_session_only))
+
+/* returns Z_OK, Z_STREAM_END at the end of a frame without more input
+ * pending, Z_BUF_ERROR if nothing could be done or Z_DATA_ERROR */
+_zzip_inline static int
+_zzip_zstd_decode(void *zs, z_stream * z)
+{
+    ZSTD_inBuffer in;
+    ZSTD_outBuffer out;
+    size_t rv;
+
+    in.src = z->next_in; in.size = z->avail_in; in.pos = 0;
+    out.dst = z->next_out; out.size = z->avail_out; out.pos = 0;
+
+    rv = ZSTD_decompressStream((ZSTD_DStream*) zs, &out, &in);
+    if (ZSTD_isError(rv))
+        return Z_DATA_ERROR;
+
+    z->next_in += in.pos; z->avail_in -= in.pos; z->total_in += in.pos;
+    z->next_out += out.pos; z->avail_out -= out.pos; z->total_out += out.pos;
+
+    if (! rv && ! z->avail_in)
+        return Z_STREAM_END;
+    if (! in.pos && ! out.pos)
+        return Z_BUF_ERROR;
+    return Z_OK;
+}
+
+#else   /* disable */
+#define USE_ZSTD 0
+
+#define _zzip_zstd_new()        (0)
+#define _zzip_zstd_free(zs)     ((void) (zs))
+#define _zzip_zstd_reset(zs)    (1)
+#define _zzip_zstd_decode(zs, z) (Z_DATA_ERROR)
+
+#endif /* USE_ZSTD defines */
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * whole-file extraction from a zip archive - reading the compressed
+ * data of a member with a single io call and inflating it directly
+ * into the destination, optionally for a list of files on a number
+ * of threads.
+ *
+ *          use under the restrictions of the
+ *          Lesser GNU General Public License
+ *          or alternatively the restrictions
+ *          of the Mozilla Public License 1.1
+ */
+
+#include <zzip/lib.h>           /* exported... */
+#include <zzip/file.h>
+#include <zzip/plugin.h>
+#include <zzip/__zstd.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined _WIN32
+#include <windows.h>
+#include <process.h>
+#define ZZIP_EXTRACT_THREADS 1
+#elif defined ZZIP_HAVE_PTHREAD_H
+#include <pthread.h>
+#define ZZIP_EXTRACT_THREADS 1
+#endif
+
+#include <zzip/__debug.h>
+
+/* the index of the next list entry shared by the workers */
+#if defined __GNUC__
+#define zzip_extract_next(x) (__sync_fetch_and_add(&(x), 1))
+#elif defined _MSC_VER
+#include <intrin.h>
+#define zzip_extract_next(x) (_InterlockedIncrement(&(x)) - 1)
+#else
+#define zzip_extract_next(x) ((x)++)
+#undef ZZIP_EXTRACT_THREADS
+#endif
+
+/*
+ * the stored data is read straight into the buffer, for deflated data
+ * the compressed span comes from => zzip_file_map (mmapped or one read)
+ * and it is inflated with a single call into the buffer (zstd data may
+ * have multiple frames and needs one call per frame).
+ */
+static zzip_ssize_t
+zzip_file_extract(ZZIP_FILE * fp, void *buf, zzip_size_t len)
+{
+    _zzip_const void *data;
+    zzip_size_t size;
+    int err;
+
+    if (! fp->method)
+    {
+        zzip_ssize_t n = 0;
+        if (len > fp->usize)
+            len = fp->usize;
+        while ((zzip_size_t) n < len)
+        {
+            zzip_ssize_t i = zzip_file_read(fp, (char *) buf + n, len - n);
+            if (i < 0)
+                return -1;
+            if (i == 0)
+                break;
+            n += i;
+        }
+        return n;
+    }
+
+    if (! (data = zzip_file_map(fp, &size)))
+        return -1;
+
+    if (len > fp->usize)
+        len = fp->usize;
+    fp->d_stream.next_in = (Bytef *) data;
+    fp->d_stream.avail_in = size;
+    fp->d_stream.next_out = (Bytef *) buf;
+    fp->d_stream.avail_out = len;
+
+    if (fp->zstd)
+    {
+        do
+            err = _zzip_zstd_decode(fp->zstd, &fp->d_stream);
+        while (err == Z_OK && fp->d_stream.avail_out);
+    } else
+    {
+        err = inflate(&fp->d_stream, Z_FINISH);
+    }
+    zzip_file_unmap(fp);
+
+    if (err != Z_STREAM_END && ! (err == Z_BUF_ERROR &&
+                                  ! fp->d_stream.avail_out))
+    {
+        fp->dir->errcode = err == Z_BUF_ERROR ? ZZIP_CORRUPTED : err;
+        return -1;
+    }
+    return len - fp->d_stream.avail_out;
+}
+
+/**
+ * This function extracts a zip-contained file into the given buffer.
+ *
+ * It has the same result as => zzip_file_open and reading the file with
+ * => zzip_file_read into a buffer of at least the uncompressed size but
+ * it is faster for whole files - the compressed data is fetched with a
+ * single io call (or mmapped, see => zzip_file_map) and inflated
+ * directly into the buffer. The o_modes are used for the file lookup.
+ *
+ * It returns the number of bytes written, at most len. On error -1 is
+ * returned and the error code is left in the ZZIP_DIR.
+ */
+zzip_ssize_t
+zzip_dir_extract(ZZIP_DIR * dir, zzip_char_t * name, void *buf,
+                 zzip_size_t len, int o_modes)
+{
+    ZZIP_FILE *fp;
+    zzip_ssize_t rv;
+
+    if (! dir || ! name || ! buf)
+        return -1;
+
+    if (! (fp = zzip_file_open(dir, name, o_modes)))
+        return -1;
+
+    rv = zzip_file_extract(fp, buf, len);
+    zzip_file_close(fp);
+    return rv;
+}
+
+struct zzip_extract_work
+{
+    ZZIP_DIR *dir;
+    ZZIP_EXTRACT *list;
+    int count;
+    int o_modes;
+    long next;
+    long errors;
+};
+
+static void
+zzip_extract_worker(struct zzip_extract_work *work)
+{
+    long i;
+
+    while ((i = zzip_extract_next(work->next)) < work->count)
+    {
+        ZZIP_EXTRACT *item = &work->list[i];
+        item->result = zzip_dir_extract(work->dir, item->name, item->buf,
+                                        item->len, work->o_modes);
+        if (item->result < 0)
+            zzip_extract_next(work->errors);
+    }
+}
+
+#if defined _WIN32 && defined ZZIP_EXTRACT_THREADS
+static unsigned __stdcall
+zzip_extract_thread(void *work)
+{
+    zzip_extract_worker(work);
+    return 0;
+}
+#elif defined ZZIP_EXTRACT_THREADS
+static void *
+zzip_extract_thread(void *work)
+{
+    zzip_extract_worker(work);
+    return 0;
+}
+#endif
+
+/**
+ * This function extracts a list of zip-contained files, each one as with
+ * => zzip_dir_extract, where the result of each is stored with the entry.
+ *
+ * The work is shared by the calling thread and up to threads-1 worker
+ * threads that are started here and joined before it returns. The files
+ * are then opened with ZZIP_THREADED which needs the pread io handler;
+ * without it (or without thread support) the list is done sequentially.
+ *
+ * It returns the number of entries that failed, or -1 on bad arguments.
+ */
+int
+zzip_dir_extract_list(ZZIP_DIR * dir, ZZIP_EXTRACT * list, int count,
+                      int o_modes, int threads)
+{
+    struct zzip_extract_work work;
+
+    if (! dir || (count && ! list) || count < 0)
+        return -1;
+
+    memset(&work, 0, sizeof(work));
+    work.dir = dir;
+    work.list = list;
+    work.count = count;
+    work.o_modes = o_modes;
+
+    if (threads > count)
+        threads = count;
+    if (! dir->io->fd.pread)
+        threads = 1;
+
+#ifdef ZZIP_EXTRACT_THREADS
+    if (threads > 1)
+    {
+#  ifdef _WIN32
+        HANDLE *thread = malloc((threads - 1) * sizeof(*thread));
+#  else
+        pthread_t *thread = malloc((threads - 1) * sizeof(*thread));
+#  endif
+        if (thread)
+        {
+            int started;
+            work.o_modes |= ZZIP_THREADED;
+            for (started = 0; started < threads - 1; started++)
+            {
+#  ifdef _WIN32
+                thread[started] = (HANDLE)
+                    _beginthreadex(0, 0, zzip_extract_thread, &work, 0, 0);
+                if (! thread[started])
+                    break;
+#  else
+                if (pthread_create(&thread[started], 0,
+                                   zzip_extract_thread, &work))
+                    break;
+#  endif
+            }
+            HINT3("extract %i files on %i threads", count, started + 1);
+
+            zzip_extract_worker(&work);
+
+            while (started)
+            {
+#  ifdef _WIN32
+                WaitForSingleObject(thread[--started], INFINITE);
+                CloseHandle(thread[started]);
+#  else
+                pthread_join(thread[--started], 0);
+#  endif
+            }
+            free(thread);
+            return work.errors;
+        }
+    }
+#endif
+
+    zzip_extract_worker(&work);
+    return work.errors;
+}
+
+/*
+ * Local variables:
+ * c-file-style: "stroustrup"
+ * End:
+ */
@@ -324,6 +324,8 @@ extern void     __zzip_set64(zzip_byte_t * s, uint64_t v);
         ( ZZIP_IS_STORED ==   zzip_file_header_get_compr(__p) )
 #define zzip_file_header_data_deflated(__p) \
         ( ZZIP_IS_DEFLATED == zzip_file_header_get_compr(__p) )
+#define zzip_file_header_data_zstd(__p) \
+        ( ZZIP_IS_ZSTD == zzip_file_header_get_compr(__p) )
 
 #define zzip_disk_entry_data_encrypted(__p) \
         ZZIP_IS_ENCRYPTED( zzip_disk_entry_get_flags(__p) )
@@ -335,6 +337,8 @@ extern void     __zzip_set64(zzip_byte_t * s, uint64_t v);
         ( ZZIP_IS_STORED ==  zzip_disk_entry_get_compr(__p) )
 #define zzip_disk_entry_data_deflated(__p) \
         ( ZZIP_IS_DEFLATED ==  zzip_disk_entry_get_compr(__p) )
+#define zzip_disk_entry_data_zstd(__p) \
+        ( ZZIP_IS_ZSTD ==  zzip_disk_entry_get_compr(__p) )
 #define zzip_disk_entry_data_ascii(__p) \
         ( zzip_disk_entry_get_filetype(__p) & 1)
 
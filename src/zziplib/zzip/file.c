@@ -23,6 +23,8 @@
 
 #include <zzip/format.h>
 #include <zzip/fetch.h>
+#include <zzip/__mmap.h>
+#include <zzip/__zstd.h>
 #include <zzip/__debug.h>
 
 #if 0
@@ -35,6 +37,19 @@
 #define tells(fd) seeks(fd,0,SEEK_CUR)
 #endif
 
+/* ZZIP_THREADED handles may be opened and closed from different threads */
+#if defined __GNUC__
+#define zzip_refcount_inc(_dir_) __sync_add_and_fetch(&(_dir_)->refcount, 1)
+#define zzip_refcount_dec(_dir_) __sync_sub_and_fetch(&(_dir_)->refcount, 1)
+#elif defined _MSC_VER
+#include <intrin.h>
+#define zzip_refcount_inc(_dir_) _InterlockedIncrement(&(_dir_)->refcount)
+#define zzip_refcount_dec(_dir_) _InterlockedDecrement(&(_dir_)->refcount)
+#else
+#define zzip_refcount_inc(_dir_) (++(_dir_)->refcount)
+#define zzip_refcount_dec(_dir_) (--(_dir_)->refcount)
+#endif
+
 /**
  * the direct function of => zzip_close(fp). it will cleanup the
  * inflate-portion of => zlib and free the structure given.
@@ -49,37 +64,67 @@ zzip_file_close(ZZIP_FILE * fp)
 {
     auto int self;
     ZZIP_DIR *dir = fp->dir;
+    long refcount;
+    int pooled;
 
-    if (fp->method)
-        inflateEnd(&fp->d_stream);      /* inflateEnd() can be called many times */
+    if (fp->zstd)
+        { _zzip_zstd_free(fp->zstd); fp->zstd = 0; }
 
-    if (dir->cache.locked == NULL)
+    if (fp->checkpoints)
+        zzip_file_checkpoints(fp, 0);
+
+    if (fp->map)
+        zzip_file_unmap(fp);
+
+    /* threaded handles do never take part in the dir->cache */
+    if (! (fp->o_modes & ZZIP_THREADED) && dir->cache.locked == NULL)
         dir->cache.locked = &self;
 
-    if (fp->buf32k)
+    /* a pooled file keeps its buf32k and its inflate state for reuse */
+    pooled = dir->cache.locked == &self && dir->cache.count < dir->cache.size;
+
+    if (fp->inflated && ! pooled)
+        { inflateEnd(&fp->d_stream); fp->inflated = 0; }
+
+    if (fp->buf32k && ! pooled)
     {
         if (dir->cache.locked == &self && dir->cache.buf32k == NULL)
             dir->cache.buf32k = fp->buf32k;
         else
             free(fp->buf32k);
+        fp->buf32k = NULL;
     }
 
     if (dir->currentfp == fp)
         dir->currentfp = NULL;
 
-    dir->refcount--;
-    /* ease to notice possible dangling reference errors */
-    memset(fp, 0, sizeof(*fp));
+    refcount = zzip_refcount_dec(dir);
+
+    if (pooled)
+    {
+        z_stream d_stream = fp->d_stream;
+        char *buf32k = fp->buf32k;
+        int inflated = fp->inflated;
+
+        /* ease to notice possible dangling reference errors */
+        memset(fp, 0, sizeof(*fp));
+        fp->d_stream = d_stream;
+        fp->buf32k = buf32k;
+        fp->inflated = inflated;
 
-    if (dir->cache.locked == &self && dir->cache.fp == NULL)
+        fp->next = dir->cache.fp;
         dir->cache.fp = fp;
-    else
+        dir->cache.count++;
+    } else
+    {
+        memset(fp, 0, sizeof(*fp));
         free(fp);
+    }
 
     if (dir->cache.locked == &self)
         dir->cache.locked = NULL;
 
-    if (! dir->refcount)
+    if (! refcount)
         return zzip_dir_close(dir);
     else
         return 0;
@@ -166,7 +211,29 @@ dirsep_strcasecmp(zzip_char_t * s1, zzip_char_t * s2)
 }
 #endif
 
+/*
+ * the compressed data is fetched at the shared seek pointer of dir->fd
+ * unless the file was opened ZZIP_THREADED where we keep our own offset.
+ */
+static zzip_ssize_t
+zzip_file_fetch(ZZIP_FILE * fp, void *buf, zzip_size_t len)
+{
+    if (fp->o_modes & ZZIP_THREADED)
+    {
+        zzip_ssize_t rv =
+            fp->io->fd.pread(fp->dir->fd, buf, len, fp->offset);
+        if (rv > 0)
+            fp->offset += rv;
+        return rv;
+    }
+    return fp->io->fd.read(fp->dir->fd, buf, len);
+}
+
 static int zzip_inflate_init(ZZIP_FILE *, struct zzip_dir_hdr *);
+static void zzip_file_checkpoint(ZZIP_FILE *);
+static struct zzip_checkpoint *zzip_file_checkpoint_find(ZZIP_FILE *,
+                                                        zzip_off_t);
+static int zzip_file_restore(ZZIP_FILE *, struct zzip_checkpoint *);
 
 /**
  * open an => ZZIP_FILE from an already open => ZZIP_DIR handle. Since
@@ -176,6 +243,17 @@ static int zzip_inflate_init(ZZIP_FILE *, struct zzip_dir_hdr *);
  * Note: the zlib supports 2..15 bit windowsize, hence we provide a 32k
  *       memchunk here... just to be safe.
  *
+ * The name is looked up through the directory index that was built when
+ * the archive was opened, see => __zzip_dir_find.
+ *
+ * With ZZIP_THREADED in the o_mode the file keeps its own offset into the
+ * zip archive and reads through => pread(2) of the plugin io, so it does
+ * neither move nor depend on the shared seek pointer of the dir. Several
+ * threads may then open, read and close their own ZZIP_FILE handles from
+ * one ZZIP_DIR without locking, as long as all of these handles are opened
+ * threaded and the dir is closed only after them. If the plugin io has no
+ * pread then the flag is dropped and the file uses the shared fd.
+ *
  * On error it returns null and sets errcode in the ZZIP_DIR.
  */
 ZZIP_FILE *
@@ -197,112 +275,132 @@ zzip_file_open(ZZIP_DIR * dir, zzip_char_t * name, int o_mode)
         { dir->errcode = EBADF; return NULL; }
     if (! hdr)
         { dir->errcode = ENOENT; return NULL; }
+    if (! dir->io->fd.pread)
+        o_mode &= ~ZZIP_THREADED;
 
-    if (o_mode & ZZIP_NOPATHS)
-        name = filename_basename(name);
+    hdr = __zzip_dir_find(dir, name, filename_strcmp,
+                          (o_mode & ZZIP_NOPATHS) ? filename_basename : 0);
+    if (! hdr)
+        { dir->errcode = ZZIP_ENOENT; return NULL; }
+
+    HINT4("name='%s', compr=%d, size=%d\n",
+          hdr->d_name, hdr->d_compr, hdr->d_usize);
 
-    while (1)
+    switch (hdr->d_compr)
     {
-        register zzip_char_t *hdr_name = hdr->d_name;
+    case 0:            /* store */
+    case 8:            /* inflate */
+        break;
+    case 93:           /* zstd */
+        if (USE_ZSTD)
+            break;
+        /* fall through */
+    default:
+        { err = ZZIP_UNSUPP_COMPR; goto error; }
+    }
 
-        if (o_mode & ZZIP_NOPATHS)
-            hdr_name = filename_basename(hdr_name);
+    if (! (o_mode & ZZIP_THREADED) && dir->cache.locked == NULL)
+        dir->cache.locked = &self;
 
-        HINT4("name='%s', compr=%d, size=%d\n",
-              hdr->d_name, hdr->d_compr, hdr->d_usize);
+    if (dir->cache.locked == &self && dir->cache.fp)
+    {
+        fp = dir->cache.fp;
+        dir->cache.fp = fp->next;
+        dir->cache.count--;
+        fp->next = NULL;
+        /* memset(zfp, 0, sizeof *fp); cleared in zzip_file_close() */
+    } else
+    {
+        if (! (fp = (ZZIP_FILE *) calloc(1, sizeof(*fp))))
+            { err =  ZZIP_OUTOFMEM; goto error; }
+    }
 
-        if (! filename_strcmp(hdr_name, name))
-        {
-            switch (hdr->d_compr)
-            {
-            case 0:            /* store */
-            case 8:            /* inflate */
-                break;
-            default:
-                { err = ZZIP_UNSUPP_COMPR; goto error; }
-            }
+    fp->dir = dir;
+    fp->io = dir->io;
+    fp->o_modes = o_mode;
+    zzip_refcount_inc(dir);
 
-            if (dir->cache.locked == NULL)
-                dir->cache.locked = &self;
+    if (fp->buf32k)
+    {
+        /* from the dir->cache along with fp */
+    } else if (dir->cache.locked == &self && dir->cache.buf32k)
+    {
+        fp->buf32k = dir->cache.buf32k;
+        dir->cache.buf32k = NULL;
+    } else
+    {
+        if (! (fp->buf32k = (char *) malloc(ZZIP_32K)))
+            { err = ZZIP_OUTOFMEM; goto error; }
+    }
 
-            if (dir->cache.locked == &self && dir->cache.fp)
-            {
-                fp = dir->cache.fp;
-                dir->cache.fp = NULL;
-                /* memset(zfp, 0, sizeof *fp); cleared in zzip_file_close() */
-            } else
-            {
-                if (! (fp = (ZZIP_FILE *) calloc(1, sizeof(*fp))))
-                    { err =  ZZIP_OUTOFMEM; goto error; }
-            }
+    if (dir->cache.locked == &self)
+        dir->cache.locked = NULL;
 
-            fp->dir = dir;
-            fp->io = dir->io;
-            dir->refcount++;
+    if (o_mode & ZZIP_THREADED)
+    {
+        /* same as below, but the local header is read in place */
+        zzip_ssize_t dataoff;
+        struct zzip_file_header *p = (void *) fp->buf32k;
+
+        dataoff = dir->io->fd.pread(dir->fd, (void *) p, sizeof(*p),
+                                    hdr->d_off);
+        if (dataoff < (zzip_ssize_t) sizeof(*p))
+            { err = ZZIP_DIR_READ;  goto error; }
+        if (! zzip_file_header_check_magic(p))   /* PK\3\4 */
+            { err = ZZIP_CORRUPTED; goto error; }
+
+        fp->dataoffset = (zzip_off_t) hdr->d_off + sizeof(*p)
+            + zzip_file_header_sizeof_tail(p);
+        fp->offset = fp->dataoffset;
+        fp->usize = hdr->d_usize;
+        fp->csize = hdr->d_csize;
+        goto init;
+    }
 
-            if (dir->cache.locked == &self && dir->cache.buf32k)
-            {
-                fp->buf32k = dir->cache.buf32k;
-                dir->cache.buf32k = NULL;
-            } else
-            {
-                if (! (fp->buf32k = (char *) malloc(ZZIP_32K)))
-                    { err = ZZIP_OUTOFMEM; goto error; }
-            }
+    /*
+     * In order to support simultaneous open files in one zip archive
+     * we'll fix the fd offset when opening new file/changing which
+     * file to read...
+     */
 
-            if (dir->cache.locked == &self)
-                dir->cache.locked = NULL;
-            /*
-             * In order to support simultaneous open files in one zip archive
-             * we'll fix the fd offset when opening new file/changing which
-             * file to read...
-             */
+    if (zzip_file_saveoffset(dir->currentfp) < 0)
+        { err = ZZIP_DIR_SEEK; goto error; }
 
-            if (zzip_file_saveoffset(dir->currentfp) < 0)
-                { err = ZZIP_DIR_SEEK; goto error; }
+    fp->offset = hdr->d_off;
+    dir->currentfp = fp;
 
-            fp->offset = hdr->d_off;
-            dir->currentfp = fp;
+    if (dir->io->fd.seeks(dir->fd, hdr->d_off, SEEK_SET) < 0)
+        { err = ZZIP_DIR_SEEK; goto error; }
 
-            if (dir->io->fd.seeks(dir->fd, hdr->d_off, SEEK_SET) < 0)
-                { err = ZZIP_DIR_SEEK; goto error; }
+    {
+        /* skip local header - should test tons of other info,
+         * but trust that those are correct */
+        zzip_ssize_t dataoff;
+        struct zzip_file_header *p = (void *) fp->buf32k;
 
-            {
-                /* skip local header - should test tons of other info,
-                 * but trust that those are correct */
-                zzip_ssize_t dataoff;
-                struct zzip_file_header *p = (void *) fp->buf32k;
+        dataoff = dir->io->fd.read(dir->fd, (void *) p, sizeof(*p));
+        if (dataoff < (zzip_ssize_t) sizeof(*p))
+            { err = ZZIP_DIR_READ;  goto error; }
+        if (! zzip_file_header_check_magic(p))   /* PK\3\4 */
+            { err = ZZIP_CORRUPTED; goto error; }
 
-                dataoff = dir->io->fd.read(dir->fd, (void *) p, sizeof(*p));
-                if (dataoff < (zzip_ssize_t) sizeof(*p))
-                    { err = ZZIP_DIR_READ;  goto error; }
-                if (! zzip_file_header_check_magic(p))   /* PK\3\4 */
-                    { err = ZZIP_CORRUPTED; goto error; }
+        dataoff = zzip_file_header_sizeof_tail(p);
 
-                dataoff = zzip_file_header_sizeof_tail(p);
+        if (dir->io->fd.seeks(dir->fd, dataoff, SEEK_CUR) < 0)
+            { err = ZZIP_DIR_SEEK; goto error; }
 
-                if (dir->io->fd.seeks(dir->fd, dataoff, SEEK_CUR) < 0)
-                    { err = ZZIP_DIR_SEEK; goto error; }
+        fp->dataoffset = dir->io->fd.tells(dir->fd);
+        fp->usize = hdr->d_usize;
+        fp->csize = hdr->d_csize;
+    }
 
-                fp->dataoffset = dir->io->fd.tells(dir->fd);
-                fp->usize = hdr->d_usize;
-                fp->csize = hdr->d_csize;
-            }
+  init:
+    err = zzip_inflate_init(fp, hdr);
+    if (err)
+        goto error;
 
-            err = zzip_inflate_init(fp, hdr);
-            if (err)
-                goto error;
+    return fp;
 
-            return fp;
-        } else
-        {
-            if (hdr->d_reclen == 0)
-                break;
-            hdr = (struct zzip_dir_hdr *) ((char *) hdr + hdr->d_reclen);
-        }                       /*filename_strcmp */
-    }                           /*forever */
-    dir->errcode = ZZIP_ENOENT;
-    return NULL;
   error:
     if (fp)
         zzip_file_close(fp);
@@ -310,9 +408,92 @@ zzip_file_open(ZZIP_DIR * dir, zzip_char_t * name, int o_mode)
     return NULL;
 }
 
+struct zzip_prefetch
+{
+    zzip_off_t off;
+    zzip_off_t len;
+};
+
+static int
+zzip_prefetch_cmp(const void *a, const void *b)
+{
+    zzip_off_t x = ((const struct zzip_prefetch *) a)->off;
+    zzip_off_t y = ((const struct zzip_prefetch *) b)->off;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * This function tells the system that the given zip-contained files are
+ * going to be read soon, so that their data can be read ahead into the
+ * page cache while the caller does something else - e.g. a streaming
+ * thread can warm the cache for the threads that decode the files.
+ *
+ * The names are looked up like => zzip_file_open does with the o_modes,
+ * the compressed spans are sorted and neighbours merged before they are
+ * given to the io advise handler (posix_fadvise(2) WILLNEED by default).
+ * It does not wait for the data and does nothing if the io handlers have
+ * no advise function. Returns the number of names that were not found.
+ */
+int
+zzip_dir_prefetch(ZZIP_DIR * dir, zzip_char_t ** names, int count,
+                  int o_modes)
+{
+    int (*filename_strcmp) (zzip_char_t *, zzip_char_t *);
+    zzip_char_t* (*filename_basename)(zzip_char_t*);
+    struct zzip_prefetch *span;
+    int i, n = 0, missing = 0;
+
+    if (! dir || count < 0 || (count && ! names))
+        return -1;
+    if (! dir->io->fd.advise || ! count)
+        return 0;
+
+    filename_strcmp = (o_modes & ZZIP_CASELESS) ? dirsep_strcasecmp : strcmp;
+    filename_basename = (o_modes & ZZIP_CASELESS) ? dirsep_basename : strrchr_basename;
+
+    if (! (span = malloc(count * sizeof(*span))))
+        { dir->errcode = ZZIP_OUTOFMEM; return -1; }
+
+    for (i = 0; i < count; i++)
+    {
+        struct zzip_dir_hdr *hdr =
+            __zzip_dir_find(dir, names[i], filename_strcmp,
+                            (o_modes & ZZIP_NOPATHS) ? filename_basename : 0);
+        if (! hdr)
+            { missing++; continue; }
+
+        /* the local header with a guess for its extra field */
+        span[n].off = hdr->d_off;
+        span[n].len = sizeof(struct zzip_file_header) + hdr->d_namlen
+            + 512 + hdr->d_csize;
+        n++;
+    }
+
+    qsort(span, n, sizeof(*span), zzip_prefetch_cmp);
+
+    for (i = 0; i < n; i++)
+    {
+        zzip_off_t off = span[i].off;
+        zzip_off_t end = off + span[i].len;
+
+        while (i + 1 < n && span[i + 1].off <= end + ZZIP_32K)
+        {
+            i++;
+            if (end < span[i].off + span[i].len)
+                end = span[i].off + span[i].len;
+        }
+        HINT3("prefetch 0x%lx len=%li", (long) off, (long) (end - off));
+        dir->io->fd.advise(dir->fd, off, end - off);
+    }
+
+    free(span);
+    return missing;
+}
+
 /**
  *  call => inflateInit and setup fp's iterator variables,
- *  used by lowlevel => _open functions.
+ *  used by lowlevel => _open functions. On error the caller
+ *  closes fp.
  */
 static int
 zzip_inflate_init(ZZIP_FILE * fp, struct zzip_dir_hdr *hdr)
@@ -324,19 +505,31 @@ zzip_inflate_init(ZZIP_FILE * fp, struct zzip_dir_hdr *hdr)
 
     if (fp->method)
     {
-        memset(&fp->d_stream, 0, sizeof(fp->d_stream));
+        if (! fp->inflated)
+            memset(&fp->d_stream, 0, sizeof(fp->d_stream));
+        else
+            fp->d_stream.avail_in = 0;
 
-        err = inflateInit2(&fp->d_stream, -MAX_WBITS);
-        if (err != Z_OK)
-            goto error;
+        if (fp->method == ZZIP_IS_ZSTD)
+        {
+            if (! (fp->zstd = _zzip_zstd_new()))
+                return ZZIP_OUTOFMEM;
+        } else if (fp->inflated)
+        {                       /* from the dir->cache, keeps the window */
+            err = inflateReset2(&fp->d_stream, -MAX_WBITS);
+            if (err != Z_OK)
+                return err;
+        } else
+        {
+            err = inflateInit2(&fp->d_stream, -MAX_WBITS);
+            if (err != Z_OK)
+                return err;
+            fp->inflated = 1;
+        }
 
         fp->crestlen = hdr->d_csize;
     }
     return 0;
-  error:
-    if (fp)
-        zzip_file_close(fp);
-    return err;
 }
 
 /**
@@ -397,7 +590,7 @@ zzip_file_read(ZZIP_FILE * fp, void *buf, zzip_size_t len)
      * If this is other handle than previous, save current seek pointer
      * and read the file position of `this' handle.
      */
-    if (dir->currentfp != fp)
+    if (! (fp->o_modes & ZZIP_THREADED) && dir->currentfp != fp)
     {
         if (zzip_file_saveoffset(dir->currentfp) < 0
             || fp->io->fd.seeks(dir->fd, fp->offset, SEEK_SET) < 0)
@@ -406,8 +599,7 @@ zzip_file_read(ZZIP_FILE * fp, void *buf, zzip_size_t len)
             { dir->currentfp = fp; }
     }
 
-    /* if more methods is to be supported, change this to `switch ()' */
-    if (fp->method)             /* method != 0   == 8, inflate */
+    if (fp->method)             /* method == 8 inflate, or 93 zstd */
     {
         fp->d_stream.avail_out = l;
         fp->d_stream.next_out = (unsigned char *) buf;
@@ -424,7 +616,7 @@ zzip_file_read(ZZIP_FILE * fp, void *buf, zzip_size_t len)
                 /*  zzip_size_t cl =
                  *      fp->crestlen > 128 ? 128 : fp->crestlen;
                  */
-                zzip_ssize_t i = fp->io->fd.read(dir->fd, fp->buf32k, cl);
+                zzip_ssize_t i = zzip_file_fetch(fp, fp->buf32k, cl);
 
                 if (i <= 0)
                 {
@@ -438,7 +630,16 @@ zzip_file_read(ZZIP_FILE * fp, void *buf, zzip_size_t len)
             }
 
             startlen = fp->d_stream.total_out;
-            err = inflate(&fp->d_stream, Z_NO_FLUSH);
+            if (fp->zstd)
+            {                   /* more zstd frames may follow */
+                err = _zzip_zstd_decode(fp->zstd, &fp->d_stream);
+                if (err == Z_STREAM_END && fp->crestlen)
+                    err = Z_OK;
+            } else
+            {
+                err = inflate(&fp->d_stream,
+                              fp->checkpoints ? Z_BLOCK : Z_NO_FLUSH);
+            }
 
             if (err == Z_STREAM_END)
                 { fp->restlen = 0; }
@@ -446,13 +647,18 @@ zzip_file_read(ZZIP_FILE * fp, void *buf, zzip_size_t len)
                 { fp->restlen -= (fp->d_stream.total_out - startlen); }
             else
                 { dir->errcode = err; return -1; }
+
+            /* at a block boundary (but not after the last block) */
+            if (fp->checkpoints && (fp->d_stream.data_type & 128)
+                && ! (fp->d_stream.data_type & 64) && fp->restlen)
+                zzip_file_checkpoint(fp);
         }
         while (fp->restlen && fp->d_stream.avail_out);
 
         return l - fp->d_stream.avail_out;
     } else
     {                           /* method == 0 -- unstore */
-        rv = fp->io->fd.read(dir->fd, buf, l);
+        rv = zzip_file_fetch(fp, buf, l);
         if (rv > 0)
             { fp->restlen-= rv; }
         else if (rv < 0)
@@ -945,7 +1151,7 @@ zzip_rewind(ZZIP_FILE * fp)
     /*
      * If this is other handle than previous, save current seek pointer
      */
-    if (dir->currentfp != fp)
+    if (! (fp->o_modes & ZZIP_THREADED) && dir->currentfp != fp)
     {
         if (zzip_file_saveoffset(dir->currentfp) < 0)
             { dir->errcode = ZZIP_DIR_SEEK; return -1; }
@@ -954,7 +1160,8 @@ zzip_rewind(ZZIP_FILE * fp)
     }
 
     /* seek to beginning of this file */
-    if (fp->io->fd.seeks(dir->fd, fp->dataoffset, SEEK_SET) < 0)
+    if (! (fp->o_modes & ZZIP_THREADED) &&
+        fp->io->fd.seeks(dir->fd, fp->dataoffset, SEEK_SET) < 0)
         return -1;
 
     /* reset the inflate init stuff */
@@ -962,8 +1169,11 @@ zzip_rewind(ZZIP_FILE * fp)
     fp->offset = fp->dataoffset;
 
     if (fp->method)
-    {                           /* method == 8, deflate */
-        err = inflateReset(&fp->d_stream);
+    {                           /* method == 8 deflate, or 93 zstd */
+        if (fp->zstd)
+            err = _zzip_zstd_reset(fp->zstd) ? Z_DATA_ERROR : Z_OK;
+        else
+            err = inflateReset(&fp->d_stream);
         if (err != Z_OK)
             goto error;
 
@@ -1029,6 +1239,20 @@ zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence)
     if (rel_ofs == 0)
         return cur_pos;         /* don't have to move */
 
+    if (fp->checkpoints && cur_pos + rel_ofs >= 0 &&
+        cur_pos + rel_ofs <= (zzip_off_t) fp->usize)
+    {                           /* resume at the nearest checkpoint */
+        struct zzip_checkpoint *point =
+            zzip_file_checkpoint_find(fp, cur_pos + rel_ofs);
+        if (point && (rel_ofs < 0 || point->out > cur_pos))
+        {
+            if (zzip_file_restore(fp, point) == -1)
+                return -1;
+            rel_ofs = cur_pos + rel_ofs - point->out;
+            cur_pos = point->out;
+        }
+    }
+
     if (rel_ofs < 0)
     {                           /* convert backward into forward */
         if (zzip_rewind(fp) == -1)
@@ -1055,7 +1279,7 @@ zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence)
      * If this is other handle than previous, save current seek pointer
      * and read the file position of `this' handle.
      */
-    if (dir->currentfp != fp)
+    if (! (fp->o_modes & ZZIP_THREADED) && dir->currentfp != fp)
     {
         if (zzip_file_saveoffset(dir->currentfp) < 0
             || fp->io->fd.seeks(dir->fd, fp->offset, SEEK_SET) < 0)
@@ -1064,7 +1288,13 @@ zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence)
             { dir->currentfp = fp; }
     }
 
-    if (fp->method == 0)
+    if (fp->method == 0 && (fp->o_modes & ZZIP_THREADED))
+    {                           /* unstore, just move our own offset */
+        fp->offset += read_size;
+        ofs = fp->offset - fp->dataoffset;
+        fp->restlen = fp->usize - ofs;
+        return ofs;
+    } else if (fp->method == 0)
     {                           /* unstore, just lseek relatively */
         ofs = fp->io->fd.tells(dir->fd);
         ofs = fp->io->fd.seeks(dir->fd, read_size, SEEK_CUR);
@@ -1075,7 +1305,7 @@ zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence)
         }
         return ofs;
     } else
-    {                           /* method == 8, inflate */
+    {                           /* method == 8 inflate, or 93 zstd */
         char *buf;
 
         /*FIXME: use a static buffer! */
@@ -1103,6 +1333,284 @@ zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence)
     return zzip_tell(fp);
 }
 
+/* ------------------------------------------------------------------- */
+
+/**
+ * This function enables seek checkpoints on a deflated zip-contained file.
+ *
+ * Without them every backward => zzip_seek has to rewind and inflate the
+ * file from its start. With checkpoints the inflate state (the bit offset
+ * and 32K window at a deflate block boundary) is saved every span bytes
+ * of output while reading, and a later seek resumes at the nearest one
+ * before the target - backward as well as far forward. The points are
+ * only created lazily as the data is read through => zzip_file_read,
+ * each takes up about 32K of memory.
+ *
+ * A span of zero drops all checkpoints, otherwise the span is at least
+ * 32K. Only deflated files are affected, stored ones seek directly. Returns
+ * zero on success and -1 if the memory for the list is not available.
+ */
+int
+zzip_file_checkpoints(ZZIP_FILE * fp, zzip_size_t span)
+{
+    struct zzip_checkpoints *cp;
+
+    if (! fp || ! fp->dir)
+        return -1;
+
+    if (! span)
+    {
+        if ((cp = fp->checkpoints))
+        {
+            while (cp->count)
+                free(cp->point[--cp->count]);
+            free(cp->point);
+            free(cp);
+            fp->checkpoints = 0;
+        }
+        return 0;
+    }
+
+    if (fp->method != ZZIP_IS_DEFLATED)
+        return 0;
+
+    if (! fp->checkpoints &&
+        ! (fp->checkpoints = calloc(1, sizeof(*fp->checkpoints))))
+        return -1;
+
+    fp->checkpoints->span = span < ZZIP_32K ? ZZIP_32K : span;
+    return 0;
+}
+
+/*
+ * called from => zzip_file_read at deflate block boundaries to remember
+ * a resume point if we went beyond the span since the last one. Failing
+ * to allocate is not an error since the checkpoints are only a shortcut.
+ */
+static void
+zzip_file_checkpoint(ZZIP_FILE * fp)
+{
+    struct zzip_checkpoints *cp = fp->checkpoints;
+    struct zzip_checkpoint *point;
+    zzip_off_t out = fp->usize - fp->restlen;
+    zzip_off_t last = cp->count ? cp->point[cp->count - 1]->out : 0;
+
+    if (out < last + (zzip_off_t) cp->span)
+        return;
+
+    if (cp->count == cp->alloc)
+    {
+        int alloc = cp->alloc ? 2 * cp->alloc : 16;
+        struct zzip_checkpoint **list =
+            realloc(cp->point, alloc * sizeof(*list));
+        if (! list)
+            return;
+        cp->point = list;
+        cp->alloc = alloc;
+    }
+
+    if (! (point = malloc(sizeof(*point))))
+        return;
+
+    point->out = out;
+    point->in = fp->csize - fp->crestlen - fp->d_stream.avail_in;
+    point->bits = fp->d_stream.data_type & 7;
+    point->have = ZZIP_32K;
+    if (inflateGetDictionary(&fp->d_stream, point->window,
+                             &point->have) != Z_OK)
+        { free(point); return; }
+
+    cp->point[cp->count++] = point;
+}
+
+/*
+ * the checkpoint with the largest uncompressed offset not after target
+ */
+static struct zzip_checkpoint *
+zzip_file_checkpoint_find(ZZIP_FILE * fp, zzip_off_t target)
+{
+    struct zzip_checkpoints *cp = fp->checkpoints;
+    int lo = 0, hi = cp->count;
+
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (cp->point[mid]->out <= target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo ? cp->point[lo - 1] : 0;
+}
+
+/*
+ * like => zzip_rewind but resume the inflate stream at a checkpoint,
+ * the byte holding the leftover bits is fetched again for inflatePrime.
+ */
+static int
+zzip_file_restore(ZZIP_FILE * fp, struct zzip_checkpoint *point)
+{
+    ZZIP_DIR *dir = fp->dir;
+    zzip_off_t in = point->in - (point->bits ? 1 : 0);
+
+    if (! (fp->o_modes & ZZIP_THREADED) && dir->currentfp != fp)
+    {
+        if (zzip_file_saveoffset(dir->currentfp) < 0)
+            { dir->errcode = ZZIP_DIR_SEEK; return -1; }
+        else
+            { dir->currentfp = fp; }
+    }
+
+    if (fp->o_modes & ZZIP_THREADED)
+        fp->offset = fp->dataoffset + in;
+    else if (fp->io->fd.seeks(dir->fd, fp->dataoffset + in, SEEK_SET) < 0)
+        { dir->errcode = ZZIP_DIR_SEEK; return -1; }
+
+    if (inflateReset(&fp->d_stream) != Z_OK)
+        { dir->errcode = ZZIP_UNDEF; return -1; }
+    fp->d_stream.avail_in = 0;
+    fp->crestlen = fp->csize - in;
+
+    if (point->bits)
+    {
+        unsigned char c;
+        if (zzip_file_fetch(fp, &c, 1) != 1)
+            { dir->errcode = ZZIP_DIR_READ; return -1; }
+        fp->crestlen--;
+        if (inflatePrime(&fp->d_stream, point->bits,
+                         c >> (8 - point->bits)) != Z_OK)
+            { dir->errcode = ZZIP_UNDEF; return -1; }
+    }
+
+    if (inflateSetDictionary(&fp->d_stream, point->window,
+                             point->have) != Z_OK)
+        { dir->errcode = ZZIP_UNDEF; return -1; }
+
+    fp->restlen = fp->usize - point->out;
+    return 0;
+}
+
+/* ------------------------------------------------------------------- */
+
+/**
+ * This function returns a read-only view of the data of a zip-contained
+ * file, for a stored file that is its content and for a deflated file
+ * it is the raw compressed span (use => zzip_file_stat to see d_compr).
+ * The length in bytes is written to len.
+ *
+ * If the io handlers were set up with sys (see => zzip_init_io) and the
+ * system has => mmap(2) then the view points into a mapping of the
+ * archive and the data is not copied at all. Otherwise it is read into
+ * a => malloc(3)'ed block with a single call. Repeated calls return the
+ * same view, it is valid until => zzip_file_unmap or the file is closed.
+ * The read position of the file is not changed. On error null is
+ * returned and the error code is left in the ZZIP_DIR.
+ */
+_zzip_const void *
+zzip_file_map(ZZIP_FILE * fp, zzip_size_t * len)
+{
+    ZZIP_DIR *dir;
+    zzip_size_t size;
+
+    if (! fp || ! fp->dir)
+        return 0;
+
+    dir = fp->dir;
+    size = fp->method ? fp->csize : fp->usize;
+
+    if (! fp->map)
+    {
+        fp->mapsys = fp->io->fd.sys;
+        if (USE_MMAP && fp->mapsys && size)
+        {
+            zzip_off_t pagesize = _zzip_getpagesize(fp->mapsys);
+            zzip_byte_t *map;
+
+            fp->mapgap = fp->dataoffset & (pagesize - 1);
+            map = _zzip_mmap(fp->mapsys, dir->fd,
+                             fp->dataoffset - fp->mapgap,
+                             size + fp->mapgap);
+            if (map != MAP_FAILED)
+            {
+                fp->map = map;
+                fp->maplen = size + fp->mapgap;
+            } else
+            {
+                NOTE2("map failed: %s", strerror(errno));
+            }
+        }
+    }
+
+    if (! fp->map)
+    {                           /* fallback: read the span at once */
+        zzip_ssize_t n = 0;
+
+        if (! (fp->map = malloc(size + 1)))
+            { dir->errcode = ZZIP_OUTOFMEM; return 0; }
+        fp->maplen = size;
+        fp->mapgap = -1;
+
+        if (fp->io->fd.pread)
+        {
+            while ((zzip_size_t) n < size)
+            {
+                zzip_ssize_t i = fp->io->fd.pread(dir->fd, fp->map + n,
+                                                  size - n,
+                                                  fp->dataoffset + n);
+                if (i <= 0)
+                    break;
+                n += i;
+            }
+        } else if (zzip_file_saveoffset(dir->currentfp) < 0 ||
+                   fp->io->fd.seeks(dir->fd, fp->dataoffset, SEEK_SET) < 0)
+        {
+            n = -1;
+        } else
+        {                       /* the fd needs a seek before next read */
+            dir->currentfp = NULL;
+            while ((zzip_size_t) n < size)
+            {
+                zzip_ssize_t i = fp->io->fd.read(dir->fd, fp->map + n,
+                                                 size - n);
+                if (i <= 0)
+                    break;
+                n += i;
+            }
+        }
+
+        if (n < 0 || (zzip_size_t) n != size)
+        {
+            dir->errcode = ZZIP_DIR_READ;
+            zzip_file_unmap(fp);
+            return 0;
+        }
+    }
+
+    if (len)
+        *len = size;
+    return fp->mapgap < 0 ? fp->map : fp->map + fp->mapgap;
+}
+
+/** => zzip_file_map
+ * This function releases the view that was returned by => zzip_file_map,
+ * it is also done automatically when the file is closed.
+ */
+int
+zzip_file_unmap(ZZIP_FILE * fp)
+{
+    if (! fp || ! fp->map)
+        return 0;
+
+    if (fp->mapgap < 0)
+        free(fp->map);
+    else
+        _zzip_munmap(fp->mapsys, fp->map, fp->maplen);
+
+    fp->map = 0;
+    fp->maplen = 0;
+    return 0;
+}
+
 /**
  * This function will => tell(2) the current position in a real/zipped file
  *
@@ -53,6 +53,27 @@
 # define PATH_MAX 512
 # endif
 #endif
+/*
+ * a resume point for inflate, see => zzip_file_checkpoints - the bits
+ * and window are the state at a deflate block boundary (as with zran.c)
+ */
+struct zzip_checkpoint
+{
+    zzip_off_t out;    /* uncompressed offset */
+    zzip_off_t in;     /* compressed offset from dataoffset */
+    int bits;          /* unused bits in the byte before in, or zero */
+    unsigned have;     /* valid bytes in window */
+    unsigned char window[ZZIP_32K];
+};
+
+struct zzip_checkpoints
+{
+    zzip_size_t span;  /* min distance of uncompressed offsets */
+    int count;
+    int alloc;
+    struct zzip_checkpoint** point; /* ordered by out */
+};
+
 /*
  * ZZIP_FILE structure... currently no need to unionize, since structure needed
  * for inflate is superset of structure needed for unstore.
@@ -75,6 +96,15 @@ struct zzip_file
     zzip_off_t offset; /* offset from the start of zipfile... */
     z_stream d_stream;
     zzip_plugin_io_t io;
+    int o_modes; /* ZZIP_THREADED: io.pread at offset, dir->fd seek untouched */
+    struct zzip_checkpoints* checkpoints; /* for zzip_seek, or null */
+    zzip_byte_t* map;  /* => zzip_file_map view, mmapped or a malloc'd copy */
+    zzip_size_t maplen;
+    zzip_off_t mapgap; /* from the page start, or -1 for the malloc'd copy */
+    long mapsys;       /* io.sys for the zzip/__mmap.h wrappers */
+    void* zstd;        /* decoder for method 93, see zzip/__zstd.h */
+    int inflated;      /* d_stream is set up, kept in the dir->cache */
+    struct zzip_file* next; /* in the dir->cache */
 };
 
 #endif /* _ZZIP_FILE_H */
@@ -216,6 +216,7 @@ struct zzip_disk64_trailer
 #define ZZIP_IS_DEFLATED        8
 #define ZZIP_IS_DEFLATED_BETTER 9
 #define ZZIP_IS_IMPLODED_BETTER 10
+#define ZZIP_IS_ZSTD            93
 
 /* deflated comprlevel */
 #define ZZIP_DEFLATED_STD_COMPR 0
@@ -55,8 +55,10 @@ struct zzip_dir
     long refcount;
     struct { /* reduce a lot of alloc/deallocations by caching these: */
 	int * volatile locked;
-        struct zzip_file * volatile fp;  
+        struct zzip_file * volatile fp;  /* closed files, linked by ->next */
         char * volatile buf32k; 
+        int count;                       /* files in the fp list */
+        int size;                        /* => zzip_dir_cache_size */
     } cache;
     struct zzip_dir_hdr * hdr0;  /* zfi; */
     struct zzip_dir_hdr * hdr;   /* zdp; directory pointer, for dirent stuff */
@@ -66,10 +68,20 @@ struct zzip_dir
     char*  realname;
     zzip_strings_t* fileext;      /* list of fileext to test for */
     zzip_plugin_io_t io;          /* vtable for io routines */
+    struct zzip_dir_index* index; /* name hash over hdr0 (zip.c), or null */
+    zzip_char_t* indexfile;       /* => zzip_dir_open_indexed, or null */
+    char* indexmap;               /* sidecar that hdr0 and index are in */
+    zzip_size_t indexlen;
+    long indexsys;                /* mmapped with this io.sys, or malloc'd */
 }; 
 
 #define ZZIP_32K 32768
 
+/* closed files kept per dir with their buffer and inflate state */
+#ifndef ZZIP_CACHE_SIZE
+#define ZZIP_CACHE_SIZE 4
+#endif
+
 /* try to open a zip-basename with default_fileext */
 int      __zzip_try_open (zzip_char_t* filename, int filemode,
                           zzip_strings_t* ext, zzip_plugin_io_t io);
@@ -84,6 +96,12 @@ zzip_dir_fdopen_ext_io(int fd, zzip_error_t * errorcode_p,
 ZZIP_DIR* /*depracated*/
 zzip_dir_alloc_ext_io (zzip_strings_t* ext, const zzip_plugin_io_t io);
 
+/* find the first hdr matching name, basename!=0 is the ZZIP_NOPATHS mode */
+struct zzip_dir_hdr*
+__zzip_dir_find (ZZIP_DIR* dir, zzip_char_t* name,
+                 int (*cmp)(zzip_char_t*, zzip_char_t*),
+                 zzip_char_t* (*basename)(zzip_char_t*));
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,7 @@
 #include <zzip/mmapped.h>
 #include <zzip/memdisk.h>
 #include <zzip/__fnmatch.h>
+#include <zzip/__zstd.h>
 
 #define ___ {
 #define ____ }
@@ -66,10 +67,11 @@ typedef struct _zzip_extra_zip64
 
 /*forward*/
 
-static zzip__new__ ZZIP_MEM_ENTRY *
-zzip_mem_entry_new(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry);
 static void
-zzip_mem_entry_free(ZZIP_MEM_ENTRY * _zzip_restrict item);
+zzip_mem_entry_init(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry,
+                    ZZIP_MEM_ENTRY * item, char **pool);
+static zzip_size_t
+zzip_mem_entry_poolsize(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry);
 
 zzip__new__ ZZIP_MEM_DISK *
 zzip_mem_disk_new(void)
@@ -119,6 +121,32 @@ zzip_mem_disk_buffer(char *buffer, size_t buflen)
     ____;
 }
 
+/*
+ * The whole directory lives in one block: the entries as an array that
+ * is still chained through zz_next, the name hash (bucket heads and the
+ * per-entry chain, both as index+1) and a pool for the names, comments
+ * and extra blocks. So loading does two passes over the central
+ * directory and a single allocation, and => zzip_mem_disk_findfile with
+ * the default strcmp does not have to walk the list.
+ */
+struct _zzip_mem_disk_index
+{
+    zzip_size_t mask;           /* buckets - 1 */
+    int *head;                  /* [buckets] */
+    int *next;                  /* [count] */
+};
+
+#define ZZIP_MEM_ALIGN(_n_) (((_n_) + 7) & ~(zzip_size_t) 7)
+
+static zzip_size_t
+zzip_mem_disk_hash(const char *name)
+{
+    zzip_size_t h = 2166136261u;
+    for (; *name; name++)
+        h = (h ^ (unsigned char) *name) * 16777619u;
+    return h;
+}
+
 /** parse central dir.
  *  creates an internal copy of each entry converted to the local platform.
  *  returns: number of entries, or -1 on error (setting errno)
@@ -126,91 +154,152 @@ zzip_mem_disk_buffer(char *buffer, size_t buflen)
 long
 zzip_mem_disk_load(ZZIP_MEM_DISK * dir, ZZIP_DISK * disk)
 {
+    struct _zzip_mem_disk_index *index;
+    struct zzip_disk_entry *entry;
+    ZZIP_MEM_ENTRY *item;
+    zzip_size_t poolsize = 0, buckets = 16, size;
+    long count = 0, i;
+    char *block, *pool;
+
     if (! dir || ! disk)
         { errno=EINVAL; return -1; }
     if (dir->list)
         zzip_mem_disk_unload(dir);
-    ___ long count = 0;
-    ___ struct zzip_disk_entry *entry = zzip_disk_findfirst(disk);
+
+    entry = zzip_disk_findfirst(disk);
     for (; entry; entry = zzip_disk_findnext(disk, entry))
     {
-        ZZIP_MEM_ENTRY *item = zzip_mem_entry_new(disk, entry);
-        if (! item)
-            goto error;
-        if (dir->last)
-        {
-            dir->last->zz_next = item;  /* chain last */
-        } else
+        poolsize += zzip_mem_entry_poolsize(disk, entry);
+        count++;
+    }
+    while (buckets < (zzip_size_t) count)
+        buckets <<= 1;
+
+    size = ZZIP_MEM_ALIGN(sizeof(*index))
+        + ZZIP_MEM_ALIGN(count * sizeof(*item))
+        + ZZIP_MEM_ALIGN((buckets + count) * sizeof(int)) + poolsize;
+    if (! (block = calloc(1, size)))
+        return -1;              /* errno=ENOMEM; */
+
+    index = (void *) block;
+    item = (void *) (block + ZZIP_MEM_ALIGN(sizeof(*index)));
+    index->mask = buckets - 1;
+    index->head = (int *) ((char *) item
+                           + ZZIP_MEM_ALIGN(count * sizeof(*item)));
+    index->next = index->head + buckets;
+    pool = (char *) index->head
+        + ZZIP_MEM_ALIGN((buckets + count) * sizeof(int));
+
+    entry = zzip_disk_findfirst(disk);
+    for (i = 0; i < count; i++, entry = zzip_disk_findnext(disk, entry))
+    {
+        zzip_mem_entry_init(disk, entry, &item[i], &pool);
+        item[i].zz_next = (i + 1 < count) ? &item[i + 1] : 0;
+    }
+
+    /* push in reverse so that each chain is in directory order */
+    for (i = count; i--;)
+    {
+        if (item[i].zz_name)
         {
-            dir->list = item;
+            zzip_size_t h = zzip_mem_disk_hash(item[i].zz_name) & index->mask;
+            index->next[i] = index->head[h];
+            index->head[h] = i + 1;
         }
-        dir->last = item;       /* to earlier */
-        count++;
     }
-    ____;
+
+    dir->index = index;
+    dir->list = count ? item : 0;
+    dir->last = count ? &item[count - 1] : 0;
     dir->disk = disk;
     return count;
-    ____;
-  error:
-    zzip_mem_disk_unload(dir);
-    return -1;
+}
+
+/*
+ * the bytes that => zzip_mem_entry_init takes from the pool for the
+ * entry, with the same checks against the disk buffer as it does.
+ */
+static zzip_size_t
+zzip_mem_entry_poolsize(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry)
+{
+    struct zzip_file_header *header =
+        zzip_disk_entry_to_file_header(disk, entry);
+    zzip_size_t size = 0;
+
+    size += ZZIP_MEM_ALIGN(zzip_disk_entry_namlen(entry) + 1);
+    if (header)
+    {
+        size += ZZIP_MEM_ALIGN(zzip_file_header_namlen(header) + 1);
+        size += ZZIP_MEM_ALIGN(zzip_file_header_get_extras(header) + 2);
+    }
+    size += ZZIP_MEM_ALIGN(zzip_disk_entry_comment(entry) + 1);
+    size += ZZIP_MEM_ALIGN(zzip_disk_entry_get_extras(entry) + 2);
+    return size;
+}
+
+static char *
+zzip_mem_entry_pool_copy(ZZIP_DISK * disk, char **pool,
+                         char *data, zzip_size_t len, int zeros)
+{
+    char *copy = *pool;
+    if ((zzip_byte_t *) data < disk->buffer ||
+        (zzip_byte_t *) data + len > disk->endbuf)
+        return 0;
+    memcpy(copy, data, len);
+    memset(copy + len, 0, zeros);
+    *pool += ZZIP_MEM_ALIGN(len + zeros);
+    return copy;
 }
 
 /** convert a zip disk entry to internal format.
- * creates a new item parsing the information out of the various places
- * in the zip archive. This is a good place to extend functionality if
- * you have a project with extra requirements as you can push more bits
- * right into the diskdir_entry for later usage in higher layers.
- * returns: new item, or null on error (setting errno)
+ * fills the item parsing the information out of the various places
+ * in the zip archive, the strings and extra blocks are copied to the
+ * pool. This is a good place to extend functionality if you have a
+ * project with extra requirements as you can push more bits right
+ * into the diskdir_entry for later usage in higher layers.
  */
-zzip__new__ ZZIP_MEM_ENTRY *
-zzip_mem_entry_new(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry)
+static void
+zzip_mem_entry_init(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry,
+                    ZZIP_MEM_ENTRY * item, char **pool)
 {
-    if (! disk || ! entry)
-        { errno=EINVAL; return 0; }
-    ___ ZZIP_MEM_ENTRY *item = calloc(1, sizeof(*item));
-    if (! item)
-        return 0;               /* errno=ENOMEM; */
-    ___ struct zzip_file_header *header =
+    struct zzip_file_header *header =
         zzip_disk_entry_to_file_header(disk, entry);
     /*  there is a number of duplicated information in the file header
      *  or the disk entry block. Theoretically some part may be missing
      *  that exists in the other, ... but we will prefer the disk entry.
      */
-    item->zz_comment = zzip_disk_entry_strdup_comment(disk, entry);
-    item->zz_name = zzip_disk_entry_strdup_name(disk, entry);
-    item->zz_data = zzip_file_header_to_data(header);
+    if (zzip_disk_entry_comment(entry))
+        item->zz_comment = zzip_mem_entry_pool_copy(disk, pool,
+            zzip_disk_entry_to_comment(entry),
+            zzip_disk_entry_comment(entry), 1);
+    if (zzip_disk_entry_namlen(entry))
+        item->zz_name = zzip_mem_entry_pool_copy(disk, pool,
+            zzip_disk_entry_to_filename(entry),
+            zzip_disk_entry_namlen(entry), 1);
+    else if (header && zzip_file_header_namlen(header))
+        item->zz_name = zzip_mem_entry_pool_copy(disk, pool,
+            zzip_file_header_to_filename(header),
+            zzip_file_header_namlen(header), 1);
+    item->zz_data = header ? zzip_file_header_to_data(header) : 0;
     item->zz_flags = zzip_disk_entry_get_flags(entry);
     item->zz_compr = zzip_disk_entry_get_compr(entry);
     item->zz_mktime = zzip_disk_entry_get_mktime(entry);
     item->zz_crc32 = zzip_disk_entry_get_crc32(entry);
     item->zz_csize = zzip_disk_entry_get_csize(entry);
     item->zz_usize = zzip_disk_entry_get_usize(entry);
+    item->zz_offset = zzip_disk_entry_get_offset(entry);
     item->zz_diskstart = zzip_disk_entry_get_diskstart(entry);
     item->zz_filetype = zzip_disk_entry_get_filetype(entry);
 
     {                           /* copy the extra blocks to memory as well */
-        int /*            */ ext1 = zzip_disk_entry_get_extras(entry);
-        char *_zzip_restrict ptr1 = zzip_disk_entry_to_extras(entry);
-        int /*            */ ext2 = zzip_file_header_get_extras(header);
-        char *_zzip_restrict ptr2 = zzip_file_header_to_extras(header);
-
+        int ext1 = zzip_disk_entry_get_extras(entry);
         if (ext1)
-        {
-            void *mem = malloc(ext1 + 2);
-            item->zz_ext[1] = mem;
-            memcpy(mem, ptr1, ext1);
-            ((char *) (mem))[ext1 + 0] = 0;
-            ((char *) (mem))[ext1 + 1] = 0;
-        }
-        if (ext2)
-        {
-            void *mem = malloc(ext2 + 2);
-            item->zz_ext[2] = mem;
-            memcpy(mem, ptr2, ext2);
-            ((char *) (mem))[ext2 + 0] = 0;
-            ((char *) (mem))[ext2 + 1] = 0;
-        }
+            item->zz_ext[1] = (void *) zzip_mem_entry_pool_copy(disk, pool,
+                zzip_disk_entry_to_extras(entry), ext1, 2);
+        if (header && zzip_file_header_get_extras(header))
+            item->zz_ext[2] = (void *) zzip_mem_entry_pool_copy(disk, pool,
+                zzip_file_header_to_extras(header),
+                zzip_file_header_get_extras(header), 2);
     }
     {
         /* override sizes/offsets with zip64 values for largefile support */
@@ -228,9 +317,6 @@ zzip_mem_entry_new(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry)
      * All information from the central directory entry is now in memory.
      * Effectivly that allows us to modify it and write it back to disk.
      */
-    return item;
-    ____;
-    ____;
 }
 
 /* find an extra block for the given datatype code.
@@ -264,32 +350,13 @@ zzip_mem_entry_extra_block(ZZIP_MEM_ENTRY * entry, short datatype)
     }
 }
 
-void
-zzip_mem_entry_free(ZZIP_MEM_ENTRY * _zzip_restrict item)
-{
-    if (item)
-    {
-	/* *INDENT-OFF* */
-	if (item->zz_ext[0]) free (item->zz_ext[0]);
-	if (item->zz_ext[1]) free (item->zz_ext[1]);
-	if (item->zz_ext[2]) free (item->zz_ext[2]);
-	if (item->zz_comment) free (item->zz_comment);
-	if (item->zz_name) free (item->zz_name);
-	free (item);
-	/* *INDENT-ON* */
-    }
-}
-
 void
 zzip_mem_disk_unload(ZZIP_MEM_DISK * dir)
 {
-    ZZIP_MEM_ENTRY *item = dir->list;
-    while (item)
-    {
-        ZZIP_MEM_ENTRY *next = item->zz_next;
-        zzip_mem_entry_free(item);
-        item = next;
-    }
+    /* the entries and the pool are in the block of the index */
+    if (dir->index)
+        free(dir->index);
+    dir->index = 0;
     dir->list = dir->last = 0;
     zzip_disk_close(dir->disk);
     dir->disk = 0;
@@ -362,6 +429,20 @@ zzip_mem_disk_findfile(ZZIP_MEM_DISK * dir,
                        zzip_strcmp_fn_t compare)
 {
     ZZIP_MEM_ENTRY *entry = (! after ? dir->list : after->zz_next);
+    if ((! compare || compare == (zzip_strcmp_fn_t) (strcmp))
+        && dir->index && filename)
+    {                           /* the same entry as the loop below */
+        struct _zzip_mem_disk_index *index = dir->index;
+        int i = index->head[zzip_mem_disk_hash(filename) & index->mask];
+        for (; i; i = index->next[i - 1])
+        {
+            if (after && &dir->list[i - 1] <= after)
+                continue;
+            if (! strcmp(filename, dir->list[i - 1].zz_name))
+                return &dir->list[i - 1];
+        }
+        return 0;
+    }
     if (! compare)
         compare = (zzip_strcmp_fn_t) (strcmp);
     for (; entry; entry = entry->zz_next)
@@ -402,6 +483,7 @@ zzip_mem_entry_fopen(ZZIP_MEM_DISK * dir, ZZIP_MEM_ENTRY * entry)
     file->buffer = dir->disk->buffer;
     file->endbuf = dir->disk->endbuf;
     file->avail = zzip_mem_entry_usize(entry);
+    file->zstd = 0;
 
     if (! file->avail || zzip_mem_entry_data_stored(entry))
         { file->stored = zzip_mem_entry_to_data (entry); return file; }
@@ -412,6 +494,14 @@ zzip_mem_entry_fopen(ZZIP_MEM_DISK * dir, ZZIP_MEM_ENTRY * entry)
     file->zlib.zfree = Z_NULL;
     file->zlib.avail_in = zzip_mem_entry_csize(entry);
     file->zlib.next_in = zzip_mem_entry_to_data(entry);
+    file->zlib.total_out = 0;
+
+    if (USE_ZSTD && zzip_mem_entry_data_zstd(entry))
+    {
+        if (! (file->zstd = _zzip_zstd_new()))
+            { free (file); return 0; }
+        return file;
+    }
 
     if (! zzip_mem_entry_data_deflated(entry) ||
         inflateInit2(&file->zlib, -MAX_WBITS) != Z_OK)
@@ -15,8 +15,9 @@ typedef struct _zzip_mem_entry ZZIP_MEM_ENTRY;
 
 struct _zzip_mem_disk {
     ZZIP_DISK* disk;
-    ZZIP_MEM_ENTRY* list;
+    ZZIP_MEM_ENTRY* list;    /* an array, still chained by zz_next */
     ZZIP_MEM_ENTRY* last;
+    struct _zzip_mem_disk_index* index; /* name hash, owns list */
 };
 
 #ifndef zzip_mem_disk_extern
@@ -140,6 +141,7 @@ zzip_mem_disk_findmatch(ZZIP_MEM_DISK* dir,
 #define zzip_mem_entry_data_comprlevel(_e_) ((_e_)->zz_compr)
 #define zzip_mem_entry_data_stored(_e_) ((_e_)->zz_compr == ZZIP_IS_STORED)
 #define zzip_mem_entry_data_deflated(_e_) ((_e_)->zz_compr == ZZIP_IS_DEFLATED)
+#define zzip_mem_entry_data_zstd(_e_) ((_e_)->zz_compr == ZZIP_IS_ZSTD)
 
 /* zzip_mem_disk_file -------------------------------------------------- */
 
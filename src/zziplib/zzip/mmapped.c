@@ -36,6 +36,7 @@
 #include <zzip/format.h>
 #include <zzip/fetch.h>
 #include <zzip/__mmap.h>
+#include <zzip/__zstd.h>
 #include <zzip/__fnmatch.h>
 
 #include <stdlib.h>
@@ -547,6 +548,7 @@ zzip_disk_entry_fopen(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry)
     file->buffer = disk->buffer;
     file->endbuf = disk->endbuf;
     file->avail = zzip_file_header_usize(header);
+    file->zstd = 0;
 
     if (! file->avail || zzip_file_header_data_stored(header))
         { file->stored = zzip_file_header_to_data (header); return file; }
@@ -557,6 +559,14 @@ zzip_disk_entry_fopen(ZZIP_DISK * disk, ZZIP_DISK_ENTRY * entry)
     file->zlib.zfree = Z_NULL;
     file->zlib.avail_in = zzip_file_header_csize(header);
     file->zlib.next_in = zzip_file_header_to_data(header);
+    file->zlib.total_out = 0;
+
+    if (USE_ZSTD && zzip_file_header_data_zstd(header))
+    {
+        if (! (file->zstd = _zzip_zstd_new()))
+            { free (file); return 0; }
+        return file;
+    }
 
     if (! zzip_file_header_data_deflated(header) ||
         inflateInit2(&file->zlib, -MAX_WBITS) != Z_OK)
@@ -608,7 +618,8 @@ zzip_disk_fread(void *ptr, zzip_size_t sized, zzip_size_t nmemb,
     file->zlib.avail_out = sized * nmemb;
     file->zlib.next_out = ptr;
     ___ zzip_size_t total_old = file->zlib.total_out;
-    ___ int err = inflate(&file->zlib, Z_NO_FLUSH);
+    ___ int err = file->zstd ? _zzip_zstd_decode(file->zstd, &file->zlib)
+                             : inflate(&file->zlib, Z_NO_FLUSH);
     if (err == Z_STREAM_END)
         file->avail = 0;
     else if (err == Z_OK)
@@ -627,7 +638,9 @@ zzip_disk_fread(void *ptr, zzip_size_t sized, zzip_size_t nmemb,
 int
 zzip_disk_fclose(ZZIP_DISK_FILE * file)
 {
-    if (! file->stored)
+    if (file->zstd)
+        _zzip_zstd_free(file->zstd);
+    else if (! file->stored)
         inflateEnd(&file->zlib);
     free(file);
     return 0;
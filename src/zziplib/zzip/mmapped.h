@@ -128,6 +128,7 @@ struct zzip_disk_file
     zzip_size_t avail;                 /* memorized for checks on EOF */
     z_stream zlib;                     /* for inflated blocks */
     zzip_byte_t* stored;               /* for stored blocks */
+    void* zstd;                        /* for zstd frames (method 93) */
 };
 #endif
 
@@ -26,6 +26,10 @@
 #include <zzip/file.h>
 #include <zzip/format.h>
 
+#if defined _WIN32
+#include <windows.h>
+#endif
+
 zzip_off_t
 zzip_filesize(int fd)
 {
@@ -43,6 +47,56 @@ zzip_filesize(int fd)
     return st.st_size;
 }
 
+#if defined _WIN32
+/* the win32 crt has no pread(2), so go for an overlapped ReadFile. Note
+ * that the file pointer is moved as well on a synchronous handle. */
+static zzip_ssize_t
+win32_pread(int fd, void *buf, zzip_size_t len, zzip_off_t offset)
+{
+    OVERLAPPED ov;
+    DWORD got = 0;
+    HANDLE handle = (HANDLE) _get_osfhandle(fd);
+
+    if (handle == INVALID_HANDLE_VALUE)
+        return -1;
+
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD) ((_zzip___int64) offset & 0xFFFFFFFF);
+    ov.OffsetHigh = (DWORD) ((_zzip___int64) offset >> 32);
+    if (! ReadFile(handle, buf, (DWORD) len, &got, &ov))
+        return (GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+    return (zzip_ssize_t) got;
+}
+#define _zzip_pread win32_pread
+#endif
+
+#ifndef _zzip_pread
+#define _zzip_pread pread
+#endif
+
+/* a hint that the range will be read soon, so the system can start to
+ * read it ahead into the page cache. It does never wait for the data. */
+#if defined POSIX_FADV_WILLNEED
+static int
+posix_advise(int fd, zzip_off_t offset, zzip_off_t len)
+{
+    return posix_fadvise(fd, offset, len, POSIX_FADV_WILLNEED) ? -1 : 0;
+}
+#define _zzip_advise &posix_advise
+#elif defined F_RDADVISE
+static int
+darwin_advise(int fd, zzip_off_t offset, zzip_off_t len)
+{
+    struct radvisory ra;
+    ra.ra_offset = offset;
+    ra.ra_count = (int) len;
+    return fcntl(fd, F_RDADVISE, &ra);
+}
+#define _zzip_advise &darwin_advise
+#else
+#define _zzip_advise 0
+#endif
+
 static const struct zzip_plugin_io default_io = {
     &open,
     &close,
@@ -50,7 +104,9 @@ static const struct zzip_plugin_io default_io = {
     &_zzip_lseek,
     &zzip_filesize,
     1, 1,
-    &_zzip_write
+    &_zzip_write,
+    &_zzip_pread,
+    _zzip_advise
 };
 
 /** => zzip_init_io
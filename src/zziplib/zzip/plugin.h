@@ -40,6 +40,10 @@ extern "C" {
 
 /* we have renamed zzip_plugin_io.use_mmap to zzip_plugin_io.sys */
 #define ZZIP_PLUGIN_IO_SYS 1
+/* zzip_plugin_io.pread is used by files opened with ZZIP_THREADED */
+#define ZZIP_PLUGIN_IO_PREAD 1
+/* zzip_plugin_io.advise is used by zzip_dir_prefetch */
+#define ZZIP_PLUGIN_IO_ADVISE 1
 
 struct zzip_plugin_io { /* use "zzip_plugin_io_handlers" in applications !! */
     int          (*open)(zzip_char_t* name, int flags, ...);
@@ -50,12 +54,16 @@ struct zzip_plugin_io { /* use "zzip_plugin_io_handlers" in applications !! */
     long         sys;
     long         type;
     zzip_ssize_t (*write)(int fd, _zzip_const void* buf, zzip_size_t len);
+    zzip_ssize_t (*pread)(int fd, void* buf, zzip_size_t len,
+                          zzip_off_t offset); /* null: no ZZIP_THREADED */
+    int          (*advise)(int fd, zzip_off_t offset,
+                           zzip_off_t len);   /* null: no readahead */
 };
 
 typedef union _zzip_plugin_io
 {
     struct zzip_plugin_io fd;
-    struct { void* padding[8]; } ptr;
+    struct { void* padding[16]; } ptr;
 } zzip_plugin_io_handlers;
 
 #define _zzip_plugin_io_handlers zzip_plugin_io_handlers
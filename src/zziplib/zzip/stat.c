@@ -29,6 +29,14 @@
 #define ZZIP_USE_INTERNAL
 #include <zzip/info.h>
 
+static zzip_char_t *
+strrchr_basename(zzip_char_t * name)
+{
+    register zzip_char_t *n = strrchr(name, '/');
+    if (n) return n + 1;
+    return name;
+}
+
 /**
  * obtain information about a filename in an opened zip-archive without 
  * opening that file first. Mostly used to obtain the uncompressed 
@@ -37,47 +45,20 @@
 int
 zzip_dir_stat(ZZIP_DIR * dir, zzip_char_t * name, ZZIP_STAT * zs, int flags)
 {
-    struct zzip_dir_hdr *hdr = dir->hdr0;
+    struct zzip_dir_hdr *hdr;
     int (*cmp) (zzip_char_t *, zzip_char_t *);
 
     if (flags & ZZIP_CASEINSENSITIVE) flags |= ZZIP_CASELESS;
     cmp = (flags & ZZIP_CASELESS) ? strcasecmp : strcmp;
 
+    hdr = __zzip_dir_find(dir, name, cmp,
+                          (flags & ZZIP_IGNOREPATH) ? strrchr_basename : 0);
     if (! hdr)
     {
         dir->errcode = ZZIP_ENOENT;
         return -1;
     }
 
-    if (flags & ZZIP_IGNOREPATH)
-    {
-        char *n = strrchr(name, '/');
-        if (n)
-            name = n + 1;
-    }
-
-    while (1)
-    {
-        register char *hdr_name = hdr->d_name;
-        if (flags & ZZIP_IGNOREPATH)
-        {
-            register char *n = strrchr(hdr_name, '/');
-            if (n)
-                hdr_name = n + 1;
-        }
-
-        if (! cmp(hdr_name, name))
-            break;
-
-        if (! hdr->d_reclen)
-        {
-            dir->errcode = ZZIP_ENOENT;
-            return -1;
-        }
-
-        hdr = (struct zzip_dir_hdr *) ((char *) hdr + hdr->d_reclen);
-    }
-
     zs->d_compr = hdr->d_compr;
     zs->d_csize = hdr->d_csize;
     zs->st_size = hdr->d_usize;
@@ -21,10 +21,17 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 #include <fcntl.h>
 #ifdef ZZIP_HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
+#if defined _WIN32
+#include <process.h>
+#define getpid _getpid
+#elif defined ZZIP_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 #include <zzip/__mmap.h>
 #include <zzip/__debug.h>
@@ -75,6 +82,14 @@ struct _disk_trailer
 #define __zzip_fetch_disk_trailer __zzip_find_disk_trailer
 #endif
 
+/* The trailer and the entries of the central directory start at any offset
+ * of the mapped (_USE_MMAP) or read buffer. Their fields are fetched bytewise:
+ * ZZIP_GET16 / ZZIP_GET32 dereference casted pointers on x86, which is
+ * undefined behaviour at misaligned addresses. */
+#define __zzip_field16(__p, __f) __zzip_get16((zzip_byte_t *) (__p)->__f)
+#define __zzip_field32(__p, __f) __zzip_get32((zzip_byte_t *) (__p)->__f)
+#define __zzip_field64(__p, __f) __zzip_get64((zzip_byte_t *) (__p)->__f)
+
 /* ---------------------------  internals  -------------------------------- */
 
 /* internal functions of zziplib, avoid at all cost, changes w/o warning.
@@ -317,11 +332,11 @@ __zzip_fetch_disk_trailer(int fd, zzip_off_t filesize,
                     struct zzip_disk_trailer *orig =
                         (struct zzip_disk_trailer *) tail;
                     trailer->zz_tail = tail;
-                    trailer->zz_entries = zzip_disk_trailer_localentries(orig);
+                    trailer->zz_entries = __zzip_field16(orig, z_entries);
                     trailer->zz_finalentries =
-                        zzip_disk_trailer_finalentries(orig);
-                    trailer->zz_rootseek = zzip_disk_trailer_rootseek(orig);
-                    trailer->zz_rootsize = zzip_disk_trailer_rootsize(orig);
+                        __zzip_field16(orig, z_finalentries);
+                    trailer->zz_rootseek = __zzip_field32(orig, z_rootseek);
+                    trailer->zz_rootsize = __zzip_field32(orig, z_rootsize);
 #                  endif
 
                     __fixup_rootseek(offset + tail - mapped, trailer);
@@ -338,11 +353,11 @@ __zzip_fetch_disk_trailer(int fd, zzip_off_t filesize,
                         (struct zzip_disk64_trailer *) tail;
                     trailer->zz_tail = tail;
                     trailer->zz_entries =
-                        zzip_disk64_trailer_localentries(orig);
+                        __zzip_field64(orig, z_entries);
                     trailer->zz_finalentries =
-                        zzip_disk64_trailer_finalentries(orig);
-                    trailer->zz_rootseek = zzip_disk64_trailer_rootseek(orig);
-                    trailer->zz_rootsize = zzip_disk64_trailer_rootsize(orig);
+                        __zzip_field64(orig, z_finalentries);
+                    trailer->zz_rootseek = __zzip_field64(orig, z_rootseek);
+                    trailer->zz_rootsize = __zzip_field64(orig, z_rootsize);
                     { return(0); }
 #                  endif
                 }
@@ -484,9 +499,9 @@ __zzip_parse_root_directory(int fd,
         zzip_debug_xbuf((unsigned char *) d, sizeof(*d) + 8);
 #       endif
 
-        u_extras = zzip_disk_entry_get_extras(d);
-        u_comment = zzip_disk_entry_get_comment(d);
-        u_namlen = zzip_disk_entry_get_namlen(d);
+        u_extras = __zzip_field16(d, z_extras);
+        u_comment = __zzip_field16(d, z_comment);
+        u_namlen = __zzip_field16(d, z_namlen);
         HINT5("offset=0x%lx, size %ld, dirent *%p, hdr %p\n",
               (long) (zz_offset + zz_rootseek), (long) zz_rootsize, d, hdr);
 
@@ -497,11 +512,11 @@ __zzip_parse_root_directory(int fd,
            first structure read.
            at the end the whole copied list of structures  is copied into
            newly allocated buffer */
-        hdr->d_crc32 = zzip_disk_entry_get_crc32(d);
-        hdr->d_csize = zzip_disk_entry_get_csize(d);
-        hdr->d_usize = zzip_disk_entry_get_usize(d);
-        hdr->d_off = zzip_disk_entry_get_offset(d);
-        hdr->d_compr = zzip_disk_entry_get_compr(d);
+        hdr->d_crc32 = __zzip_field32(d, z_crc32);
+        hdr->d_csize = __zzip_field32(d, z_csize);
+        hdr->d_usize = __zzip_field32(d, z_usize);
+        hdr->d_off = __zzip_field32(d, z_offset);
+        hdr->d_compr = __zzip_field16(d, z_compr);
         if (hdr->d_compr > _255)
             hdr->d_compr = 255;
 
@@ -568,12 +583,460 @@ __zzip_parse_root_directory(int fd,
 #  endif
 }
 
-/* ------------------------- high-level interface ------------------------- */
+/* ------------------------- directory name index ------------------------- */
+
+/*
+ * The hdr0 list is walked linearly by default which makes opening many
+ * files of a big archive rather quadratic. The index keeps two chained
+ * hash tables over hdr0 - one keyed on the full name and one keyed on the
+ * basename - where entries are stored by position+1 (zero ends a chain)
+ * and each chain is ordered like hdr0 so that the first match is the same
+ * one that the linear search would have returned.
+ *
+ * The hash folds ASCII case and maps backslash to slash, and the basename
+ * is cut at either separator. That is coarser than any of the compare and
+ * basename variants in use, so one table serves the plain, ZZIP_CASELESS
+ * and ZZIP_NOPATHS modes alike - the real compare is done on the chain.
+ */
+struct zzip_dir_index
+{
+    uint32_t mask;               /* buckets - 1, buckets is a power of two */
+    uint32_t *name_head;         /* [buckets] chain start by full name */
+    uint32_t *base_head;         /* [buckets] chain start by basename */
+    uint32_t *name_next;         /* [entries] */
+    uint32_t *base_next;         /* [entries] */
+    uint32_t *name_hash;         /* [entries] */
+    uint32_t *base_hash;         /* [entries] */
+    struct zzip_dir_hdr **hdr;   /* [entries] */
+};
+
+#define ZZIP_FNV_BASIS 2166136261u
+#define ZZIP_FNV_PRIME 16777619u
+
+static void
+__zzip_dir_hash(zzip_char_t * name, uint32_t * name_hash, uint32_t * base_hash)
+{
+    register uint32_t h = ZZIP_FNV_BASIS;
+    register uint32_t b = ZZIP_FNV_BASIS;
+
+    for (; *name; name++)
+    {
+        register uint32_t c = (unsigned char) *name;
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        else if (c == '\\')
+            c = '/';
+        h = (h ^ c) * ZZIP_FNV_PRIME;
+        if (c == '/')
+            b = ZZIP_FNV_BASIS;
+        else
+            b = (b ^ c) * ZZIP_FNV_PRIME;
+    }
+    *name_hash = h;
+    *base_hash = b;
+}
+
+/**
+ * This function is used by => __zzip_dir_parse to build the name index
+ * over a parsed central directory. It returns null if there are no entries
+ * or if there is no memory - in which case lookups will just walk hdr0.
+ */
+static struct zzip_dir_index *
+__zzip_dir_index_new(struct zzip_dir_hdr *hdr0)
+{
+    struct zzip_dir_index *index;
+    struct zzip_dir_hdr *hdr;
+    uint32_t entries = 0;
+    uint32_t buckets = 16;
+    uint32_t i;
+    char *p;
+
+    if (! hdr0)
+        return 0;
+
+    for (hdr = hdr0; ; hdr = (struct zzip_dir_hdr *)
+             ((char *) hdr + hdr->d_reclen))
+    {
+        entries++;
+        if (! hdr->d_reclen)
+            break;
+    }
+    while (buckets < entries)
+        buckets <<= 1;
+
+    p = calloc(1, sizeof(*index)
+               + entries * sizeof(*index->hdr)
+               + (2 * buckets + 4 * entries) * sizeof(uint32_t));
+    if (! p)
+        return 0;
+
+    index = (struct zzip_dir_index *) p;
+    p += sizeof(*index);
+    index->hdr = (struct zzip_dir_hdr **) p;
+    p += entries * sizeof(*index->hdr);
+    index->name_head = (uint32_t *) p;
+    index->base_head = index->name_head + buckets;
+    index->name_next = index->base_head + buckets;
+    index->base_next = index->name_next + entries;
+    index->name_hash = index->base_next + entries;
+    index->base_hash = index->name_hash + entries;
+    index->mask = buckets - 1;
+
+    for (i = 0, hdr = hdr0; i < entries; i++)
+    {
+        index->hdr[i] = hdr;
+        __zzip_dir_hash(hdr->d_name, &index->name_hash[i],
+                        &index->base_hash[i]);
+        hdr = (struct zzip_dir_hdr *) ((char *) hdr + hdr->d_reclen);
+    }
+
+    /* push in reverse so that each chain comes out in hdr0 order */
+    for (i = entries; i; i--)
+    {
+        uint32_t *name_head =
+            &index->name_head[index->name_hash[i - 1] & index->mask];
+        uint32_t *base_head =
+            &index->base_head[index->base_hash[i - 1] & index->mask];
+        index->name_next[i - 1] = *name_head;
+        *name_head = i;
+        index->base_next[i - 1] = *base_head;
+        *base_head = i;
+    }
+
+    HINT3("index entries=%li buckets=%li", (long) entries, (long) buckets);
+    return index;
+}
+
+/**
+ * This function is used by => zzip_file_open and => zzip_dir_stat to find
+ * the first entry in the central directory matching the given name. The
+ * cmp function is strcmp or one of its caseless variants. If a basename
+ * function is given then both names are cut by it before comparing (the
+ * ZZIP_NOPATHS mode). The name index is used if it was built, otherwise
+ * the hdr0 list is walked. Returns null if the name is not found.
+ */
+struct zzip_dir_hdr *
+__zzip_dir_find(ZZIP_DIR * dir, zzip_char_t * name,
+                int (*cmp) (zzip_char_t *, zzip_char_t *),
+                zzip_char_t * (*basename) (zzip_char_t *))
+{
+    struct zzip_dir_index *index = dir->index;
+    struct zzip_dir_hdr *hdr = dir->hdr0;
+
+    if (! hdr)
+        return 0;
+
+    if (basename)
+        name = basename(name);
 
+    if (index)
+    {
+        uint32_t name_hash, base_hash, hash, i;
+        uint32_t *next, *hashes;
+
+        __zzip_dir_hash(name, &name_hash, &base_hash);
+        if (basename)
+        {
+            hash = base_hash;
+            hashes = index->base_hash;
+            next = index->base_next;
+            i = index->base_head[hash & index->mask];
+        } else
+        {
+            hash = name_hash;
+            hashes = index->name_hash;
+            next = index->name_next;
+            i = index->name_head[hash & index->mask];
+        }
+
+        for (; i; i = next[i - 1])
+        {
+            register zzip_char_t *hdr_name;
+            if (hashes[i - 1] != hash)
+                continue;
+
+            hdr = index->hdr[i - 1];
+            hdr_name = basename ? basename(hdr->d_name) : hdr->d_name;
+            if (! cmp(hdr_name, name))
+                return hdr;
+        }
+        return 0;
+    }
+
+    while (1)
+    {
+        register zzip_char_t *hdr_name = hdr->d_name;
+
+        if (basename)
+            hdr_name = basename(hdr_name);
+
+        if (! cmp(hdr_name, name))
+            return hdr;
+
+        if (hdr->d_reclen == 0)
+            return 0;
+        hdr = (struct zzip_dir_hdr *) ((char *) hdr + hdr->d_reclen);
+    }
+}
+
+/* ------------------------- directory index sidecar ---------------------- */
+
+/*
+ * Parsing the central directory of a big archive takes a while on every
+ * open. The sidecar file keeps the parsed hdr0 block and the tables of
+ * the name index as they are in memory, so that => zzip_dir_open_indexed
+ * can map it and use it in place. It is only used if the header matches
+ * the archive (size, mtime and central directory position) and this
+ * build (version and record size), otherwise it is written anew. The
+ * mtime is taken in nanoseconds where struct stat has them, so that an
+ * archive rewritten within the same second is still told apart.
+ *
+ * Other processes and dirs may have the sidecar mapped, so it is never
+ * rewritten in place: a new one is written to a temporary file next to
+ * it and renamed over the old one.
+ *
+ * The layout is the header, hdr0 padded to 8 bytes and then the uint32
+ * tables in the order of struct zzip_dir_index - all in native byte
+ * order as the sidecar is a cache for the local machine.
+ */
 #ifndef O_BINARY
 #define O_BINARY 0
 #endif
 
+#define ZZIP_SIDECAR_MAGIC   "ZZIPIDX"
+#define ZZIP_SIDECAR_VERSION 2
+
+struct zzip_dir_sidecar
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t hdrsize;            /* sizeof(struct zzip_dir_hdr) */
+    uint32_t entries;
+    uint32_t buckets;
+    uint64_t filesize;           /* these four are the key of the archive */
+    uint64_t mtime;              /* nanoseconds where available */
+    uint64_t rootseek;
+    uint64_t rootsize;
+    uint64_t hdr0len;            /* bytes of hdr0 that follow the header */
+};
+
+#define ZZIP_SIDECAR_ALIGN(_n_) (((_n_) + 7) & ~(uint64_t) 7)
+
+#if defined __APPLE__
+#define ZZIP_ST_MTIME_NSEC(_st_) ((_st_).st_mtimespec.tv_nsec)
+#elif defined __linux__ || defined __FreeBSD__ || defined __sun
+#define ZZIP_ST_MTIME_NSEC(_st_) ((_st_).st_mtim.tv_nsec)
+#else
+#define ZZIP_ST_MTIME_NSEC(_st_) 0
+#endif
+
+static void
+__zzip_dir_sidecar_key(ZZIP_DIR * dir, zzip_off_t filesize,
+                       struct _disk_trailer *trailer,
+                       struct zzip_dir_sidecar *key)
+{
+    memset(key, 0, sizeof(*key));
+    memcpy(key->magic, ZZIP_SIDECAR_MAGIC, sizeof(ZZIP_SIDECAR_MAGIC));
+    key->version = ZZIP_SIDECAR_VERSION;
+    key->hdrsize = sizeof(struct zzip_dir_hdr);
+    key->filesize = filesize;
+    key->rootseek = _disk_trailer_rootseek(trailer);
+    key->rootsize = _disk_trailer_rootsize(trailer);
+#ifdef ZZIP_HAVE_SYS_STAT_H
+    if (dir->io->fd.sys)
+    {                           /* a real file descriptor */
+        struct stat st;
+        if (! fstat(dir->fd, &st))
+            key->mtime = (uint64_t) st.st_mtime * 1000000000
+                + ZZIP_ST_MTIME_NSEC(st);
+    }
+#endif
+}
+
+/*
+ * map (or read) the sidecar and check it against the key, then point
+ * hdr0 and the index tables into it. Returns zero on success, otherwise
+ * nothing is changed in the dir and the caller parses the archive.
+ */
+static int
+__zzip_dir_sidecar_load(ZZIP_DIR * dir, struct zzip_dir_sidecar *key)
+{
+    zzip_plugin_io_t io = zzip_get_default_io();
+    struct zzip_dir_sidecar *head;
+    struct zzip_dir_index *index;
+    struct zzip_dir_hdr *hdr;
+    zzip_off_t len;
+    uint64_t tables;
+    uint32_t i, *table;
+    long sys = 0;
+    char *map = 0;
+    int fd;
+
+    if ((fd = io->fd.open(dir->indexfile, O_RDONLY | O_BINARY)) == -1)
+        return -1;
+    len = io->fd.filesize(fd);
+    if (len < (zzip_off_t) sizeof(*head))
+        goto error;
+
+    if (USE_MMAP && io->fd.sys)
+    {
+        sys = io->fd.sys;
+        map = _zzip_mmap(sys, fd, 0, len);
+        if (map == MAP_FAILED)
+            { map = 0; sys = 0; }
+    }
+    if (! map)
+    {
+        zzip_off_t n = 0;
+        if (! (map = malloc(len)))
+            goto error;
+        while (n < len)
+        {
+            zzip_ssize_t got = io->fd.read(fd, map + n, len - n);
+            if (got <= 0)
+                goto error;
+            n += got;
+        }
+    }
+
+    head = (struct zzip_dir_sidecar *) map;
+    if (memcmp(head->magic, key->magic, sizeof(head->magic))
+        || head->version != key->version || head->hdrsize != key->hdrsize
+        || head->filesize != key->filesize || head->mtime != key->mtime
+        || head->rootseek != key->rootseek
+        || head->rootsize != key->rootsize
+        || ! head->entries || head->buckets & (head->buckets - 1))
+        goto error;
+
+    tables = (2 * (uint64_t) head->buckets + 4 * (uint64_t) head->entries)
+        * sizeof(uint32_t);
+    if ((uint64_t) len != sizeof(*head) + ZZIP_SIDECAR_ALIGN(head->hdr0len)
+        + tables)
+        goto error;
+
+    if (! (index = malloc(sizeof(*index)
+                          + head->entries * sizeof(*index->hdr))))
+        goto error;
+
+    table = (uint32_t *) (map + sizeof(*head)
+                          + ZZIP_SIDECAR_ALIGN(head->hdr0len));
+    index->mask = head->buckets - 1;
+    index->hdr = (struct zzip_dir_hdr **) (index + 1);
+    index->name_head = table;
+    index->base_head = index->name_head + head->buckets;
+    index->name_next = index->base_head + head->buckets;
+    index->base_next = index->name_next + head->entries;
+    index->name_hash = index->base_next + head->entries;
+    index->base_hash = index->name_hash + head->entries;
+
+    /* walk hdr0 once for the entries, which checks the records as well */
+    hdr = (struct zzip_dir_hdr *) (map + sizeof(*head));
+    for (i = 0; i < head->entries; i++)
+    {
+        char *end = map + sizeof(*head) + head->hdr0len;
+        if ((char *) hdr + sizeof(*hdr) > end
+            || (char *) hdr + sizeof(*hdr) + hdr->d_namlen > end
+            || hdr->d_name[hdr->d_namlen]
+            || (! hdr->d_reclen) != (i + 1 == head->entries))
+            { free(index); goto error; }
+        index->hdr[i] = hdr;
+        hdr = (struct zzip_dir_hdr *) ((char *) hdr + hdr->d_reclen);
+    }
+    for (i = 0; i < 2 * head->buckets + 2 * head->entries; i++)
+    {
+        if (table[i] > head->entries)
+            { free(index); goto error; }
+    }
+
+    io->fd.close(fd);
+    dir->hdr0 = (struct zzip_dir_hdr *) (map + sizeof(*head));
+    dir->index = index;
+    dir->indexmap = map;
+    dir->indexlen = len;
+    dir->indexsys = sys;
+    HINT3("sidecar %s entries=%li", dir->indexfile, (long) head->entries);
+    return 0;
+
+  error:
+    if (map && sys)
+        _zzip_munmap(sys, map, len);
+    else if (map)
+        free(map);
+    io->fd.close(fd);
+    return -1;
+}
+
+/*
+ * write the parsed hdr0 and index tables to a temporary file, named
+ * after the process and the dir, and rename it to the sidecar. The
+ * temporary file is created with O_EXCL, so no other process that
+ * indexes the same archive can truncate it under us; a name left over
+ * by a crashed process with the same pid is skipped. The header goes
+ * last, so a sidecar that was not completely written is never taken as
+ * valid. Failing to write it is not an error for the zip directory.
+ */
+static void
+__zzip_dir_sidecar_save(ZZIP_DIR * dir, struct zzip_dir_sidecar *key)
+{
+    static const char zeros[8] = { 0 };
+    zzip_plugin_io_t io = zzip_get_default_io();
+    struct zzip_dir_index *index = dir->index;
+    struct zzip_dir_hdr *last;
+    zzip_ssize_t tables;
+    char *tmpname;
+    int fd, ok, attempt;
+
+    key->buckets = index->mask + 1;
+    key->entries = index->base_next - index->name_next;
+    last = index->hdr[key->entries - 1];
+    key->hdr0len = (char *) last + sizeof(*last) + last->d_namlen
+        - (char *) dir->hdr0;
+    tables = (2 * key->buckets + 4 * key->entries) * sizeof(uint32_t);
+
+    if (! (tmpname = malloc(strlen(dir->indexfile) + 48)))
+        return;
+    fd = -1;
+    for (attempt = 0; fd == -1 && attempt < 16; attempt++)
+    {
+        sprintf(tmpname, "%s.%lx.%lx.%x.tmp", dir->indexfile,
+                (unsigned long) getpid(), (unsigned long) (size_t) dir,
+                attempt);
+        fd = io->fd.open(tmpname, O_WRONLY | O_CREAT | O_EXCL | O_BINARY,
+                         0644);
+        if (fd == -1 && errno != EEXIST)
+            break;
+    }
+    if (fd == -1)
+        { free(tmpname); return; }
+
+    ok = ! (io->fd.seeks(fd, sizeof(*key), SEEK_SET) < 0
+        || io->fd.write(fd, dir->hdr0, key->hdr0len)
+           != (zzip_ssize_t) key->hdr0len
+        || io->fd.write(fd, zeros, ZZIP_SIDECAR_ALIGN(key->hdr0len)
+                        - key->hdr0len)
+           != (zzip_ssize_t) (ZZIP_SIDECAR_ALIGN(key->hdr0len)
+                              - key->hdr0len)
+        || io->fd.write(fd, index->name_head, tables) != tables
+        || io->fd.seeks(fd, 0, SEEK_SET) < 0
+        || io->fd.write(fd, key, sizeof(*key)) != sizeof(*key));
+    if (io->fd.close(fd) < 0)
+        ok = 0;
+
+#  if defined _WIN32
+    /* rename() does not replace an existing file there */
+    if (ok)
+        remove(dir->indexfile);
+#  endif
+    if (! ok || rename(tmpname, dir->indexfile) != 0)
+    {
+        NOTE2("sidecar %s not written", dir->indexfile);
+        remove(tmpname);
+    }
+    free(tmpname);
+}
+
+/* ------------------------- high-level interface ------------------------- */
+
 static zzip_strings_t *
 zzip_get_default_ext(void)
 {
@@ -609,9 +1072,45 @@ zzip_dir_alloc_ext_io(zzip_strings_t * ext, const zzip_plugin_io_t io)
     /* dir->fileext is currently unused - so what, still initialize it */
     dir->fileext = ext ? ext : zzip_get_default_ext();
     dir->io = io ? io : zzip_get_default_io();
+    dir->cache.size = ZZIP_CACHE_SIZE;
     return dir;
 }
 
+/**
+ * This function sets the number of closed files that are kept with the
+ * zip directory handle for reuse by the next => zzip_file_open, each with
+ * its 32K buffer and its inflate state which is just reset then. So in a
+ * steady state opening and closing files is free of heap allocations.
+ *
+ * Reducing the size frees the surplus at once, a size of zero disables
+ * the cache. The default is ZZIP_CACHE_SIZE, files opened with
+ * ZZIP_THREADED do not take part. It returns the previous size.
+ */
+int
+zzip_dir_cache_size(ZZIP_DIR * dir, int size)
+{
+    int old;
+
+    if (! dir)
+        return -1;
+
+    old = dir->cache.size;
+    dir->cache.size = size < 0 ? 0 : size;
+
+    while (dir->cache.count > dir->cache.size)
+    {
+        struct zzip_file *fp = dir->cache.fp;
+        dir->cache.fp = fp->next;
+        dir->cache.count--;
+        if (fp->inflated)
+            inflateEnd(&fp->d_stream);
+        if (fp->buf32k)
+            free(fp->buf32k);
+        free(fp);
+    }
+    return old;
+}
+
 /** => zzip_dir_alloc_ext_io
  * this function is obsolete - it was generally used for implementation
  * and exported to let other code build on it. It is now advised to
@@ -642,10 +1141,16 @@ zzip_dir_free(ZZIP_DIR * dir)
 
     if (dir->fd >= 0)
         dir->io->fd.close(dir->fd);
-    if (dir->hdr0)
+    if (dir->hdr0 && ! dir->indexmap)
         free(dir->hdr0);
+    if (dir->index)
+        free(dir->index);
+    if (dir->indexmap && dir->indexsys)
+        _zzip_munmap(dir->indexsys, dir->indexmap, dir->indexlen);
+    else if (dir->indexmap)
+        free(dir->indexmap);
     if (dir->cache.fp)
-        free(dir->cache.fp);
+        zzip_dir_cache_size(dir, 0);
     if (dir->cache.buf32k)
         free(dir->cache.buf32k);
     if (dir->realname)
@@ -721,6 +1226,7 @@ __zzip_dir_parse(ZZIP_DIR * dir)
     zzip_error_t rv;
     zzip_off_t filesize;
     struct _disk_trailer trailer;
+    struct zzip_dir_sidecar key;
     /* if (! dir || dir->fd < 0)
      *     { rv = EINVAL; goto error; }
      */
@@ -740,9 +1246,22 @@ __zzip_dir_parse(ZZIP_DIR * dir)
           (long) _disk_trailer_rootsize(&trailer),
           (long) _disk_trailer_rootseek(&trailer));
 
+    if (dir->indexfile)
+    {
+        __zzip_dir_sidecar_key(dir, filesize, &trailer, &key);
+        if (! __zzip_dir_sidecar_load(dir, &key))
+            return 0;
+    }
+
     if ((rv = __zzip_parse_root_directory(dir->fd, &trailer, &dir->hdr0,
                                           dir->io)) != 0)
         { goto error; }
+
+    /* no index (out of memory) is not an error, lookups walk hdr0 then */
+    dir->index = __zzip_dir_index_new(dir->hdr0);
+
+    if (dir->indexfile && dir->index)
+        __zzip_dir_sidecar_save(dir, &key);
   error:
     return rv;
 }
@@ -830,6 +1349,70 @@ zzip_dir_open_ext_io(zzip_char_t * filename, zzip_error_t * e,
     }
 }
 
+/** => zzip_dir_open
+ * This function opens the zip-archive like => zzip_dir_open_ext_io but it
+ * takes its central directory from the given index file if that was
+ * written for the same archive before - same size, mtime (to the
+ * nanosecond where the system has it) and central directory position.
+ * The index is then mapped (or read at once) and
+ * used in place, so there is no parsing of the central directory and no
+ * hashing of the names on the next start. Otherwise the archive is
+ * parsed as usual and the index file is (re)written for the next time,
+ * by renaming a new file over it, so that it can stay mapped elsewhere.
+ *
+ * The index file is a cache only, it may be deleted at any time. It is
+ * opened with the default posix io, while the archive itself uses io.
+ */
+ZZIP_DIR *
+zzip_dir_open_indexed(zzip_char_t * filename, zzip_char_t * indexfile,
+                      zzip_error_t * e, zzip_strings_t * ext,
+                      zzip_plugin_io_t io)
+{
+    zzip_error_t rv;
+    ZZIP_DIR *dir;
+    int fd;
+
+    if (! indexfile)
+        return zzip_dir_open_ext_io(filename, e, ext, io);
+    if (! io)
+        io = zzip_get_default_io();
+    if (! ext)
+        ext = zzip_get_default_ext();
+
+    fd = (io->fd.open)(filename, O_RDONLY | O_BINARY);
+    if (fd == -1)
+        fd = __zzip_try_open(filename, O_RDONLY | O_BINARY, ext, io);
+    if (fd == -1)
+    {
+        if (e)
+            { *e = ZZIP_DIR_OPEN; }
+        return 0;
+    }
+
+    if ((dir = zzip_dir_alloc_ext_io(ext, io)) == NULL)
+        { io->fd.close(fd); rv = ZZIP_OUTOFMEM; goto error; }
+
+    dir->fd = fd;
+    dir->indexfile = indexfile;
+    rv = __zzip_dir_parse(dir);
+    dir->indexfile = 0;         /* not kept, it is only needed above */
+    if (rv)
+        goto error;
+
+    dir->hdr = dir->hdr0;
+    dir->refcount |= 0x10000000;
+
+    if (e)
+        *e = rv;
+    return dir;
+  error:
+    if (dir)
+        zzip_dir_free(dir);
+    if (e)
+        *e = rv;
+    return NULL;
+}
+
 /** => zzip_dir_open
  * fills the dirent-argument with the values and
  * increments the read-pointer of the dir-argument.
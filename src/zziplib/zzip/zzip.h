@@ -166,6 +166,8 @@ _zzip_export
 zzip_off_t  	zzip_telldir(ZZIP_DIR * dir);
 _zzip_export
 void	 	zzip_seekdir(ZZIP_DIR * dir, zzip_off_t offset);
+_zzip_export
+int		zzip_dir_cache_size(ZZIP_DIR * dir, int size);
 
 /*
  * 'opening', 'closing' and reading invidual files in zip archive.
@@ -177,6 +179,9 @@ _zzip_export
 int  		zzip_file_close(ZZIP_FILE * fp);
 _zzip_export
 zzip_ssize_t	zzip_file_read(ZZIP_FILE * fp, void* buf, zzip_size_t len);
+_zzip_export
+int		zzip_dir_prefetch(ZZIP_DIR * dir, zzip_char_t** names,
+				  int count, int o_modes);
 
 _zzip_export
 ZZIP_FILE * 	zzip_open(zzip_char_t* name, int flags);
@@ -208,6 +213,12 @@ _zzip_export
 zzip_off_t      zzip_seek(ZZIP_FILE * fp, zzip_off_t offset, int whence);
 _zzip_export
 zzip_off_t      zzip_tell(ZZIP_FILE * fp);
+_zzip_export
+int             zzip_file_checkpoints(ZZIP_FILE * fp, zzip_size_t span);
+_zzip_export
+_zzip_const void* zzip_file_map(ZZIP_FILE * fp, zzip_size_t * len);
+_zzip_export
+int             zzip_file_unmap(ZZIP_FILE * fp);
 
 /*
  * reading info of a single file 
@@ -221,6 +232,26 @@ int		zzip_file_stat(ZZIP_FILE * fp, ZZIP_STAT * zs);
 _zzip_export
 int		zzip_fstat(ZZIP_FILE * fp, ZZIP_STAT * zs);
 
+/*
+ * extracting whole files into a buffer
+ * zzip/extract.c
+ */
+typedef struct zzip_extract ZZIP_EXTRACT;
+struct zzip_extract
+{
+    zzip_char_t* name;      /* in: the file in the zip */
+    void*        buf;       /* in: the target buffer */
+    zzip_size_t  len;       /* in: its size, usually the st_size */
+    zzip_ssize_t result;    /* out: bytes written or -1 */
+};
+
+_zzip_export
+zzip_ssize_t	zzip_dir_extract(ZZIP_DIR * dir, zzip_char_t* name,
+				 void * buf, zzip_size_t len, int o_modes);
+_zzip_export
+int		zzip_dir_extract_list(ZZIP_DIR * dir, ZZIP_EXTRACT * list,
+				      int count, int o_modes, int threads);
+
 #ifdef ZZIP_LARGEFILE_RENAME
 #define zzip_open_shared_io  zzip_open_shared_io64
 #define zzip_open_ext_io     zzip_open_ext_io64
@@ -253,6 +284,12 @@ ZZIP_DIR *  zzip_dir_open_ext_io(zzip_char_t* filename,
 				 zzip_error_t* errcode_p,
 				 zzip_strings_t* ext, zzip_plugin_io_t io);
 
+_zzip_export
+ZZIP_DIR *  zzip_dir_open_indexed(zzip_char_t* filename,
+				  zzip_char_t* indexfile,
+				  zzip_error_t* errcode_p,
+				  zzip_strings_t* ext, zzip_plugin_io_t io);
+
 /* zzip_file_open_ext_io => zzip_dir_open_ext_io + zzip_file_open */
 
 #ifdef __cplusplus